@@ -0,0 +1,89 @@
+/*--------------------------------------------------------------------*/
+/* benchhash.c                                                        */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The number of keys of each length to hash. */
+
+enum {KEY_COUNT = 4096};
+
+/* Where the hash codes are accumulated, so that the compiler cannot
+   discard the calls that compute them. */
+
+static volatile size_t uHashSink;
+
+/*--------------------------------------------------------------------*/
+
+/* Hash every key of length uLength in the KEY_COUNT keys at pcKeys
+   with eHash, repeating until at least BYTES_PER_RUN bytes have been
+   hashed, and write the throughput to stdout under the name pcName. */
+
+static void benchHash(enum SymTableHash eHash, const char *pcName,
+   const char *pcKeys, size_t uLength)
+{
+   const double BYTES_PER_RUN = 256.0 * 1024 * 1024;
+
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+   double dBytes = 0.0;
+   double dSeconds;
+   size_t uSink = 0;
+   size_t u;
+
+   iInitialClock = clock();
+   while (dBytes < BYTES_PER_RUN)
+   {
+      for (u = 0; u < KEY_COUNT; u++)
+         uSink += SymTable_hashKey(eHash, pcKeys + u * uLength, uLength);
+      dBytes += (double)KEY_COUNT * (double)uLength;
+   }
+   iFinalClock = clock();
+   uHashSink += uSink;
+
+   dSeconds = ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC;
+   printf("%-6s %4lu bytes:  %8.3f GB/s\n", pcName,
+      (unsigned long)uLength, dBytes / dSeconds / 1e9);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the throughput of each SymTable hash function to stdout for
+   key lengths from 4 to 256 bytes.  Return 0, or exit with
+   EXIT_FAILURE if insufficient memory is available. */
+
+int main(void)
+{
+   enum {MIN_LENGTH = 4, MAX_LENGTH = 256};
+
+   char *pcKeys;
+   size_t uLength;
+   size_t u;
+
+   pcKeys = (char*)malloc((size_t)KEY_COUNT * MAX_LENGTH);
+   if (pcKeys == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   srand(217);
+   for (u = 0; u < (size_t)KEY_COUNT * MAX_LENGTH; u++)
+      pcKeys[u] = (char)('!' + rand() % 94);
+
+   for (uLength = MIN_LENGTH; uLength <= MAX_LENGTH; uLength *= 2)
+   {
+      benchHash(SYMTABLE_HASH_65599, "65599", pcKeys, uLength);
+      benchHash(SYMTABLE_HASH_WORDS, "words", pcKeys, uLength);
+   }
+
+   free(pcKeys);
+   return 0;
+}
@@ -0,0 +1,167 @@
+/*--------------------------------------------------------------------*/
+/* benchload.c                                                        */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#define _XOPEN_SOURCE 700
+
+#include "symtable.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The longest line of the generated input, '\n' included. */
+
+enum {MAX_LINE_LENGTH = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number in the uLength bytes at pcValue as a value. */
+
+static void *parseNumber(const char *pcValue, size_t uLength)
+{
+   (void)uLength;
+   return (void*)(size_t)strtoul(pcValue, NULL, 10);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the throughput of loading uBytes bytes in the clock ticks from
+   iInitialClock to iFinalClock, and the number of bindings of
+   oSymTable, to stdout under the name pcName. */
+
+static void report(const char *pcName, size_t uBytes,
+   clock_t iInitialClock, clock_t iFinalClock, SymTable_T oSymTable)
+{
+   double dSeconds;
+
+   dSeconds = ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC;
+   printf("%-12s %10lu bindings:  %8.1f MB/s\n", pcName,
+      (unsigned long)SymTable_getLength(oSymTable),
+      (double)uBytes / dSeconds / 1e6);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Load the file pfInput of uBytes bytes one line at a time, reading
+   each with fgets and calling SymTable_put for it, and write the
+   throughput to stdout. */
+
+static void benchNaive(FILE *pfInput, size_t uBytes)
+{
+   SymTable_T oSymTable;
+   clock_t iInitialClock;
+   char acLine[MAX_LINE_LENGTH + 1];
+   char *pcTab;
+   char *pcNewline;
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   rewind(pfInput);
+   iInitialClock = clock();
+   while (fgets(acLine, (int)sizeof(acLine), pfInput) != NULL)
+   {
+      pcNewline = strchr(acLine, '\n');
+      if (pcNewline != NULL)
+         *pcNewline = '\0';
+      pcTab = strchr(acLine, '\t');
+      if (pcTab == NULL)
+         continue;
+      *pcTab = '\0';
+      (void)SymTable_put(oSymTable, acLine,
+         parseNumber(pcTab + 1, strlen(pcTab + 1)));
+   }
+   report("per-line", uBytes, iInitialClock, clock(), oSymTable);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Load the file pfInput of uBytes bytes with SymTable_loadStream, and
+   write the throughput to stdout. */
+
+static void benchStream(FILE *pfInput, size_t uBytes)
+{
+   SymTable_T oSymTable;
+   clock_t iInitialClock;
+   int iSuccessful;
+
+   oSymTable = SymTable_new();
+   if (oSymTable == NULL)
+   {
+      fprintf(stderr, "Insufficient memory\n");
+      exit(EXIT_FAILURE);
+   }
+
+   rewind(pfInput);
+   (void)lseek(fileno(pfInput), 0, SEEK_SET);
+   iInitialClock = clock();
+   iSuccessful = SymTable_loadStream(oSymTable, fileno(pfInput),
+      SYMTABLE_FORMAT_TSV, parseNumber);
+   if (! iSuccessful)
+   {
+      fprintf(stderr, "SymTable_loadStream failed\n");
+      exit(EXIT_FAILURE);
+   }
+   report("loadStream", uBytes, iInitialClock, clock(), oSymTable);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to a temporary file argv[1] lines of a key, a tab and a
+   number, 2000000 if argc is 1, and write to stdout the throughput of
+   loading them into a SymTable one line at a time with fgets and
+   SymTable_put, and with SymTable_loadStream. Each load runs twice,
+   so that the file is in the page cache for both. Return 0, or exit
+   with EXIT_FAILURE if the file cannot be written. */
+
+int main(int argc, char *argv[])
+{
+   FILE *pfInput;
+   long lLineCount = 2000000;
+   long l;
+   size_t uBytes = 0;
+   int iPass;
+
+   if (argc > 1)
+      lLineCount = atol(argv[1]);
+
+   pfInput = tmpfile();
+   if (pfInput == NULL)
+   {
+      fprintf(stderr, "Cannot create a temporary file\n");
+      exit(EXIT_FAILURE);
+   }
+
+   srand(217);
+   for (l = 0; l < lLineCount; l++)
+      uBytes += (size_t)fprintf(pfInput, "user%ld-%08x\t%d\n", l,
+         (unsigned int)rand(), rand() % 100000);
+   if (fflush(pfInput) != 0)
+   {
+      fprintf(stderr, "Cannot write the temporary file\n");
+      exit(EXIT_FAILURE);
+   }
+
+   for (iPass = 0; iPass < 2; iPass++)
+   {
+      benchNaive(pfInput, uBytes);
+      benchStream(pfInput, uBytes);
+   }
+
+   fclose(pfInput);
+   return 0;
+}
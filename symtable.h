@@ -7,9 +7,11 @@
 #define SYMTABLE_INCLUDED
 #include <stddef.h>
 
-/* Declaration for a global variable that stores the bucket counts */
+/* Declaration for a global variable that stores the bucket counts. It
+is defined by the hash table implementation, which expands through
+these counts and continues past the last one. */
 
-const size_t uBucketCounts[8];
+extern const size_t uBucketCounts[8];
 
 /* A SymTable is an unordered collection of bindings. A binding 
 consists of a key and a value. */
@@ -89,4 +91,481 @@ void SymTable_map(SymTable_T oSymTable,
      void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
      const void *pvExtra);
 
+/*--------------------------------------------------------------------*/
+/* The declarations below are extensions that only the hash table     */
+/* implementation (symtablehash.c) provides.                          */
+/*--------------------------------------------------------------------*/
+
+/* A SymTablePool is a set of reference-counted strings that several 
+SymTable objects can share as keys, so that each distinct key is stored
+once however many tables contain it. */
+struct SymTablePool;
+
+/* A SymTablePool_T is an alias for SymTablePool for encapsulation 
+purposes. */
+typedef struct SymTablePool *SymTablePool_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTablePool object with no strings, or NULL if 
+insufficient memory is available. */
+
+SymTablePool_T SymTablePool_new(void);
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oPool, including the strings that 
+callers interned and never released. Every SymTable object using oPool
+must already have been freed. */
+
+void SymTablePool_free(SymTablePool_T oPool);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of distinct strings in oPool */
+
+size_t SymTablePool_getLength(SymTablePool_T oPool);
+
+/*--------------------------------------------------------------------*/
+
+/* Return oPool's copy of pcString, adding it to oPool if it is not 
+there yet, and take a reference to it. Return NULL if insufficient 
+memory is available. Passing the returned string as a key lets tables
+using oPool match it by address without comparing characters. */
+
+const char *SymTablePool_intern(SymTablePool_T oPool,
+     const char *pcString);
+
+/*--------------------------------------------------------------------*/
+
+/* Drop one reference to pcString, which must have been returned by 
+SymTablePool_intern for oPool, and remove it from oPool once no 
+references remain. */
+
+void SymTablePool_release(SymTablePool_T oPool, const char *pcString);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings whose keys are kept in
+oPool, or in the table itself if oPool is NULL. Return NULL if 
+insufficient memory is available. oPool must outlive the table. */
+
+SymTable_T SymTable_newWithPool(SymTablePool_T oPool);
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings whose buckets are 
+sized so that it holds uCapacity bindings without expanding, or NULL if
+insufficient memory is available. A small uCapacity gets fewer buckets
+than SymTable_new allocates. */
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* Make oSymTable hold uCapacity bindings without expanding, moving its 
+bindings into larger buckets now if need be, and return 1 (TRUE). If 
+insufficient memory is available, leave oSymTable unchanged and return 
+0 (FALSE). */
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* The hash functions that a SymTable object can use. */
+
+enum SymTableHash
+{
+     /* The 65599 multiplicative hash over one byte at a time, with 
+     prime bucket counts. Every new SymTable object uses it. */
+     SYMTABLE_HASH_65599,
+
+     /* A wyhash-style hash over eight bytes at a time, with 
+     power-of-two bucket counts. */
+     SYMTABLE_HASH_WORDS
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Make eHash the hash function of oSymTable and return 1 (TRUE). If 
+oSymTable is not empty or has live iterators, or insufficient memory 
+is available, leave oSymTable unchanged and return 0 (FALSE). */
+
+int SymTable_setHash(SymTable_T oSymTable, enum SymTableHash eHash);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash code of the uLength bytes at pcKey under the hash 
+function eHash. */
+
+size_t SymTable_hashKey(enum SymTableHash eHash, const char *pcKey,
+     size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable_Key is a key together with its length and its hash code, 
+computed once by SymTable_makeKey so that the key can be looked up in 
+any number of tables without being rescanned. Its characters need not 
+be followed by a '\0', but must not contain one. */
+
+typedef struct SymTable_Key
+{
+     /* The key's characters. */
+     const char *pcKey;
+
+     /* The number of characters at pcKey. */
+     size_t uLength;
+
+     /* The hash function that uHash was computed with. A table whose 
+     hash function differs rehashes the key on each call. */
+     enum SymTableHash eHash;
+
+     /* The hash code of the key under eHash. */
+     size_t uHash;
+} SymTable_Key;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a SymTable_Key for the uLength characters at pcKey, hashed 
+with eHash. pcKey must stay valid for as long as the key is used. */
+
+SymTable_Key SymTable_makeKey(enum SymTableHash eHash, const char *pcKey,
+     size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* The functions below behave as SymTable_put, SymTable_contains, 
+SymTable_get and SymTable_remove do, for the key *psKey. A binding 
+added by SymTable_putK holds a '\0'-terminated copy of the key, which 
+is what SymTable_map passes to its function. */
+
+int SymTable_putK(SymTable_T oSymTable, const SymTable_Key *psKey,
+     const void *pvValue);
+
+int SymTable_containsK(SymTable_T oSymTable, const SymTable_Key *psKey);
+
+void *SymTable_getK(SymTable_T oSymTable, const SymTable_Key *psKey);
+
+void *SymTable_removeK(SymTable_T oSymTable, const SymTable_Key *psKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the value of the binding within oSymTable whose
+key is pcKey, adding a binding of pcKey to NULL first if there is none, 
+and set *piInserted to 1 (TRUE) if the binding was added or 0 (FALSE) 
+if it was already there. Return NULL, leaving oSymTable unchanged and 
+*piInserted 0, if insufficient memory is available. The key is hashed 
+and its bucket walked once, so the value can be read and written 
+through the address without further lookups. The address stays valid 
+until the binding is removed, oSymTable is frozen with SymTable_freeze, 
+or oSymTable is freed. */
+
+void **SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+     int *piInserted);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the value of the binding within oSymTable whose
+key is pcKey, adding a binding of pcKey to pvValue first if there is 
+none. Return NULL, leaving oSymTable unchanged, if insufficient memory 
+is available. The address stays valid as for SymTable_upsert. */
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+     const void *pvValue);
+
+/*--------------------------------------------------------------------*/
+
+/* For each i below uCount, store in ppvValues[i] the value of the 
+binding within oSymTable whose key is ppcKeys[i], or NULL if no such 
+binding exists. Return the number of keys found. The keys' buckets and 
+nodes are prefetched and visited a group of keys at a time, so that 
+their cache misses overlap; this is faster than uCount calls of 
+SymTable_get when the table is much larger than the cache. */
+
+size_t SymTable_getBatch(SymTable_T oSymTable, const char *const *ppcKeys,
+     size_t uCount, void **ppvValues);
+
+/*--------------------------------------------------------------------*/
+
+/* For each i below uCount, store in piFound[i] 1 (TRUE) if oSymTable 
+contains a binding whose key is ppcKeys[i], or 0 (FALSE) if otherwise, 
+as SymTable_getBatch does. Return the number of keys found. */
+
+size_t SymTable_containsBatch(SymTable_T oSymTable,
+     const char *const *ppcKeys, size_t uCount, int *piFound);
+
+/*--------------------------------------------------------------------*/
+
+/* Add to oSymTable a binding of ppcKeys[i] to ppvValues[i] for each i 
+below uCount for which neither oSymTable nor an earlier key of the 
+batch already has the key, and, if piInserted is not NULL, set 
+piInserted[i] to 1 (TRUE) if that binding was added or 0 (FALSE) if the
+key was rejected as a duplicate. Return 1 (TRUE), or 0 (FALSE) if 
+insufficient memory is available, in which case piInserted still tells 
+which bindings were added. The table is sized for the whole batch 
+once, and the new nodes are allocated together, so this is much faster 
+than uCount calls of SymTable_put. */
+
+int SymTable_putBatch(SymTable_T oSymTable, const char *const *ppcKeys,
+     const void *const *ppvValues, size_t uCount, int *piInserted);
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSource into oDest and free oSource, returning
+1 (TRUE). Where both tables have a key, oDest keeps its binding, with 
+its value replaced by (*pfCombine)(pcKey, pvDestValue, pvSourceValue, 
+pvExtra) if pfCombine is not NULL. The nodes move with their keys and 
+cached hash codes, so nothing is copied or hashed again. If the tables 
+use different pools or hash functions, oSource has live iterators, or 
+insufficient memory is available, leave both unchanged and return 0 
+(FALSE). No other thread may use oSource meanwhile. */
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+     void *(*pfCombine)(const char *pcKey, void *pvDestValue,
+     void *pvSourceValue, void *pvExtra), const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableShards is a set of SymTable objects, its shards, that 
+split the keys between them by the top bits of the keys' hash codes, 
+so that no key can be in two shards. Threads that each own some of 
+the shards can fill them without locking, and the shards then merge 
+into one table with each node relinked, one at a time, into the bucket 
+of its cached hash code, without comparing keys or hashing again. */
+struct SymTableShards;
+
+/* A SymTableShards_T is an alias for SymTableShards for encapsulation
+purposes. */
+typedef struct SymTableShards *SymTableShards_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTableShards object of uShardCount empty shards, 
+which must be a power of two, sized together for uCapacity bindings. 
+The shards use SYMTABLE_HASH_WORDS. Return NULL if insufficient memory 
+is available. */
+
+SymTableShards_T SymTableShards_new(size_t uShardCount, size_t uCapacity);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oShards and all of its shards. */
+
+void SymTableShards_free(SymTableShards_T oShards);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of shards of oShards. */
+
+size_t SymTableShards_getCount(SymTableShards_T oShards);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the shard of oShards that key pcKey belongs 
+in. */
+
+size_t SymTableShards_route(SymTableShards_T oShards, const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* Return shard uShard of oShards, a SymTable object that may only be 
+given keys that SymTableShards_route sends to uShard. */
+
+SymTable_T SymTableShards_shard(SymTableShards_T oShards, size_t uShard);
+
+/*--------------------------------------------------------------------*/
+
+/* Merge the shards of oShards, in order, into one new SymTable object,
+free oShards, and return the table. Since the shards hold disjoint 
+keys, the result does not depend on how the threads that filled them 
+interleaved. Return NULL, leaving oShards unchanged, if a shard was 
+frozen, was given another hash function with SymTable_setHash or has 
+live iterators, or if insufficient memory is available. */
+
+SymTable_T SymTableShards_merge(SymTableShards_T oShards);
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable, as 
+SymTable_map does, from uThreadCount threads, counting the calling 
+thread. Thread i passes ppvExtras[i], or NULL if ppvExtras is NULL, as 
+the extra argument, so that each thread can accumulate into its own 
+object without locking. The buckets are split into chunks that idle 
+threads steal from busy ones, so long chains do not hold up the rest. 
+The calls come in no particular order, several at once, and must not 
+change oSymTable. */
+
+void SymTable_mapParallel(SymTable_T oSymTable,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     void *const *ppvExtras, size_t uThreadCount);
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableIter walks the bindings of a SymTable one call at a time,
+so that a scan can stop early or be spread over many calls with other
+calls on the table in between. A binding that is in the table for the
+whole walk is visited exactly once. One that is put or removed during
+it may be visited or not, and removing the binding an iterator is at,
+or any other, is allowed. The table goes on expanding and rehashing 
+while iterators are live, and they carry on where they left off. With 
+SYMTABLE_HASH_65599, whose prime bucket counts mix the buckets, an 
+iterator part way through a walk first copies the list of bindings it 
+has left, so an expansion costs memory in proportion to them, and 
+SymTable_reserve returns 0 if that memory is not available. */
+struct SymTableIter;
+
+/* A SymTableIter_T is an alias for SymTableIter for encapsulation
+purposes. */
+typedef struct SymTableIter *SymTableIter_T;
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new iterator over oSymTable, positioned before its first 
+binding, or NULL if insufficient memory is available. oSymTable must 
+not be freed before the iterator. */
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable);
+
+/*--------------------------------------------------------------------*/
+
+/* Advance oIter to the next binding and return 1 (TRUE), or return 0 
+(FALSE) if there are no more. In the concurrent build each call locks 
+one bucket at a time for reading, so writers to other buckets carry on 
+meanwhile. */
+
+int SymTable_iterNext(SymTableIter_T oIter);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the key of the binding that oIter is at, or NULL if it is at 
+none or that binding has been removed. */
+
+const char *SymTable_iterKey(SymTableIter_T oIter);
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding that oIter is at, or NULL if it is 
+at none or that binding has been removed. */
+
+void *SymTable_iterValue(SymTableIter_T oIter);
+
+/*--------------------------------------------------------------------*/
+
+/* Free oIter. */
+
+void SymTable_iterFree(SymTableIter_T oIter);
+
+/*--------------------------------------------------------------------*/
+
+/* Write the bindings of oSymTable to the file descriptor iFd as a
+snapshot that SymTable_openMapped can map, and return 1 (TRUE), or 0
+(FALSE) if a write fails or insufficient memory is available. Each
+value is saved as the bytes that (*pfSerialize)(pvValue, pvBuffer,
+uBufferSize) stores at pvBuffer and whose number it returns; if that
+number exceeds uBufferSize, it must store nothing, and is called again
+with a buffer that large. If pfSerialize is NULL only the keys are
+saved. The snapshot holds the keys, the values and a hash index, all
+located by offsets, and is written in one pass, so iFd may be a pipe. */
+
+int SymTable_save(SymTable_T oSymTable, int iFd,
+     size_t (*pfSerialize)(const void *pvValue, void *pvBuffer,
+     size_t uBufferSize));
+
+/*--------------------------------------------------------------------*/
+
+/* Return a SymTable object that answers from the snapshot in the file
+at pcPath, mapped read-only into memory, or NULL if the file cannot be
+mapped, is not a snapshot written on a machine of the same byte order
+and word size, or insufficient memory is available. Lookups neither
+parse nor allocate, and processes that map the same file share its
+pages. SymTable_get returns the address of the saved value bytes,
+which are 8-byte aligned and must not be written. The table is
+read-only: SymTable_put, SymTable_putK, SymTable_upsert,
+SymTable_getOrInsert, SymTable_putBatch, SymTable_merge and
+SymTable_setHash fail, SymTable_replace and SymTable_remove find
+nothing, and SymTable_iterBegin returns NULL. SymTable_free unmaps
+the file. */
+
+SymTable_T SymTable_openMapped(const char *pcPath);
+
+/*--------------------------------------------------------------------*/
+
+/* Make oSymTable read-only, with the same rules as a table that
+SymTable_openMapped returns, and return 1 (TRUE). Its bindings move
+into a minimal perfect hash over one contiguous array of keys and
+values, so that each lookup reads one pilot, one offset and one entry
+and compares one key. The table then takes, per binding, its key and
+value with a 32-bit length, padded to 8 bytes, a 32-bit offset, and
+about 3.5 bits of hash function. Addresses that SymTable_upsert and
+SymTable_getOrInsert returned are no longer valid. If oSymTable is
+already read-only, has live iterators, or has 2^32 or more bindings, or
+insufficient memory is available, leave oSymTable unchanged and return
+0 (FALSE). SymTable_freeze must not overlap other calls on the same
+table. */
+
+int SymTable_freeze(SymTable_T oSymTable);
+
+/*--------------------------------------------------------------------*/
+
+/* The input formats of SymTable_loadStream. */
+
+enum SymTableFormat
+{
+     /* Lines of a key, a tab and a value, each ended by '\n' except
+     perhaps the last. A line without a tab is a key with an empty
+     value, and empty lines are skipped. */
+     SYMTABLE_FORMAT_TSV,
+
+     /* Records of a uint32_t key length and a uint32_t value length,
+     in the byte order of the machine, followed by that many bytes of
+     key and then of value. */
+     SYMTABLE_FORMAT_BINARY
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Read records of format eFormat from the file descriptor iFd until
+its end and add a binding for each, as SymTable_put does, so that the
+first record of a key wins. The value of a binding is what
+(*pfParse)(pcValue, uLength) returns for the uLength bytes of its
+record's value, which are followed by a '\0' during the call; pfParse
+is only called for keys that oSymTable does not have yet, and must not
+use oSymTable. With a NULL pfParse every value is NULL. Return 1
+(TRUE), or 0 (FALSE) if a read fails, the input ends inside a record,
+a key holds a '\0', oSymTable is mapped, or insufficient memory is
+available; the bindings added before the failure stay. */
+
+int SymTable_loadStream(SymTable_T oSymTable, int iFd,
+     enum SymTableFormat eFormat,
+     void *(*pfParse)(const char *pcValue, size_t uLength));
+
+/*--------------------------------------------------------------------*/
+/* The declarations below are extensions that only the ordered        */
+/* implementations (symtabletree.c and symtableart.c) provide. Their  */
+/* SymTable_map visits the bindings in increasing strcmp order of     */
+/* their keys.                                                        */
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable whose key is 
+at least pcLow and less than pcHigh, as SymTable_map does, in 
+increasing order of their keys. A NULL pcLow or pcHigh leaves that end
+of the range open. This takes O(log n + k) time for k elements, or
+O(length of pcLow + k) in symtableart.c. */
+
+void SymTable_mapRange(SymTable_T oSymTable,
+     const char *pcLow, const char *pcHigh,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable whose key 
+begins with pcPrefix, as SymTable_map does, in increasing order of 
+their keys. This takes O(log n + k) time for k elements, or 
+O(length of pcPrefix + k) in symtableart.c. */
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+     void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+     const void *pvExtra);
+
 #endif
@@ -0,0 +1,1185 @@
+/*--------------------------------------------------------------------*/
+/* symtableart.c                                                      */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__SSE2__)
+#define SYMTABLE_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The bindings are kept in an adaptive radix tree. Each inner node
+branches on one byte of the key, and the terminating '\0' counts as a
+byte, so no key is a prefix of another and every key ends at a leaf.
+An inner node has room for 4, 16, 48 or 256 children and is replaced
+by the next larger or smaller kind as it fills or empties. Bytes that
+all the keys under a node share are stored once, as the node's prefix,
+instead of as a chain of one-child nodes. A lookup reads one node per
+distinguishing byte and compares the whole key once, at the leaf; no
+hash is computed. */
+
+enum {NODE4 = 1, NODE16, NODE48, NODE256};
+
+/* The number of prefix bytes an inner node stores itself. The rest of
+a longer prefix is read from the key of any leaf below the node. */
+
+enum {MAX_PREFIX_LENGTH = 10};
+
+/* The child counts at which an inner node is replaced by the next
+smaller kind. */
+
+enum {NODE16_MIN = 3, NODE48_MIN = 12, NODE256_MIN = 37};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableLeaf holds one binding and the whole of its key, so that
+the key passed to a map function stays put. */
+
+struct SymTableLeaf
+{
+    /* The value associated with the binding's key. */
+    const void *pvValue;
+
+    /* The binding's key. */
+    char acKey[1];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableInner is the part common to every kind of inner node. */
+
+struct SymTableInner
+{
+    /* NODE4, NODE16, NODE48 or NODE256. */
+    unsigned char ucType;
+
+    /* The number of children. */
+    unsigned uChildCount;
+
+    /* The number of bytes that every key below the node shares from
+    the node's depth on, and the first MAX_PREFIX_LENGTH of them. */
+    size_t uPrefixLength;
+    unsigned char aucPrefix[MAX_PREFIX_LENGTH];
+};
+
+/* The children of a NODE4 or NODE16 are sorted by their bytes. */
+
+struct SymTableNode4
+{
+    struct SymTableInner sInner;
+    unsigned char aucKeys[4];
+    void *apvChildren[4];
+};
+
+struct SymTableNode16
+{
+    struct SymTableInner sInner;
+    unsigned char aucKeys[16];
+    void *apvChildren[16];
+};
+
+/* aucIndex[c] is 0 if a NODE48 has no child for byte c, and otherwise
+1 more than that child's place in apvChildren. */
+
+struct SymTableNode48
+{
+    struct SymTableInner sInner;
+    unsigned char aucIndex[256];
+    void *apvChildren[48];
+};
+
+struct SymTableNode256
+{
+    struct SymTableInner sInner;
+    void *apvChildren[256];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is the root of an adaptive radix tree. A child pointer,
+the root included, is NULL, the address of an inner node, or the
+address of a leaf with its low bit set. */
+
+struct SymTable
+{
+    /* The root, or NULL if the table is empty. */
+    void *pvRoot;
+
+    /* number of bindings in symtable */
+    size_t length;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if pvNode is a leaf, or 0 (FALSE) if it is an inner
+node. */
+
+static int SymTable_isLeaf(const void *pvNode)
+{
+    return ((uintptr_t)pvNode & 1) != 0;
+}
+
+/* Return the leaf that pvNode points to. */
+
+static struct SymTableLeaf *SymTable_asLeaf(void *pvNode)
+{
+    return (struct SymTableLeaf *)((uintptr_t)pvNode & ~(uintptr_t)1);
+}
+
+/* Return a child pointer to psLeaf. */
+
+static void *SymTable_tagLeaf(struct SymTableLeaf *psLeaf)
+{
+    return (void *)((uintptr_t)psLeaf | 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the child of psInner for byte ucByte, or NULL
+if it has none. */
+
+static void **SymTable_findChild(struct SymTableInner *psInner,
+    unsigned char ucByte)
+{
+    struct SymTableNode4 *psNode4;
+    struct SymTableNode16 *psNode16;
+    struct SymTableNode48 *psNode48;
+    struct SymTableNode256 *psNode256;
+    unsigned u;
+#ifdef SYMTABLE_HAVE_SSE2
+    unsigned uMatches;
+#endif
+
+    switch (psInner->ucType)
+    {
+        case NODE4:
+            psNode4 = (struct SymTableNode4 *)psInner;
+            for (u = 0; u < psInner->uChildCount; u++)
+            {
+                if (psNode4->aucKeys[u] == ucByte) {
+                    return &psNode4->apvChildren[u];
+                }
+            }
+            return NULL;
+
+        case NODE16:
+            psNode16 = (struct SymTableNode16 *)psInner;
+#ifdef SYMTABLE_HAVE_SSE2
+            /* compare all 16 bytes with one instruction */
+            uMatches = (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(
+                _mm_loadu_si128((const __m128i *)psNode16->aucKeys),
+                _mm_set1_epi8((char)ucByte)));
+            uMatches &= (1U << psInner->uChildCount) - 1;
+            if (uMatches != 0) {
+                return &psNode16->apvChildren[__builtin_ctz(uMatches)];
+            }
+#else
+            for (u = 0; u < psInner->uChildCount; u++)
+            {
+                if (psNode16->aucKeys[u] == ucByte) {
+                    return &psNode16->apvChildren[u];
+                }
+            }
+#endif
+            return NULL;
+
+        case NODE48:
+            psNode48 = (struct SymTableNode48 *)psInner;
+            if (psNode48->aucIndex[ucByte] == 0) {
+                return NULL;
+            }
+            return &psNode48->apvChildren[psNode48->aucIndex[ucByte] - 1];
+
+        default:
+            psNode256 = (struct SymTableNode256 *)psInner;
+            if (psNode256->apvChildren[ucByte] == NULL) {
+                return NULL;
+            }
+            return &psNode256->apvChildren[ucByte];
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Find the first child of psInner, in byte order, whose place is
+uPlace or later. Store its byte in *pucByte and the child in *ppvChild,
+and return the place after it, or return 0 if there is none. The places
+of a NODE4 or NODE16 are array positions, and those of the other kinds
+are bytes, all counted from 1. */
+
+static unsigned SymTable_nextChild(struct SymTableInner *psInner,
+    unsigned uPlace, unsigned char *pucByte, void **ppvChild)
+{
+    struct SymTableNode4 *psNode4;
+    struct SymTableNode16 *psNode16;
+    struct SymTableNode48 *psNode48;
+    struct SymTableNode256 *psNode256;
+
+    switch (psInner->ucType)
+    {
+        case NODE4:
+            psNode4 = (struct SymTableNode4 *)psInner;
+            if (uPlace > psInner->uChildCount) {
+                return 0;
+            }
+            *pucByte = psNode4->aucKeys[uPlace - 1];
+            *ppvChild = psNode4->apvChildren[uPlace - 1];
+            return uPlace + 1;
+
+        case NODE16:
+            psNode16 = (struct SymTableNode16 *)psInner;
+            if (uPlace > psInner->uChildCount) {
+                return 0;
+            }
+            *pucByte = psNode16->aucKeys[uPlace - 1];
+            *ppvChild = psNode16->apvChildren[uPlace - 1];
+            return uPlace + 1;
+
+        case NODE48:
+            psNode48 = (struct SymTableNode48 *)psInner;
+            for (; uPlace <= 256; uPlace++)
+            {
+                if (psNode48->aucIndex[uPlace - 1] != 0) {
+                    *pucByte = (unsigned char)(uPlace - 1);
+                    *ppvChild = psNode48->apvChildren[
+                        psNode48->aucIndex[uPlace - 1] - 1];
+                    return uPlace + 1;
+                }
+            }
+            return 0;
+
+        default:
+            psNode256 = (struct SymTableNode256 *)psInner;
+            for (; uPlace <= 256; uPlace++)
+            {
+                if (psNode256->apvChildren[uPlace - 1] != NULL) {
+                    *pucByte = (unsigned char)(uPlace - 1);
+                    *ppvChild = psNode256->apvChildren[uPlace - 1];
+                    return uPlace + 1;
+                }
+            }
+            return 0;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leaf with the smallest key below pvNode. */
+
+static struct SymTableLeaf *SymTable_minimum(void *pvNode)
+{
+    unsigned char ucByte;
+
+    while (! SymTable_isLeaf(pvNode))
+    {
+        (void)SymTable_nextChild((struct SymTableInner *)pvNode, 1,
+            &ucByte, &pvNode);
+    }
+    return SymTable_asLeaf(pvNode);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the whole prefix of psInner, which is at
+uDepth: the node's own copy if it is short enough, and otherwise the
+same bytes of the smallest key below the node. */
+
+static const unsigned char *SymTable_prefixBytes(
+    struct SymTableInner *psInner, size_t uDepth)
+{
+    if (psInner->uPrefixLength <= MAX_PREFIX_LENGTH) {
+        return psInner->aucPrefix;
+    }
+    return (const unsigned char *)SymTable_minimum(psInner)->acKey +
+        uDepth;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first position at which the prefix of psInner, which is
+at uDepth, differs from pcKey from uDepth on, or the prefix length if
+it does not. A prefix never contains '\0', so the comparison stops at
+the end of pcKey. */
+
+static size_t SymTable_prefixMismatch(struct SymTableInner *psInner,
+    const char *pcKey, size_t uDepth)
+{
+    const unsigned char *pucKey = (const unsigned char *)pcKey + uDepth;
+    const char *pcMinKey;
+    size_t uStored = psInner->uPrefixLength;
+    size_t u;
+
+    if (uStored > MAX_PREFIX_LENGTH) {
+        uStored = MAX_PREFIX_LENGTH;
+    }
+
+    for (u = 0; u < uStored; u++)
+    {
+        if (psInner->aucPrefix[u] != pucKey[u]) {
+            return u;
+        }
+    }
+
+    if (psInner->uPrefixLength > MAX_PREFIX_LENGTH) {
+        pcMinKey = SymTable_minimum(psInner)->acKey + uDepth;
+        for (; u < psInner->uPrefixLength; u++)
+        {
+            if ((unsigned char)pcMinKey[u] != pucKey[u]) {
+                return u;
+            }
+        }
+    }
+    return psInner->uPrefixLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set the prefix of psInner to the uLength bytes at pucPrefix. */
+
+static void SymTable_setPrefix(struct SymTableInner *psInner,
+    const unsigned char *pucPrefix, size_t uLength)
+{
+    psInner->uPrefixLength = uLength;
+    memcpy(psInner->aucPrefix, pucPrefix,
+        uLength < MAX_PREFIX_LENGTH ? uLength : MAX_PREFIX_LENGTH);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new inner node of kind ucType with no children and no
+prefix, or NULL if insufficient memory is available. */
+
+static struct SymTableInner *SymTable_newInner(unsigned char ucType)
+{
+    static const size_t auSizes[] = {0, sizeof(struct SymTableNode4),
+        sizeof(struct SymTableNode16), sizeof(struct SymTableNode48),
+        sizeof(struct SymTableNode256)};
+    struct SymTableInner *psInner;
+
+    psInner = (struct SymTableInner *)calloc(1, auSizes[ucType]);
+    if (psInner == NULL) {
+        return NULL;
+    }
+    psInner->ucType = ucType;
+    return psInner;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add pvChild under byte ucByte to the NODE4 or NODE16 psInner, which
+must have room for it, keeping the bytes sorted. */
+
+static void SymTable_addSorted(struct SymTableInner *psInner,
+    unsigned char *aucKeys, void **apvChildren, unsigned char ucByte,
+    void *pvChild)
+{
+    unsigned uIndex;
+
+    for (uIndex = 0; uIndex < psInner->uChildCount &&
+    aucKeys[uIndex] < ucByte; uIndex++)
+    {
+    }
+
+    memmove(&aucKeys[uIndex + 1], &aucKeys[uIndex],
+        psInner->uChildCount - uIndex);
+    memmove(&apvChildren[uIndex + 1], &apvChildren[uIndex],
+        (psInner->uChildCount - uIndex) * sizeof(void *));
+    aucKeys[uIndex] = ucByte;
+    apvChildren[uIndex] = pvChild;
+    psInner->uChildCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Copy every child of psOld into psNew, a node of another kind with
+room for them, and make the prefix of psNew that of psOld. */
+
+static void SymTable_copyChildren(struct SymTableInner *psNew,
+    struct SymTableInner *psOld)
+{
+    struct SymTableNode4 *psNode4;
+    struct SymTableNode16 *psNode16;
+    struct SymTableNode48 *psNode48;
+    struct SymTableNode256 *psNode256;
+    unsigned char ucByte;
+    void *pvChild;
+    unsigned uPlace;
+
+    psNew->uPrefixLength = psOld->uPrefixLength;
+    memcpy(psNew->aucPrefix, psOld->aucPrefix, MAX_PREFIX_LENGTH);
+
+    for (uPlace = SymTable_nextChild(psOld, 1, &ucByte, &pvChild);
+    uPlace != 0;
+    uPlace = SymTable_nextChild(psOld, uPlace, &ucByte, &pvChild))
+    {
+        switch (psNew->ucType)
+        {
+            case NODE4:
+                psNode4 = (struct SymTableNode4 *)psNew;
+                SymTable_addSorted(psNew, psNode4->aucKeys,
+                    psNode4->apvChildren, ucByte, pvChild);
+                break;
+
+            case NODE16:
+                psNode16 = (struct SymTableNode16 *)psNew;
+                SymTable_addSorted(psNew, psNode16->aucKeys,
+                    psNode16->apvChildren, ucByte, pvChild);
+                break;
+
+            case NODE48:
+                psNode48 = (struct SymTableNode48 *)psNew;
+                psNode48->apvChildren[psNew->uChildCount] = pvChild;
+                psNew->uChildCount++;
+                psNode48->aucIndex[ucByte] =
+                    (unsigned char)psNew->uChildCount;
+                break;
+
+            default:
+                psNode256 = (struct SymTableNode256 *)psNew;
+                psNode256->apvChildren[ucByte] = pvChild;
+                psNew->uChildCount++;
+                break;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add pvChild under byte ucByte, for which it has no child, to the
+inner node psInner that *ppvRef points to. A full node is replaced by
+one of the next larger kind. Return 1 (TRUE), or 0 (FALSE) and leave the
+node unchanged if insufficient memory is available. */
+
+static int SymTable_addChild(void **ppvRef, struct SymTableInner *psInner,
+    unsigned char ucByte, void *pvChild)
+{
+    static const unsigned auCapacities[] = {0, 4, 16, 48, 256};
+    struct SymTableNode4 *psNode4;
+    struct SymTableNode16 *psNode16;
+    struct SymTableNode48 *psNode48;
+    struct SymTableInner *psLarger;
+    unsigned uSlot;
+
+    if (psInner->uChildCount == auCapacities[psInner->ucType]) {
+        psLarger = SymTable_newInner(
+            (unsigned char)(psInner->ucType + 1));
+        if (psLarger == NULL) {
+            return 0;
+        }
+        SymTable_copyChildren(psLarger, psInner);
+        free(psInner);
+        *ppvRef = psLarger;
+        psInner = psLarger;
+    }
+
+    switch (psInner->ucType)
+    {
+        case NODE4:
+            psNode4 = (struct SymTableNode4 *)psInner;
+            SymTable_addSorted(psInner, psNode4->aucKeys,
+                psNode4->apvChildren, ucByte, pvChild);
+            break;
+
+        case NODE16:
+            psNode16 = (struct SymTableNode16 *)psInner;
+            SymTable_addSorted(psInner, psNode16->aucKeys,
+                psNode16->apvChildren, ucByte, pvChild);
+            break;
+
+        case NODE48:
+            /* removals leave holes, so look for a free slot */
+            psNode48 = (struct SymTableNode48 *)psInner;
+            for (uSlot = 0; psNode48->apvChildren[uSlot] != NULL; uSlot++)
+            {
+            }
+            psNode48->apvChildren[uSlot] = pvChild;
+            psNode48->aucIndex[ucByte] = (unsigned char)(uSlot + 1);
+            psInner->uChildCount++;
+            break;
+
+        default:
+            ((struct SymTableNode256 *)psInner)->apvChildren[ucByte] =
+                pvChild;
+            psInner->uChildCount++;
+            break;
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replace the inner node psInner that *ppvRef points to by one of the
+next smaller kind, if memory is available; otherwise leave it. */
+
+static void SymTable_shrink(void **ppvRef, struct SymTableInner *psInner)
+{
+    struct SymTableInner *psSmaller;
+
+    psSmaller = SymTable_newInner((unsigned char)(psInner->ucType - 1));
+    if (psSmaller == NULL) {
+        return;
+    }
+    SymTable_copyChildren(psSmaller, psInner);
+    free(psInner);
+    *ppvRef = psSmaller;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Replace the NODE4 psInner that *ppvRef points to, which has one
+child left, by that child. An inner child takes over the node's prefix
+and the child's own byte in front of its prefix. */
+
+static void SymTable_collapse(void **ppvRef, struct SymTableInner *psInner)
+{
+    struct SymTableNode4 *psNode4 = (struct SymTableNode4 *)psInner;
+    struct SymTableInner *psChild;
+    unsigned char aucPrefix[2 * MAX_PREFIX_LENGTH + 1];
+    size_t uStored;
+
+    if (! SymTable_isLeaf(psNode4->apvChildren[0])) {
+        psChild = (struct SymTableInner *)psNode4->apvChildren[0];
+
+        uStored = psInner->uPrefixLength;
+        if (uStored > MAX_PREFIX_LENGTH) {
+            uStored = MAX_PREFIX_LENGTH;
+        }
+        memcpy(aucPrefix, psInner->aucPrefix, uStored);
+        aucPrefix[uStored] = psNode4->aucKeys[0];
+        memcpy(&aucPrefix[uStored + 1], psChild->aucPrefix,
+            MAX_PREFIX_LENGTH);
+
+        psChild->uPrefixLength += psInner->uPrefixLength + 1;
+        memcpy(psChild->aucPrefix, aucPrefix, MAX_PREFIX_LENGTH);
+    }
+
+    *ppvRef = psNode4->apvChildren[0];
+    free(psInner);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the child of the inner node psInner that *ppvRef points to
+for byte ucByte, whose address is ppvChild, and replace the node by a
+smaller kind if it has emptied enough. */
+
+static void SymTable_removeChild(void **ppvRef,
+    struct SymTableInner *psInner, unsigned char ucByte, void **ppvChild)
+{
+    struct SymTableNode4 *psNode4;
+    struct SymTableNode16 *psNode16;
+    struct SymTableNode48 *psNode48;
+    unsigned uIndex;
+
+    switch (psInner->ucType)
+    {
+        case NODE4:
+            psNode4 = (struct SymTableNode4 *)psInner;
+            uIndex = (unsigned)(ppvChild - psNode4->apvChildren);
+            memmove(&psNode4->aucKeys[uIndex], &psNode4->aucKeys[uIndex + 1],
+                psInner->uChildCount - uIndex - 1);
+            memmove(&psNode4->apvChildren[uIndex],
+                &psNode4->apvChildren[uIndex + 1],
+                (psInner->uChildCount - uIndex - 1) * sizeof(void *));
+            psInner->uChildCount--;
+            if (psInner->uChildCount == 1) {
+                SymTable_collapse(ppvRef, psInner);
+            }
+            break;
+
+        case NODE16:
+            psNode16 = (struct SymTableNode16 *)psInner;
+            uIndex = (unsigned)(ppvChild - psNode16->apvChildren);
+            memmove(&psNode16->aucKeys[uIndex],
+                &psNode16->aucKeys[uIndex + 1],
+                psInner->uChildCount - uIndex - 1);
+            memmove(&psNode16->apvChildren[uIndex],
+                &psNode16->apvChildren[uIndex + 1],
+                (psInner->uChildCount - uIndex - 1) * sizeof(void *));
+            psInner->uChildCount--;
+            if (psInner->uChildCount == NODE16_MIN) {
+                SymTable_shrink(ppvRef, psInner);
+            }
+            break;
+
+        case NODE48:
+            psNode48 = (struct SymTableNode48 *)psInner;
+            *ppvChild = NULL;
+            psNode48->aucIndex[ucByte] = 0;
+            psInner->uChildCount--;
+            if (psInner->uChildCount == NODE48_MIN) {
+                SymTable_shrink(ppvRef, psInner);
+            }
+            break;
+
+        default:
+            *ppvChild = NULL;
+            psInner->uChildCount--;
+            if (psInner->uChildCount == NODE256_MIN) {
+                SymTable_shrink(ppvRef, psInner);
+            }
+            break;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leaf of oSymTable whose key is pcKey, or NULL if there is
+none. Only the stored prefix bytes are checked on the way down; the
+final comparison with the leaf's key covers the rest. */
+
+static struct SymTableLeaf *SymTable_find(SymTable_T oSymTable,
+    const char *pcKey)
+{
+    void *pvNode = oSymTable->pvRoot;
+    struct SymTableInner *psInner;
+    struct SymTableLeaf *psLeaf;
+    void **ppvChild;
+    size_t uLength = strlen(pcKey);
+    size_t uDepth = 0;
+    size_t uStored;
+    size_t u;
+
+    while (pvNode != NULL)
+    {
+        if (SymTable_isLeaf(pvNode)) {
+            psLeaf = SymTable_asLeaf(pvNode);
+            return strcmp(psLeaf->acKey, pcKey) == 0 ? psLeaf : NULL;
+        }
+
+        psInner = (struct SymTableInner *)pvNode;
+        uStored = psInner->uPrefixLength;
+        if (uStored > MAX_PREFIX_LENGTH) {
+            uStored = MAX_PREFIX_LENGTH;
+        }
+        for (u = 0; u < uStored; u++)
+        {
+            if (psInner->aucPrefix[u] !=
+            (unsigned char)pcKey[uDepth + u]) {
+                return NULL;
+            }
+        }
+        uDepth += psInner->uPrefixLength;
+        if (uDepth > uLength) {
+            return NULL;
+        }
+
+        ppvChild = SymTable_findChild(psInner,
+            (unsigned char)pcKey[uDepth]);
+        if (ppvChild == NULL) {
+            return NULL;
+        }
+        pvNode = *ppvChild;
+        uDepth++;
+    }
+    return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add psLeaf, whose key the subtree *ppvRef at uDepth does not
+contain, to that subtree. Return 1 (TRUE), or 0 (FALSE) and leave the
+subtree unchanged if insufficient memory is available. */
+
+static int SymTable_insert(void **ppvRef, struct SymTableLeaf *psLeaf,
+    size_t uDepth)
+{
+    const unsigned char *pucKey = (const unsigned char *)psLeaf->acKey;
+    void *pvNode = *ppvRef;
+    struct SymTableLeaf *psOldLeaf;
+    struct SymTableInner *psInner;
+    struct SymTableInner *psSplit;
+    struct SymTableNode4 *psNode4;
+    const unsigned char *pucRest;
+    unsigned char ucOldByte;
+    void **ppvChild;
+    size_t uMismatch;
+    size_t uRestLength;
+    size_t u;
+
+    if (pvNode == NULL) {
+        *ppvRef = SymTable_tagLeaf(psLeaf);
+        return 1;
+    }
+
+    /* two leaves: a NODE4 holding their common bytes parts them */
+    if (SymTable_isLeaf(pvNode)) {
+        psOldLeaf = SymTable_asLeaf(pvNode);
+        for (u = uDepth; psOldLeaf->acKey[u] == psLeaf->acKey[u]; u++)
+        {
+        }
+
+        psSplit = SymTable_newInner(NODE4);
+        if (psSplit == NULL) {
+            return 0;
+        }
+        SymTable_setPrefix(psSplit, pucKey + uDepth, u - uDepth);
+        psNode4 = (struct SymTableNode4 *)psSplit;
+        SymTable_addSorted(psSplit, psNode4->aucKeys, psNode4->apvChildren,
+            (unsigned char)psOldLeaf->acKey[u], pvNode);
+        SymTable_addSorted(psSplit, psNode4->aucKeys, psNode4->apvChildren,
+            pucKey[u], SymTable_tagLeaf(psLeaf));
+        *ppvRef = psSplit;
+        return 1;
+    }
+
+    psInner = (struct SymTableInner *)pvNode;
+
+    /* the key leaves the prefix: a NODE4 above the node parts them */
+    uMismatch = SymTable_prefixMismatch(psInner, psLeaf->acKey, uDepth);
+    if (uMismatch < psInner->uPrefixLength) {
+        psSplit = SymTable_newInner(NODE4);
+        if (psSplit == NULL) {
+            return 0;
+        }
+        SymTable_setPrefix(psSplit, pucKey + uDepth, uMismatch);
+
+        pucRest = SymTable_prefixBytes(psInner, uDepth) + uMismatch;
+        ucOldByte = pucRest[0];
+        uRestLength = psInner->uPrefixLength - uMismatch - 1;
+        memmove(psInner->aucPrefix, pucRest + 1,
+            uRestLength < MAX_PREFIX_LENGTH ?
+            uRestLength : MAX_PREFIX_LENGTH);
+        psInner->uPrefixLength = uRestLength;
+
+        psNode4 = (struct SymTableNode4 *)psSplit;
+        SymTable_addSorted(psSplit, psNode4->aucKeys, psNode4->apvChildren,
+            ucOldByte, psInner);
+        SymTable_addSorted(psSplit, psNode4->aucKeys, psNode4->apvChildren,
+            pucKey[uDepth + uMismatch], SymTable_tagLeaf(psLeaf));
+        *ppvRef = psSplit;
+        return 1;
+    }
+
+    uDepth += psInner->uPrefixLength;
+    ppvChild = SymTable_findChild(psInner, pucKey[uDepth]);
+    if (ppvChild != NULL) {
+        return SymTable_insert(ppvChild, psLeaf, uDepth + 1);
+    }
+    return SymTable_addChild(ppvRef, psInner, pucKey[uDepth],
+        SymTable_tagLeaf(psLeaf));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the leaf with key pcKey, of length uLength, from the subtree
+*ppvRef at uDepth and return it, or return NULL if there is none. */
+
+static struct SymTableLeaf *SymTable_delete(void **ppvRef,
+    const char *pcKey, size_t uLength, size_t uDepth)
+{
+    void *pvNode = *ppvRef;
+    struct SymTableInner *psInner;
+    struct SymTableLeaf *psLeaf;
+    unsigned char ucByte;
+    void **ppvChild;
+
+    if (pvNode == NULL) {
+        return NULL;
+    }
+
+    if (SymTable_isLeaf(pvNode)) {
+        psLeaf = SymTable_asLeaf(pvNode);
+        if (strcmp(psLeaf->acKey, pcKey) != 0) {
+            return NULL;
+        }
+        *ppvRef = NULL;
+        return psLeaf;
+    }
+
+    psInner = (struct SymTableInner *)pvNode;
+    if (SymTable_prefixMismatch(psInner, pcKey, uDepth) !=
+    psInner->uPrefixLength) {
+        return NULL;
+    }
+    uDepth += psInner->uPrefixLength;
+    if (uDepth > uLength) {
+        return NULL;
+    }
+
+    ucByte = (unsigned char)pcKey[uDepth];
+    ppvChild = SymTable_findChild(psInner, ucByte);
+    if (ppvChild == NULL) {
+        return NULL;
+    }
+
+    if (! SymTable_isLeaf(*ppvChild)) {
+        return SymTable_delete(ppvChild, pcKey, uLength, uDepth + 1);
+    }
+
+    psLeaf = SymTable_asLeaf(*ppvChild);
+    if (strcmp(psLeaf->acKey, pcKey) != 0) {
+        return NULL;
+    }
+    SymTable_removeChild(ppvRef, psInner, ucByte, ppvChild);
+    return psLeaf;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the subtree pvNode, leaves included. */
+
+static void SymTable_freeNode(void *pvNode)
+{
+    struct SymTableInner *psInner;
+    unsigned char ucByte;
+    void *pvChild;
+    unsigned uPlace;
+
+    if (SymTable_isLeaf(pvNode)) {
+        free(SymTable_asLeaf(pvNode));
+        return;
+    }
+
+    psInner = (struct SymTableInner *)pvNode;
+    for (uPlace = SymTable_nextChild(psInner, 1, &ucByte, &pvChild);
+    uPlace != 0;
+    uPlace = SymTable_nextChild(psInner, uPlace, &ucByte, &pvChild))
+    {
+        SymTable_freeNode(pvChild);
+    }
+    free(psInner);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply *pfApply, as SymTable_map does, to each leaf of the subtree
+pvNode at uDepth whose key is at least pcLow and less than pcHigh, in
+increasing order of their keys. A NULL pcLow or pcHigh leaves that end
+of the range open. If pcLow is not NULL, the keys below pvNode agree
+with it on their first uDepth bytes. Return 0 (FALSE) once a key
+reaches pcHigh, and 1 (TRUE) otherwise. */
+
+static int SymTable_walk(void *pvNode, size_t uDepth, const char *pcLow,
+    const char *pcHigh, void (*pfApply)(const char *pcKey,
+    void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    struct SymTableInner *psInner;
+    struct SymTableLeaf *psLeaf;
+    const unsigned char *pucPrefix;
+    const unsigned char *pucLow;
+    unsigned char ucByte;
+    void *pvChild;
+    unsigned uPlace;
+    size_t u;
+
+    if (SymTable_isLeaf(pvNode)) {
+        psLeaf = SymTable_asLeaf(pvNode);
+        if (pcLow != NULL && strcmp(psLeaf->acKey, pcLow) < 0) {
+            return 1;
+        }
+        if (pcHigh != NULL && strcmp(psLeaf->acKey, pcHigh) >= 0) {
+            return 0;
+        }
+        (*pfApply) (psLeaf->acKey, (void *) psLeaf->pvValue,
+            (void *) pvExtra);
+        return 1;
+    }
+
+    psInner = (struct SymTableInner *)pvNode;
+
+    /* a prefix that sorts after pcLow puts the whole subtree in range,
+    and one that sorts before it puts the whole subtree out */
+    if (pcLow != NULL) {
+        pucPrefix = SymTable_prefixBytes(psInner, uDepth);
+        pucLow = (const unsigned char *)pcLow + uDepth;
+        for (u = 0; u < psInner->uPrefixLength; u++)
+        {
+            if (pucPrefix[u] != pucLow[u]) {
+                if (pucPrefix[u] < pucLow[u]) {
+                    return 1;
+                }
+                pcLow = NULL;
+                break;
+            }
+        }
+    }
+    uDepth += psInner->uPrefixLength;
+
+    for (uPlace = SymTable_nextChild(psInner, 1, &ucByte, &pvChild);
+    uPlace != 0;
+    uPlace = SymTable_nextChild(psInner, uPlace, &ucByte, &pvChild))
+    {
+        if (pcLow != NULL && ucByte < (unsigned char)pcLow[uDepth]) {
+            continue;
+        }
+        if (! SymTable_walk(pvChild, uDepth + 1,
+        pcLow != NULL && ucByte == (unsigned char)pcLow[uDepth] ?
+        pcLow : NULL, pcHigh, pfApply, pvExtra)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings, or NULL if
+insufficient memory is available. */
+
+SymTable_T SymTable_new(void)
+{
+    return (SymTable_T)calloc(1, sizeof(struct SymTable));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oSymTable */
+
+void SymTable_free(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+
+    if (oSymTable->pvRoot != NULL) {
+        SymTable_freeNode(oSymTable->pvRoot);
+    }
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable */
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+
+    return oSymTable->length;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new binding to oSymTable consisting of key pcKey and value
+pvValue and return 1 (TRUE) if oSymTable does not already contain a
+binding with key pcKey. Otherwise, if either oSymTable contains such a
+binding or insufficient memory is available, leave oSymTable unchanged
+and return 0 (FALSE). */
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void
+*pvValue)
+{
+    struct SymTableLeaf *psLeaf;
+    size_t uLength;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    if (SymTable_find(oSymTable, pcKey) != NULL) {
+        return 0;
+    }
+
+    /* defensive copy */
+    uLength = strlen(pcKey);
+    psLeaf = (struct SymTableLeaf *)malloc(
+        offsetof(struct SymTableLeaf, acKey) + uLength + 1);
+
+    if (psLeaf == NULL)
+    {
+        return 0;
+    }
+
+    memcpy(psLeaf->acKey, pcKey, uLength + 1);
+    psLeaf->pvValue = pvValue;
+
+    if (! SymTable_insert(&oSymTable->pvRoot, psLeaf, 0)) {
+        free(psLeaf);
+        return 0;
+    }
+
+    oSymTable->length++;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, replace the binding's
+value with pvValue and return the old value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const
+void *pvValue)
+{
+    struct SymTableLeaf *psLeaf;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psLeaf = SymTable_find(oSymTable, pcKey);
+
+    if (psLeaf == NULL) {
+        return NULL;
+    }
+
+    oldval = (void *) psLeaf->pvValue;
+    psLeaf->pvValue = pvValue;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey,
+or 0 (FALSE) if otherwise. */
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_find(oSymTable, pcKey) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is pcKey,
+or NULL if no such binding exists. */
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+    struct SymTableLeaf *psLeaf;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psLeaf = SymTable_find(oSymTable, pcKey);
+
+    if (psLeaf == NULL) {
+        return NULL;
+    }
+
+    return (void *) psLeaf->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, remove that binding
+from oSymTable and return the binding's value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+    struct SymTableLeaf *psLeaf;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psLeaf = SymTable_delete(&oSymTable->pvRoot, pcKey, strlen(pcKey), 0);
+
+    if (psLeaf == NULL) {
+        return NULL;
+    }
+
+    oldval = (void *) psLeaf->pvValue;
+    free(psLeaf);
+    oSymTable->length--;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable, passing pvExtra
+as an extra argument. That is, for each element pcKey and its value
+pvValue of oSymTable, call (*pfApply) (pcKey, pvValue, pvExtra). The
+elements are visited in increasing order of their keys. */
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char
+*pcKey, void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    SymTable_mapRange(oSymTable, NULL, NULL, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply, as SymTable_map does, to each element of
+oSymTable whose key is at least pcLow and less than pcHigh, in
+increasing order of their keys. A NULL pcLow or pcHigh leaves that end
+of the range open. The walk skips whole subtrees below pcLow on its way
+down and stops at the first key that reaches pcHigh. */
+
+void SymTable_mapRange(SymTable_T oSymTable, const char *pcLow,
+    const char *pcHigh, void (*pfApply)(const char *pcKey,
+    void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    if (oSymTable->pvRoot != NULL) {
+        (void)SymTable_walk(oSymTable->pvRoot, 0, pcLow, pcHigh, pfApply,
+            pvExtra);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply, as SymTable_map does, to each element of
+oSymTable whose key begins with pcPrefix, in increasing order of their
+keys. Following pcPrefix down the tree leads to the one subtree that
+holds exactly those keys. */
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra)
+{
+    const unsigned char *pucPrefix = (const unsigned char *)pcPrefix;
+    void *pvNode;
+    struct SymTableInner *psInner;
+    struct SymTableLeaf *psLeaf;
+    const unsigned char *pucNodePrefix;
+    void **ppvChild;
+    size_t uPrefixLength;
+    size_t uDepth = 0;
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+
+    uPrefixLength = strlen(pcPrefix);
+
+    for (pvNode = oSymTable->pvRoot; pvNode != NULL; pvNode = *ppvChild)
+    {
+        if (SymTable_isLeaf(pvNode)) {
+            psLeaf = SymTable_asLeaf(pvNode);
+            if (strncmp(psLeaf->acKey, pcPrefix, uPrefixLength) == 0) {
+                (*pfApply) (psLeaf->acKey, (void *) psLeaf->pvValue,
+                    (void *) pvExtra);
+            }
+            return;
+        }
+
+        psInner = (struct SymTableInner *)pvNode;
+        pucNodePrefix = SymTable_prefixBytes(psInner, uDepth);
+        for (u = 0; u < psInner->uPrefixLength &&
+        uDepth + u < uPrefixLength; u++)
+        {
+            if (pucNodePrefix[u] != pucPrefix[uDepth + u]) {
+                return;
+            }
+        }
+        uDepth += psInner->uPrefixLength;
+
+        if (uDepth >= uPrefixLength) {
+            (void)SymTable_walk(psInner, uDepth - psInner->uPrefixLength,
+                NULL, NULL, pfApply, pvExtra);
+            return;
+        }
+
+        ppvChild = SymTable_findChild(psInner, pucPrefix[uDepth]);
+        if (ppvChild == NULL) {
+            return;
+        }
+        uDepth++;
+    }
+}
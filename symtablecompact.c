@@ -0,0 +1,546 @@
+/*--------------------------------------------------------------------*/
+/* symtablecompact.c                                                  */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The bindings are stored in a dense array of SymTableEntry objects,
+in the order in which they were put. A separate index of small slots,
+probed like an open addressing table, maps hash codes to positions in
+that array. The index slots are 8, 16, 32 or 64 bits wide, whichever
+is the narrowest that can hold every position, so a small table's index
+costs a byte per slot. */
+
+struct SymTableEntry
+{
+    /* The binding's key, or NULL if the binding has been removed. */
+    const char *pcKey;
+
+    /* The value associated with the binding's key. */
+    const void *pvValue;
+
+    /* The full hash code of the binding's key. */
+    size_t uHash;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is an array of entries and an index over them. */
+
+struct SymTable
+{
+    /* The address of the first SymTableEntry */
+    struct SymTableEntry *psEntries;
+
+    /* The number of entries used, counting those of removed bindings,
+    and the number allocated. */
+    size_t uEntryCount;
+    size_t uEntrySize;
+
+    /* The index slots, each an ENTRY_EMPTY, an ENTRY_REMOVED, or the
+    position of an entry, uSlotWidth bytes wide. */
+    void *pvIndex;
+
+    /* The number of index slots, always a power of two. */
+    size_t uSlotCount;
+
+    /* The width of an index slot in bytes: 1, 2, 4 or 8. */
+    size_t uSlotWidth;
+
+    /* number of bindings in symtable */
+    size_t length;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* The values of index slots that refer to no entry. A slot that has
+never been used is ENTRY_EMPTY and ends a probe; one whose binding was
+removed is ENTRY_REMOVED, and a probe continues past it. */
+
+enum {ENTRY_EMPTY = -1, ENTRY_REMOVED = -2};
+
+enum {MIN_SLOT_COUNT = 8};
+
+/* At most USABLE_NUMERATOR / USABLE_DENOMINATOR of the index slots
+have entries, so that probes stay short. */
+
+enum {USABLE_NUMERATOR = 2, USABLE_DENOMINATOR = 3};
+
+/* How far a probe sequence shifts the unused hash bits in at each
+step. */
+
+enum {PERTURB_SHIFT = 5};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for pcKey. The 65599 hash is mixed afterwards
+so that its low bits, which select the first index slot, depend on
+every character of pcKey. */
+
+static size_t SymTable_hash(const char *pcKey)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = 0;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+   {
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+   }
+
+   uHash ^= uHash >> 17;
+   uHash *= 0xed5ad4bbU;
+   uHash ^= uHash >> 11;
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of entries that an index of uSlotCount slots may
+refer to. */
+
+static size_t SymTable_usable(size_t uSlotCount)
+{
+    return uSlotCount / USABLE_DENOMINATOR * USABLE_NUMERATOR +
+        uSlotCount % USABLE_DENOMINATOR * USABLE_NUMERATOR /
+        USABLE_DENOMINATOR;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the width in bytes of the slots of an index of uSlotCount
+slots: the narrowest signed integer that holds every entry position. */
+
+static size_t SymTable_slotWidth(size_t uSlotCount)
+{
+    if (uSlotCount <= (size_t)INT8_MAX + 1) {
+        return 1;
+    }
+    if (uSlotCount <= (size_t)INT16_MAX + 1) {
+        return 2;
+    }
+    if (uSlotCount <= (size_t)INT32_MAX + 1) {
+        return 4;
+    }
+    return 8;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of index slot uSlot of oSymTable. */
+
+static ptrdiff_t SymTable_getSlot(SymTable_T oSymTable, size_t uSlot)
+{
+    switch (oSymTable->uSlotWidth)
+    {
+        case 1:
+            return ((const int8_t *)oSymTable->pvIndex)[uSlot];
+        case 2:
+            return ((const int16_t *)oSymTable->pvIndex)[uSlot];
+        case 4:
+            return ((const int32_t *)oSymTable->pvIndex)[uSlot];
+        default:
+            return (ptrdiff_t)((const int64_t *)oSymTable->pvIndex)[uSlot];
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Set index slot uSlot of oSymTable to iValue. */
+
+static void SymTable_setSlot(SymTable_T oSymTable, size_t uSlot,
+    ptrdiff_t iValue)
+{
+    switch (oSymTable->uSlotWidth)
+    {
+        case 1:
+            ((int8_t *)oSymTable->pvIndex)[uSlot] = (int8_t)iValue;
+            break;
+        case 2:
+            ((int16_t *)oSymTable->pvIndex)[uSlot] = (int16_t)iValue;
+            break;
+        case 4:
+            ((int32_t *)oSymTable->pvIndex)[uSlot] = (int32_t)iValue;
+            break;
+        default:
+            ((int64_t *)oSymTable->pvIndex)[uSlot] = (int64_t)iValue;
+            break;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index slot of oSymTable that holds the position of the
+binding with key pcKey whose hash code is uHash, or oSymTable->uSlotCount
+if there is no such binding. Each step mixes in more of the hash code,
+so keys that share a first slot soon take different paths. */
+
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+    size_t uHash)
+{
+    size_t uMask = oSymTable->uSlotCount - 1;
+    size_t uPerturb = uHash;
+    size_t uSlot = uHash & uMask;
+    ptrdiff_t iEntry;
+    struct SymTableEntry *psEntry;
+
+    for (;;)
+    {
+        iEntry = SymTable_getSlot(oSymTable, uSlot);
+        if (iEntry == ENTRY_EMPTY) {
+            return oSymTable->uSlotCount;
+        }
+
+        if (iEntry >= 0) {
+            psEntry = &oSymTable->psEntries[iEntry];
+            if (psEntry->uHash == uHash &&
+            strcmp(psEntry->pcKey, pcKey) == 0) {
+                return uSlot;
+            }
+        }
+
+        uPerturb >>= PERTURB_SHIFT;
+        uSlot = (uSlot * 5 + uPerturb + 1) & uMask;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Point the first unused index slot on the probe sequence of hash code
+uHash in oSymTable at entry iEntry. The index must have such a slot. */
+
+static void SymTable_insertSlot(SymTable_T oSymTable, size_t uHash,
+    ptrdiff_t iEntry)
+{
+    size_t uMask = oSymTable->uSlotCount - 1;
+    size_t uPerturb = uHash;
+    size_t uSlot = uHash & uMask;
+
+    while (SymTable_getSlot(oSymTable, uSlot) >= 0)
+    {
+        uPerturb >>= PERTURB_SHIFT;
+        uSlot = (uSlot * 5 + uPerturb + 1) & uMask;
+    }
+
+    SymTable_setSlot(oSymTable, uSlot, iEntry);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give oSymTable an index of uSlotCount slots and room for as many
+entries as that index may refer to, moving the bindings over in order
+and dropping the entries of removed ones. Return 1 (TRUE) on success,
+or 0 (FALSE) and leave oSymTable unchanged if insufficient memory is
+available. */
+
+static int SymTable_rebuild(SymTable_T oSymTable, size_t uSlotCount)
+{
+    struct SymTableEntry *psOldEntries = oSymTable->psEntries;
+    size_t uOldEntryCount = oSymTable->uEntryCount;
+    struct SymTableEntry *psNewEntries;
+    void *pvNewIndex;
+    size_t uEntrySize;
+    size_t uSlotWidth;
+    size_t i;
+
+    uEntrySize = SymTable_usable(uSlotCount);
+    uSlotWidth = SymTable_slotWidth(uSlotCount);
+    if (uEntrySize > ((size_t)-1) / sizeof(struct SymTableEntry) ||
+    uSlotCount > ((size_t)-1) / uSlotWidth) {
+        return 0;
+    }
+
+    psNewEntries = (struct SymTableEntry *)malloc(uEntrySize *
+        sizeof(struct SymTableEntry));
+    pvNewIndex = malloc(uSlotCount * uSlotWidth);
+    if (psNewEntries == NULL || pvNewIndex == NULL) {
+        free(psNewEntries);
+        free(pvNewIndex);
+        return 0;
+    }
+
+    /* every byte 0xFF makes every slot ENTRY_EMPTY, whatever its width */
+    memset(pvNewIndex, 0xFF, uSlotCount * uSlotWidth);
+
+    free(oSymTable->pvIndex);
+    oSymTable->psEntries = psNewEntries;
+    oSymTable->uEntrySize = uEntrySize;
+    oSymTable->uEntryCount = 0;
+    oSymTable->pvIndex = pvNewIndex;
+    oSymTable->uSlotCount = uSlotCount;
+    oSymTable->uSlotWidth = uSlotWidth;
+
+    for (i = 0; i < uOldEntryCount; i++)
+    {
+        if (psOldEntries[i].pcKey != NULL) {
+            psNewEntries[oSymTable->uEntryCount] = psOldEntries[i];
+            SymTable_insertSlot(oSymTable, psOldEntries[i].uHash,
+                (ptrdiff_t)oSymTable->uEntryCount);
+            oSymTable->uEntryCount++;
+        }
+    }
+
+    free(psOldEntries);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make room in oSymTable for one more entry. If the entries of removed
+bindings take up at least half the array, compacting it in place at the
+same size is enough; otherwise the index doubles. Return 1 (TRUE) on
+success, or 0 (FALSE) and leave oSymTable unchanged if insufficient
+memory is available. */
+
+static int SymTable_makeRoom(SymTable_T oSymTable)
+{
+    size_t uSlotCount = oSymTable->uSlotCount;
+
+    if (oSymTable->uEntryCount < oSymTable->uEntrySize) {
+        return 1;
+    }
+
+    if (oSymTable->length * 2 > oSymTable->uEntrySize) {
+        if (uSlotCount > ((size_t)-1) / 2) {
+            return 0;
+        }
+        uSlotCount *= 2;
+    }
+
+    return SymTable_rebuild(oSymTable, uSlotCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings, or NULL if
+insufficient memory is available. */
+
+SymTable_T SymTable_new(void)
+{
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+
+    if (oSymTable == NULL)
+    {
+        return NULL;
+    }
+
+    if (! SymTable_rebuild(oSymTable, MIN_SLOT_COUNT))
+    {
+        free(oSymTable);
+        return NULL;
+    }
+
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oSymTable */
+
+void SymTable_free(SymTable_T oSymTable)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < oSymTable->uEntryCount; i++)
+    {
+        free((char *) oSymTable->psEntries[i].pcKey);
+    }
+
+    free(oSymTable->psEntries);
+    free(oSymTable->pvIndex);
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable */
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+
+    return oSymTable->length;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new binding to oSymTable consisting of key pcKey and value
+pvValue and return 1 (TRUE) if oSymTable does not already contain a
+binding with key pcKey. Otherwise, if either oSymTable contains such a
+binding or insufficient memory is available, leave oSymTable unchanged
+and return 0 (FALSE). The new binding comes after all the others. */
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void
+*pvValue)
+{
+    struct SymTableEntry *psEntry;
+    char *pcKeyCopy;
+    size_t uHash;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+
+    if (SymTable_find(oSymTable, pcKey, uHash) != oSymTable->uSlotCount) {
+        return 0;
+    }
+
+    if (! SymTable_makeRoom(oSymTable)) {
+        return 0;
+    }
+
+    /* defensive copy */
+    pcKeyCopy = (char*)malloc(strlen(pcKey) + 1);
+
+    if (pcKeyCopy == NULL)
+    {
+        return 0;
+    }
+
+    strcpy(pcKeyCopy, pcKey);
+    psEntry = &oSymTable->psEntries[oSymTable->uEntryCount];
+    psEntry->pcKey = pcKeyCopy;
+    psEntry->pvValue = pvValue;
+    psEntry->uHash = uHash;
+    SymTable_insertSlot(oSymTable, uHash,
+        (ptrdiff_t)oSymTable->uEntryCount);
+    oSymTable->uEntryCount++;
+    oSymTable->length++;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, replace the binding's
+value with pvValue and return the old value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const
+void *pvValue)
+{
+    struct SymTableEntry *psEntry;
+    size_t uSlot;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uSlot = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uSlot == oSymTable->uSlotCount) {
+        return NULL;
+    }
+
+    psEntry = &oSymTable->psEntries[SymTable_getSlot(oSymTable, uSlot)];
+    oldval = (void *) psEntry->pvValue;
+    psEntry->pvValue = pvValue;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey,
+or 0 (FALSE) if otherwise. */
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey)) !=
+        oSymTable->uSlotCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is pcKey,
+or NULL if no such binding exists. */
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uSlot;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uSlot = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uSlot == oSymTable->uSlotCount) {
+        return NULL;
+    }
+
+    return (void *)
+        oSymTable->psEntries[SymTable_getSlot(oSymTable, uSlot)].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, remove that binding
+from oSymTable and return the binding's value. Otherwise leave oSymTable
+unchanged and return NULL. The entry stays in the array, emptied, until
+the next rebuild, so the other bindings keep their order. */
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+    struct SymTableEntry *psEntry;
+    size_t uSlot;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uSlot = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uSlot == oSymTable->uSlotCount) {
+        return NULL;
+    }
+
+    psEntry = &oSymTable->psEntries[SymTable_getSlot(oSymTable, uSlot)];
+    oldval = (void *) psEntry->pvValue;
+    free((char *) psEntry->pcKey);
+    psEntry->pcKey = NULL;
+    psEntry->pvValue = NULL;
+    SymTable_setSlot(oSymTable, uSlot, ENTRY_REMOVED);
+    oSymTable->length--;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable, passing pvExtra
+as an extra argument. That is, for each element pcKey and its value
+pvValue of oSymTable, call (*pfApply) (pcKey, pvValue, pvExtra). The
+elements are visited in the order in which they were put, by one pass
+over the entry array. */
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char
+*pcKey, void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    for (i = 0; i < oSymTable->uEntryCount; i++)
+    {
+        if (oSymTable->psEntries[i].pcKey != NULL) {
+            (*pfApply) ((char *) oSymTable->psEntries[i].pcKey,
+                (void*) oSymTable->psEntries[i].pvValue, (void*) pvExtra);
+        }
+    }
+}
@@ -0,0 +1,724 @@
+/*--------------------------------------------------------------------*/
+/* symtablegen.c                                                      */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The generator compiles a fixed list of keys into a C source file
+   that holds a minimal perfect hash table of them in const arrays,
+   and the lookup functions
+
+      void *<prefix>_get(const char *pcKey);
+      int <prefix>_contains(const char *pcKey);
+
+   which behave like SymTable_get and SymTable_contains on a SymTable
+   that holds exactly those keys. Nothing is built at run time.
+
+   Each key hashes to a bucket, and each bucket has a pilot: a number
+   that the generator chose so that mixing it into the hashes of the
+   bucket's keys sends them to distinct positions, none of which the
+   keys of any other bucket reach. A lookup thus hashes the key once,
+   reads one pilot, and compares the key with the one binding at the
+   position that the pilot gives. */
+
+/*--------------------------------------------------------------------*/
+
+/* The average number of keys per bucket. */
+
+enum {KEYS_PER_BUCKET = 4};
+
+/* The number of hash seeds to try before giving up. */
+
+enum {SEED_ATTEMPTS = 64};
+
+/* The FNV-1a multiplier that hashKey applies per byte, the
+   constants of the 64-bit finalizer that mixes the result, and the
+   multiplier that spreads a pilot over 64 bits. The generated code
+   uses the same constants. */
+
+#define FNV_PRIME 0x100000001b3ULL
+#define MIX_MULTIPLIER0 0xff51afd7ed558ccdULL
+#define MIX_MULTIPLIER1 0xc4ceb9fe1a85ec53ULL
+#define PILOT_MULTIPLIER 0x9e3779b97f4a7c15ULL
+
+/* The first hash seed to try, and the step between seeds. */
+
+#define SEED_INITIAL 0xcbf29ce484222325ULL
+#define SEED_STEP 0xa0761d6478bd642fULL
+
+/*--------------------------------------------------------------------*/
+
+/* A key of the input, with its value expression. */
+
+struct Key
+{
+   /* The key, '\0'-terminated. */
+   const char *pcKey;
+
+   /* The length of pcKey. */
+   size_t uLength;
+
+   /* The C expression of the value of the key, or NULL if the input
+      gave none. */
+   const char *pcValue;
+
+   /* The 1-based number of the key in the input. */
+   size_t uNumber;
+
+   /* The index of the key in the list of keys. */
+   size_t uIndex;
+
+   /* The offset of the key in the emitted key pool. */
+   size_t uOffset;
+
+   /* The hash of pcKey under the current seed. */
+   uint64_t uHash;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return uValue with its bits mixed so that every input bit affects
+   every output bit. */
+
+static uint64_t mix(uint64_t uValue)
+{
+   uValue ^= uValue >> 33;
+   uValue *= MIX_MULTIPLIER0;
+   uValue ^= uValue >> 33;
+   uValue *= MIX_MULTIPLIER1;
+   uValue ^= uValue >> 33;
+   return uValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the hash of the uLength bytes at pcKey under uSeed. The
+   emitted hash function computes the same value. */
+
+static uint64_t hashKey(const char *pcKey, size_t uLength,
+   uint64_t uSeed)
+{
+   const unsigned char *pucKey = (const unsigned char*)pcKey;
+   uint64_t uHash = uSeed;
+   size_t u;
+
+   for (u = 0; u < uLength; u++)
+      uHash = (uHash ^ pucKey[u]) * FNV_PRIME;
+   return mix(uHash ^ (uint64_t)uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the bucket among uBucketCount buckets of a key whose hash is
+   uHash. */
+
+static size_t bucketOf(uint64_t uHash, size_t uBucketCount)
+{
+   return (size_t)((uHash >> 32) % uBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the position among uKeyCount positions of a key whose hash
+   is uHash, in a bucket whose pilot is uPilot. */
+
+static size_t positionOf(uint64_t uHash, uint32_t uPilot,
+   size_t uKeyCount)
+{
+   return (size_t)(mix(uHash ^ ((uint64_t)uPilot * PILOT_MULTIPLIER)) %
+      uKeyCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write an error message made of pcProgram, pcMessage and pcDetail to
+   stderr, and exit with EXIT_FAILURE. */
+
+static void fail(const char *pcProgram, const char *pcMessage,
+   const char *pcDetail)
+{
+   fprintf(stderr, "%s: %s%s\n", pcProgram, pcMessage, pcDetail);
+   exit(EXIT_FAILURE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return memory for uCount objects of uSize bytes each, or exit with
+   an error message that names pcProgram if there is not enough. */
+
+static void *allocate(const char *pcProgram, size_t uCount, size_t uSize)
+{
+   void *pvMemory;
+
+   if (uSize != 0 && uCount > (size_t)-1 / uSize)
+      fail(pcProgram, "Insufficient memory", "");
+   pvMemory = malloc(uCount * uSize + 1);
+   if (pvMemory == NULL)
+      fail(pcProgram, "Insufficient memory", "");
+   return pvMemory;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read all of pfInput into memory, '\0'-terminated, and return it.
+   Store its length in *puLength. Exit with an error message that
+   names pcProgram if it cannot be read. */
+
+static char *readAll(const char *pcProgram, FILE *pfInput,
+   size_t *puLength)
+{
+   enum {INITIAL_SIZE = 4096};
+
+   char *pcText;
+   char *pcLarger;
+   size_t uSize = INITIAL_SIZE;
+   size_t uLength = 0;
+
+   pcText = allocate(pcProgram, uSize, 1);
+   for (;;)
+   {
+      uLength += fread(pcText + uLength, 1, uSize - uLength, pfInput);
+      if (uLength < uSize)
+         break;
+      if (uSize > (size_t)-1 / 4)
+         fail(pcProgram, "Insufficient memory", "");
+      uSize *= 2;
+      pcLarger = realloc(pcText, uSize + 1);
+      if (pcLarger == NULL)
+         fail(pcProgram, "Insufficient memory", "");
+      pcText = pcLarger;
+   }
+   if (ferror(pfInput))
+      fail(pcProgram, "Cannot read the key list", "");
+
+   pcText[uLength] = '\0';
+   *puLength = uLength;
+   return pcText;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Split the uLength bytes of pcText in place into lines, and store in
+   psKeys a key for each line. A line is a key, optionally followed by
+   a tab and the C expression of its value, so a line that starts with
+   a tab gives the empty key. A '\r' before a '\n' is dropped. Return
+   the number of keys. Exit with an error message that names pcProgram
+   if a key holds a '\0' or a line is empty, since an empty line more
+   likely is a slip than the empty key. */
+
+static size_t parseKeys(const char *pcProgram, char *pcText,
+   size_t uLength, struct Key *psKeys)
+{
+   char *pcLine = pcText;
+   char *pcEnd = pcText + uLength;
+   char *pcNewline;
+   char *pcTab;
+   char acLine[sizeof(unsigned long) * 3 + 1];
+   size_t uKeyCount = 0;
+
+   while (pcLine < pcEnd)
+   {
+      pcNewline = memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+      if (pcNewline == NULL)
+         pcNewline = pcEnd;
+      if (memchr(pcLine, '\0', (size_t)(pcNewline - pcLine)) != NULL)
+         fail(pcProgram, "A key holds a '\\0': ", pcLine);
+      *pcNewline = '\0';
+      if (pcNewline > pcLine && pcNewline[-1] == '\r')
+         pcNewline[-1] = '\0';
+
+      if (*pcLine == '\0')
+      {
+         sprintf(acLine, "%lu", (unsigned long)(uKeyCount + 1));
+         fail(pcProgram, "Empty line; start the line with a tab for "
+            "the empty key: line ", acLine);
+      }
+
+      pcTab = strchr(pcLine, '\t');
+      psKeys[uKeyCount].pcValue = NULL;
+      if (pcTab != NULL)
+      {
+         *pcTab = '\0';
+         if (pcTab[1] != '\0')
+            psKeys[uKeyCount].pcValue = pcTab + 1;
+      }
+      psKeys[uKeyCount].pcKey = pcLine;
+      psKeys[uKeyCount].uLength = strlen(pcLine);
+      psKeys[uKeyCount].uNumber = uKeyCount + 1;
+      uKeyCount++;
+      pcLine = pcNewline + 1;
+   }
+   return uKeyCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return -1, 0 or 1 as the hash of the key at pvFirst is less than,
+   equal to or greater than that of the key at pvSecond. */
+
+static int compareHashes(const void *pvFirst, const void *pvSecond)
+{
+   const struct Key *psFirst = pvFirst;
+   const struct Key *psSecond = pvSecond;
+
+   if (psFirst->uHash != psSecond->uHash)
+      return psFirst->uHash < psSecond->uHash ? -1 : 1;
+   if (psFirst->uLength != psSecond->uLength)
+      return psFirst->uLength < psSecond->uLength ? -1 : 1;
+   return memcmp(psFirst->pcKey, psSecond->pcKey, psFirst->uLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Hash the uKeyCount keys at psKeys under uSeed, and find a pilot for
+   each of the uBucketCount buckets that gives every key a distinct
+   position. Store the pilots in puPilots and, for each position, the
+   index in psKeys of the key there in puSlots. psSorted has room for
+   uKeyCount keys, and puBucketStart and puOrder for uBucketCount + 1
+   and uBucketCount indices. Return 1 if a pilot was found for every
+   bucket, or 0 if the seed fails. Exit with an error message that
+   names pcProgram if two keys are equal. */
+
+static int placeKeys(const char *pcProgram, struct Key *psKeys,
+   size_t uKeyCount, uint64_t uSeed, size_t uBucketCount,
+   uint32_t *puPilots, size_t *puSlots, struct Key *psSorted,
+   size_t *puBucketStart, size_t *puOrder)
+{
+   enum {MAX_BUCKET_SIZE = 64};
+
+   size_t auPositions[MAX_BUCKET_SIZE];
+   size_t uBucket;
+   size_t uSize;
+   size_t u;
+   size_t v;
+   size_t w;
+   uint32_t uPilot;
+   int iCollides;
+
+   for (u = 0; u < uKeyCount; u++)
+      psKeys[u].uHash = hashKey(psKeys[u].pcKey, psKeys[u].uLength, uSeed);
+
+   /* Two keys with equal hashes reach equal positions under every
+      pilot, so the seed fails; two equal keys always do. */
+   memcpy(psSorted, psKeys, uKeyCount * sizeof(*psKeys));
+   qsort(psSorted, uKeyCount, sizeof(*psSorted), compareHashes);
+   for (u = 1; u < uKeyCount; u++)
+      if (psSorted[u].uHash == psSorted[u - 1].uHash)
+      {
+         if (compareHashes(&psSorted[u], &psSorted[u - 1]) == 0)
+            fail(pcProgram, "Duplicate key: ", psSorted[u].pcKey);
+         return 0;
+      }
+
+   /* Group the keys by bucket in psSorted, and order the buckets by
+      decreasing size. */
+   for (u = 0; u <= uBucketCount; u++)
+      puBucketStart[u] = 0;
+   for (u = 0; u < uKeyCount; u++)
+      puBucketStart[bucketOf(psKeys[u].uHash, uBucketCount) + 1]++;
+   for (u = 0; u < uBucketCount; u++)
+   {
+      if (puBucketStart[u + 1] > MAX_BUCKET_SIZE)
+         return 0;
+      puBucketStart[u + 1] += puBucketStart[u];
+   }
+   for (u = 0; u < uKeyCount; u++)
+   {
+      uBucket = bucketOf(psKeys[u].uHash, uBucketCount);
+      psSorted[puBucketStart[uBucket]++] = psKeys[u];
+      psSorted[puBucketStart[uBucket] - 1].uIndex = u;
+   }
+   for (u = uBucketCount; u > 0; u--)
+      puBucketStart[u] = puBucketStart[u - 1];
+   puBucketStart[0] = 0;
+
+   w = 0;
+   for (uSize = MAX_BUCKET_SIZE; uSize > 0; uSize--)
+      for (u = 0; u < uBucketCount; u++)
+         if (puBucketStart[u + 1] - puBucketStart[u] == uSize)
+            puOrder[w++] = u;
+   for (u = 0; u < uBucketCount; u++)
+      if (puBucketStart[u + 1] == puBucketStart[u])
+      {
+         puOrder[w++] = u;
+         puPilots[u] = 0;
+      }
+
+   for (u = 0; u < uKeyCount; u++)
+      puSlots[u] = uKeyCount;
+
+   /* Place the largest buckets first, while most positions are free. */
+   for (w = 0; w < uBucketCount; w++)
+   {
+      uBucket = puOrder[w];
+      uSize = puBucketStart[uBucket + 1] - puBucketStart[uBucket];
+      if (uSize == 0)
+         break;
+      for (uPilot = 0; ; uPilot++)
+      {
+         iCollides = 0;
+         for (u = 0; u < uSize && ! iCollides; u++)
+         {
+            auPositions[u] = positionOf(
+               psSorted[puBucketStart[uBucket] + u].uHash, uPilot,
+               uKeyCount);
+            if (puSlots[auPositions[u]] != uKeyCount)
+               iCollides = 1;
+            for (v = 0; v < u && ! iCollides; v++)
+               if (auPositions[v] == auPositions[u])
+                  iCollides = 1;
+         }
+         if (! iCollides)
+            break;
+         if (uPilot == UINT32_MAX)
+            return 0;
+      }
+      puPilots[uBucket] = uPilot;
+      for (u = 0; u < uSize; u++)
+         puSlots[auPositions[u]] =
+            psSorted[puBucketStart[uBucket] + u].uIndex;
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the uLength bytes at pcKey to pfOutput as C character
+   constants, 12 to a line and each followed by a comma, and then a
+   '\0'. A string literal would be shorter, but C99 compilers need
+   only accept literals of up to 4095 characters. */
+
+static void writeCharacters(FILE *pfOutput, const char *pcKey,
+   size_t uLength)
+{
+   const unsigned char *pucKey = (const unsigned char*)pcKey;
+   size_t u;
+
+   for (u = 0; u < uLength; u++)
+   {
+      if (u != 0 && u % 12 == 0)
+         fprintf(pfOutput, "\n    ");
+      if (pucKey[u] == '\'' || pucKey[u] == '\\')
+         fprintf(pfOutput, "'\\%c', ", pucKey[u]);
+      else if (isprint(pucKey[u]) && pucKey[u] < 0x80)
+         fprintf(pfOutput, "'%c', ", pucKey[u]);
+      else
+         fprintf(pfOutput, "'\\%03o', ", pucKey[u]);
+   }
+   fprintf(pfOutput, "'\\0',");
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write to pfOutput a C source file that defines pcPrefix_get and
+   pcPrefix_contains over the uKeyCount keys at psKeys, which
+   placeKeys placed under uSeed in uBucketCount buckets with the pilots
+   at puPilots and the positions at puSlots. The file includes
+   pcInclude, unless it is NULL. pcSource names the key list. */
+
+static void writeTable(FILE *pfOutput, const char *pcPrefix,
+   const char *pcInclude, const char *pcSource, struct Key *psKeys,
+   size_t uKeyCount, uint64_t uSeed, size_t uBucketCount,
+   const uint32_t *puPilots, const size_t *puSlots)
+{
+   const struct Key *psKey;
+   const char *pcPilotType;
+   uint32_t uMaxPilot = 0;
+   size_t uOffset = 0;
+   size_t u;
+
+   for (u = 0; u < uBucketCount; u++)
+      if (puPilots[u] > uMaxPilot)
+         uMaxPilot = puPilots[u];
+   if (uMaxPilot <= UINT8_MAX)
+      pcPilotType = "uint8_t";
+   else if (uMaxPilot <= UINT16_MAX)
+      pcPilotType = "uint16_t";
+   else
+      pcPilotType = "uint32_t";
+
+   fprintf(pfOutput,
+      "/*--------------------------------------------------------"
+      "------------*/\n"
+      "/* Generated by symtablegen from %s. Do not edit. */\n"
+      "/*--------------------------------------------------------"
+      "------------*/\n\n", pcSource);
+   fprintf(pfOutput,
+      "#include <assert.h>\n"
+      "#include <stddef.h>\n"
+      "#include <stdint.h>\n"
+      "#include <string.h>\n");
+   if (pcInclude != NULL)
+      fprintf(pfOutput, "#include \"%s\"\n", pcInclude);
+   fprintf(pfOutput,
+      "\n"
+      "void *%s_get(const char *pcKey);\n"
+      "int %s_contains(const char *pcKey);\n", pcPrefix, pcPrefix);
+
+   fprintf(pfOutput,
+      "\n/*--------------------------------------------------------"
+      "------------*/\n\n"
+      "/* The %lu keys, each followed by a '\\0'. */\n\n"
+      "static const char acKeys[] = {\n", (unsigned long)uKeyCount);
+   for (u = 0; u < uKeyCount; u++)
+   {
+      psKey = &psKeys[puSlots[u]];
+      psKeys[puSlots[u]].uOffset = uOffset;
+      uOffset += psKey->uLength + 1;
+      fprintf(pfOutput, "    ");
+      writeCharacters(pfOutput, psKey->pcKey, psKey->uLength);
+      fprintf(pfOutput, "\n");
+   }
+   if (uKeyCount == 0)
+      fprintf(pfOutput, "    '\\0',\n");
+   fprintf(pfOutput, "};\n");
+
+   fprintf(pfOutput,
+      "\n/* The bindings, each at the position that the perfect hash "
+      "gives its\n   key: the offset of the key in acKeys, its length "
+      "and its value. */\n\n"
+      "static const struct %sBinding\n"
+      "{\n"
+      "    uint32_t uOffset;\n"
+      "    uint32_t uLength;\n"
+      "    const void *pvValue;\n"
+      "} asBindings[%lu] = {\n", pcPrefix,
+      (unsigned long)(uKeyCount == 0 ? 1 : uKeyCount));
+   for (u = 0; u < uKeyCount; u++)
+   {
+      psKey = &psKeys[puSlots[u]];
+      fprintf(pfOutput, "    {%lu, %lu, ", (unsigned long)psKey->uOffset,
+         (unsigned long)psKey->uLength);
+      if (psKey->pcValue != NULL)
+         fprintf(pfOutput, "%s", psKey->pcValue);
+      else
+         fprintf(pfOutput, "(const void*)%lu",
+            (unsigned long)psKey->uNumber);
+      fprintf(pfOutput, "},\n");
+   }
+   if (uKeyCount == 0)
+      fprintf(pfOutput, "    {0, 1, NULL},\n");
+   fprintf(pfOutput, "};\n");
+
+   fprintf(pfOutput,
+      "\n/* The pilot of each bucket. */\n\n"
+      "static const %s auPilots[%lu] = {", pcPilotType,
+      (unsigned long)uBucketCount);
+   for (u = 0; u < uBucketCount; u++)
+      fprintf(pfOutput, "%s%lu,", u % 12 == 0 ? "\n    " : " ",
+         (unsigned long)puPilots[u]);
+   fprintf(pfOutput, "\n};\n");
+
+   fprintf(pfOutput,
+      "\n/*--------------------------------------------------------"
+      "------------*/\n\n"
+      "/* Return uValue with its bits mixed so that every input bit "
+      "affects\n   every output bit. */\n\n"
+      "static uint64_t %s_mix(uint64_t uValue)\n"
+      "{\n"
+      "    uValue ^= uValue >> 33;\n"
+      "    uValue *= 0x%llxULL;\n"
+      "    uValue ^= uValue >> 33;\n"
+      "    uValue *= 0x%llxULL;\n"
+      "    uValue ^= uValue >> 33;\n"
+      "    return uValue;\n"
+      "}\n", pcPrefix, (unsigned long long)MIX_MULTIPLIER0,
+      (unsigned long long)MIX_MULTIPLIER1);
+
+   fprintf(pfOutput,
+      "\n/*--------------------------------------------------------"
+      "------------*/\n\n"
+      "/* Return the position in asBindings at which pcKey would be "
+      "bound. */\n\n"
+      "static size_t %s_find(const char *pcKey)\n"
+      "{\n"
+      "    const unsigned char *pucKey = (const unsigned char*)pcKey;\n"
+      "    uint64_t uHash = 0x%llxULL;\n"
+      "    size_t uLength;\n"
+      "    size_t uPosition;\n"
+      "\n"
+      "    for (uLength = 0; pucKey[uLength] != '\\0'; uLength++)\n"
+      "    {\n"
+      "        uHash = (uHash ^ pucKey[uLength]) * 0x%llxULL;\n"
+      "    }\n"
+      "    uHash = %s_mix(uHash ^ (uint64_t)uLength);\n"
+      "\n"
+      "    uPosition = (size_t)(%s_mix(uHash ^ ((uint64_t)\n"
+      "        auPilots[(uHash >> 32) %% %luU] * 0x%llxULL)) %% %luU);\n"
+      "    if (asBindings[uPosition].uLength != uLength ||\n"
+      "    memcmp(acKeys + asBindings[uPosition].uOffset, pcKey,\n"
+      "        uLength) != 0) {\n"
+      "        return %luU;\n"
+      "    }\n"
+      "    return uPosition;\n"
+      "}\n", pcPrefix, (unsigned long long)uSeed,
+      (unsigned long long)FNV_PRIME, pcPrefix, pcPrefix,
+      (unsigned long)uBucketCount, (unsigned long long)PILOT_MULTIPLIER,
+      (unsigned long)(uKeyCount == 0 ? 1 : uKeyCount),
+      (unsigned long)(uKeyCount == 0 ? 1 : uKeyCount));
+
+   fprintf(pfOutput,
+      "\n/*--------------------------------------------------------"
+      "------------*/\n\n"
+      "void *%s_get(const char *pcKey)\n"
+      "{\n"
+      "    size_t uPosition;\n"
+      "\n"
+      "    assert(pcKey != NULL);\n"
+      "\n"
+      "    uPosition = %s_find(pcKey);\n"
+      "    if (uPosition == %luU) {\n"
+      "        return NULL;\n"
+      "    }\n"
+      "    return (void*)asBindings[uPosition].pvValue;\n"
+      "}\n", pcPrefix, pcPrefix,
+      (unsigned long)(uKeyCount == 0 ? 1 : uKeyCount));
+
+   fprintf(pfOutput,
+      "\n/*--------------------------------------------------------"
+      "------------*/\n\n"
+      "int %s_contains(const char *pcKey)\n"
+      "{\n"
+      "    assert(pcKey != NULL);\n"
+      "\n"
+      "    return %s_find(pcKey) != %luU;\n"
+      "}\n", pcPrefix, pcPrefix,
+      (unsigned long)(uKeyCount == 0 ? 1 : uKeyCount));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 if pcName is a C identifier, or 0 otherwise. */
+
+static int isIdentifier(const char *pcName)
+{
+   if (! isalpha((unsigned char)*pcName) && *pcName != '_')
+      return 0;
+   for (pcName++; *pcName != '\0'; pcName++)
+      if (! isalnum((unsigned char)*pcName) && *pcName != '_')
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Read a key list from the file named by the last argument, or from
+   stdin if there is none, and write to stdout a C source file that
+   defines a perfect hash table of its keys and the functions
+   <prefix>_get and <prefix>_contains that look keys up in it.
+
+   Each line of the list is a key, optionally followed by a tab and a
+   C address constant to use as its value, such as &sAdd or (void*)42.
+   A key without one gets its 1-based number in the list, cast to a
+   pointer, so that <prefix>_get never returns NULL for a key that is
+   in the list. A line that starts with a tab gives the empty key, and
+   an empty line is an error.
+
+   The options are -p <prefix>, which names the functions and defaults
+   to StaticTable, and -i <header>, which makes the generated file
+   include <header>, for the declarations of the objects that values
+   point to. Return 0, or exit with EXIT_FAILURE and an error message
+   on stderr if the arguments or the list are invalid. */
+
+int main(int argc, char *argv[])
+{
+   const char *pcProgram = argv[0];
+   const char *pcPrefix = "StaticTable";
+   const char *pcInclude = NULL;
+   const char *pcSource = "stdin";
+   FILE *pfInput = stdin;
+   char *pcText;
+   struct Key *psKeys;
+   struct Key *psSorted;
+   uint32_t *puPilots;
+   size_t *puSlots;
+   size_t *puBucketStart;
+   size_t *puOrder;
+   size_t uLength;
+   size_t uKeyCount;
+   size_t uKeyBytes = 0;
+   size_t uBucketCount;
+   size_t u;
+   uint64_t uSeed = SEED_INITIAL;
+   int iArg;
+   int iAttempt;
+
+   for (iArg = 1; iArg < argc; iArg++)
+   {
+      if (strcmp(argv[iArg], "-p") == 0 && iArg + 1 < argc)
+         pcPrefix = argv[++iArg];
+      else if (strcmp(argv[iArg], "-i") == 0 && iArg + 1 < argc)
+         pcInclude = argv[++iArg];
+      else if (argv[iArg][0] == '-' || iArg + 1 < argc)
+      {
+         fprintf(stderr,
+            "Usage: %s [-p prefix] [-i header] [keylist]\n", pcProgram);
+         exit(EXIT_FAILURE);
+      }
+      else
+      {
+         pcSource = argv[iArg];
+         pfInput = fopen(pcSource, "rb");
+         if (pfInput == NULL)
+            fail(pcProgram, "Cannot open ", pcSource);
+      }
+   }
+   if (! isIdentifier(pcPrefix))
+      fail(pcProgram, "The prefix is not a C identifier: ", pcPrefix);
+
+   pcText = readAll(pcProgram, pfInput, &uLength);
+   if (pfInput != stdin)
+      fclose(pfInput);
+
+   /* There are at most as many keys as there are '\n's, plus one. */
+   uKeyCount = 1;
+   for (u = 0; u < uLength; u++)
+      if (pcText[u] == '\n')
+         uKeyCount++;
+   psKeys = allocate(pcProgram, uKeyCount, sizeof(*psKeys));
+   uKeyCount = parseKeys(pcProgram, pcText, uLength, psKeys);
+
+   for (u = 0; u < uKeyCount; u++)
+      uKeyBytes += psKeys[u].uLength + 1;
+   if (uKeyBytes > UINT32_MAX)
+      fail(pcProgram, "The keys are too long", "");
+
+   uBucketCount = uKeyCount / KEYS_PER_BUCKET + 1;
+   psSorted = allocate(pcProgram, uKeyCount, sizeof(*psSorted));
+   puPilots = allocate(pcProgram, uBucketCount, sizeof(*puPilots));
+   puSlots = allocate(pcProgram, uKeyCount, sizeof(*puSlots));
+   puBucketStart = allocate(pcProgram, uBucketCount + 1,
+      sizeof(*puBucketStart));
+   puOrder = allocate(pcProgram, uBucketCount, sizeof(*puOrder));
+
+   for (iAttempt = 0; ; iAttempt++)
+   {
+      if (iAttempt == SEED_ATTEMPTS)
+         fail(pcProgram, "Cannot find a perfect hash of the keys", "");
+      if (placeKeys(pcProgram, psKeys, uKeyCount, uSeed, uBucketCount,
+            puPilots, puSlots, psSorted, puBucketStart, puOrder))
+         break;
+      uSeed += SEED_STEP;
+   }
+
+   writeTable(stdout, pcPrefix, pcInclude, pcSource, psKeys, uKeyCount,
+      uSeed, uBucketCount, puPilots, puSlots);
+   if (fflush(stdout) != 0 || ferror(stdout))
+      fail(pcProgram, "Cannot write the table", "");
+
+   free(puOrder);
+   free(puBucketStart);
+   free(puSlots);
+   free(puPilots);
+   free(psSorted);
+   free(psKeys);
+   free(pcText);
+   return 0;
+}
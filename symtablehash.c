@@ -3,11 +3,63 @@
 /* Author: Wangari Ashley Karani                                      */
 /*--------------------------------------------------------------------*/
 
+/* Compiled with SYMTABLE_CONCURRENT defined, this file provides a
+SymTable that any number of threads can use at once. The buckets are
+guarded by STRIPE_COUNT readers/writer locks, bucket i by stripe
+i % STRIPE_COUNT, so updates only exclude each other within a stripe.
+SymTable_get and SymTable_contains take no lock at all: they follow
+links that writers publish with release stores, retry if a rehash
+overlapped them, and removed nodes are freed only once no reader can
+still be reaching them. Instead of expanding a few buckets per call, a
+table that outgrows its buckets takes every stripe and rehashes at
+once. SymTable_new, SymTable_setHash, SymTable_freeze and SymTable_free
+must still not overlap other calls on the same table. */
+
+#define _XOPEN_SOURCE 700
+
 #include "symtable.h"
 #include <assert.h>
+#include <errno.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef SYMTABLE_CONCURRENT
+#include <sched.h>
+#endif
+
+/* Ask the processor to start loading the cache line at pvAddress, if
+the compiler offers a way to. */
+
+#ifdef __GNUC__
+#define SYMTABLE_PREFETCH(pvAddress) __builtin_prefetch(pvAddress)
+#else
+#define SYMTABLE_PREFETCH(pvAddress) ((void)(pvAddress))
+#endif
+
+/* Read, write or add to a field that other threads read without
+holding its lock. Only the concurrent build needs atomic accesses. */
+
+#ifdef SYMTABLE_CONCURRENT
+#define SYMTABLE_LOAD(field) __atomic_load_n(&(field), __ATOMIC_ACQUIRE)
+#define SYMTABLE_STORE(field, value) \
+    __atomic_store_n(&(field), (value), __ATOMIC_RELEASE)
+#define SYMTABLE_ADD(field, value) \
+    ((void)__atomic_add_fetch(&(field), (value), __ATOMIC_RELAXED))
+#else
+#define SYMTABLE_LOAD(field) (field)
+#define SYMTABLE_STORE(field, value) ((field) = (value))
+#define SYMTABLE_ADD(field, value) ((void)((field) += (value)))
+#endif
+
 /*--------------------------------------------------------------------*/
 
 /* Declaration for a global variable that stores the bucket counts */
@@ -22,21 +74,118 @@ to form a list. */
 
 struct SymTableNode
 {
-    /* The binding's key. */
-    const char *pcKey;
-    
+    /* The address of the next SymTableNode */
+    struct SymTableNode *psNextNode;
+
     /* The value associated with the binding's key. */
     const void *pvValue; 
 
-    /* The address of the next SymTableNode */
-    struct SymTableNode *psNextNode;
+    /* The binding's key: acKey, or a string of the table's pool. */
+    const char *pcKey;
+
+    /* The full hash code of pcKey. Chain walks compare it before the
+    key, and expansion uses it instead of rereading the key. */
+    size_t uHash;
+
+    /* The length of pcKey, not counting its terminating '\0'. */
+    size_t uLength;
+
+    /* The binding's own copy of its key, stored in the same allocation
+    as the node so that comparing it reads the same cache line as
+    psNextNode. Empty if the table has a pool. */
+    char acKey[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Nodes are carved out of SymTableSlabs. Each slab records the next
+one so that SymTable_free can release them all without visiting the
+nodes. A table's first slab holds about as many short-key nodes as the
+table was created for, but no fewer than SLAB_MIN_SIZE bytes, and each
+further slab doubles the last one up to SLAB_SIZE bytes, so that small
+tables stay small. */
+
+struct SymTableSlab
+{
+    /* The address of the next SymTableSlab */
+    struct SymTableSlab *psNextSlab;
+};
+
+enum {SLAB_MIN_SIZE = 1024, SLAB_SIZE = 64 * 1024};
+
+/* Node sizes are rounded up to a multiple of SLAB_ALIGN, and the nodes
+of a slab start SLAB_ALIGN bytes past its header. Nodes of at most
+SLAB_MAX_NODE_SIZE bytes come from the slabs, with one free list per
+rounded size; larger ones come straight from malloc. */
+
+enum {SLAB_ALIGN = 16, SLAB_MAX_NODE_SIZE = 256,
+    SLAB_CLASS_COUNT = SLAB_MAX_NODE_SIZE / SLAB_ALIGN};
+
+/* Keys of up to SHORT_KEY_SIZE bytes, including the terminating '\0',
+all get nodes of the same size, so they share one free list and a node
+freed by any short key can be reused by any other. */
+
+enum {SHORT_KEY_SIZE = 24};
+
+/* The fewest buckets that a table created for a small capacity gets
+under each hash function. */
+
+enum {MIN_PRIME_BUCKET_COUNT = 3, MIN_WORDS_BUCKET_COUNT = 4};
+
+#ifdef SYMTABLE_CONCURRENT
+
+/* The number of bucket locks of a table. */
+
+enum {STRIPE_COUNT = 64};
+
+/* A bucket lock, padded so that no two locks share a cache line. */
+
+union SymTableStripe
+{
+    pthread_rwlock_t oLock;
+    char acPadding[128];
+};
+
+/* What a thread that reads without locks announces: the global epoch
+in which its current read started, or 0 if it is not reading. Records
+are padded so that each thread's announcements stay in its own cache
+line. */
+
+struct SymTableReader
+{
+    size_t uEpoch;
+
+    /* Whether a live thread owns the record. */
+    int iInUse;
+
+    /* The address of the next SymTableReader */
+    struct SymTableReader *psNextReader;
+
+    char acPadding[128];
+};
+
+/* A node, bucket array or pooled key that was unlinked from a table
+in global epoch uEpoch and is waiting for its readers to finish. */
+
+struct SymTableRetired
+{
+    void *pvObject;
+    int iIsNode;
+    size_t uEpoch;
 };
 
+/* The number of entries that a table's list of retired objects starts
+with. */
+
+enum {RETIRE_BATCH = 64};
+
+#endif
+
 /*--------------------------------------------------------------------*/
 
 /* A SymTable is a "dummy" node that points to the first SymTable Node*/
 
-struct SymTable 
+struct SymTable
 {
     /* The address of the first SymTableNode */
     struct SymTableNode **psFirstNode;
@@ -46,14 +195,228 @@ struct SymTable
 
     /* number of nodes in symtable */
     size_t length;
+
+    /* The buckets that an expansion in progress is moving bindings
+    into, or NULL if the table is not expanding. */
+    struct SymTableNode **psGrowNode;
+
+    /* The number of buckets in psGrowNode. */
+    size_t uGrowBucketCount;
+
+    /* The next bucket of psFirstNode to move into psGrowNode. Every
+    bucket below uGrowIndex is already empty. */
+    size_t uGrowIndex;
+
+    /* The most recently allocated slab, which links to the others. */
+    struct SymTableSlab *psSlabs;
+
+    /* The first unused byte of psSlabs, and the number of unused bytes
+    from there to its end. */
+    char *pcSlabFree;
+    size_t uSlabLeft;
+
+    /* The size of the last slab allocated, or 0 if there is none. */
+    size_t uSlabSize;
+
+    /* For each rounded node size, the removed nodes of that size,
+    linked through psNextNode. */
+    struct SymTableNode *apsFreeNodes[SLAB_CLASS_COUNT];
+
+    /* The number of nodes too large for the slabs. */
+    size_t uLargeNodeCount;
+
+    /* The pool that holds the keys, or NULL if each node holds its own
+    key. */
+    SymTablePool_T oPool;
+
+    /* The hash function. With SYMTABLE_HASH_WORDS the bucket counts
+    are powers of two instead of the primes of uBucketCounts. */
+    enum SymTableHash eHash;
+
+    /* The number of bindings that the table was created or reserved
+    for, which SymTable_setHash keeps room for. */
+    size_t uCapacity;
+
+    /* The live iterators over the table, which a remove moves off the
+    binding it removes and marks in their snapshots. */
+    struct SymTableIter *psIters;
+
+    /* For a table that SymTable_openMapped returned, the mapping of its
+    file and the size of the mapping, or NULL and 0 otherwise. Such a
+    table is read-only: its buckets stay empty, and lookups probe the
+    slots of the mapping instead. */
+    const unsigned char *pucMapped;
+    size_t uMappedSize;
+
+    /* The slots of the mapping, their number minus 1, and the offset
+    where the records end and the slots begin. */
+    const uint64_t *puMappedSlots;
+    size_t uMappedSlotMask;
+    size_t uMappedRecordsEnd;
+
+    /* The bindings of a table that SymTable_freeze froze, or NULL.
+    Such a table is read-only as well, with empty buckets. */
+    struct SymTableFrozen *psFrozen;
+
+#ifdef SYMTABLE_CONCURRENT
+    /* The bucket locks. Holding all of them for writing allows the
+    bucket arrays themselves to be replaced. */
+    union SymTableStripe asStripes[STRIPE_COUNT];
+
+    /* The lock over the slabs and free lists. */
+    pthread_mutex_t oAllocLock;
+
+    /* A count that a rehash makes odd while it moves the bindings and
+    even again afterwards, so that lock-free readers can tell whether a
+    rehash overlapped them. */
+    size_t uSequence;
+
+    /* The objects waiting to be freed, oldest first, the number of
+    them, and the number of entries allocated, under oRetireLock. */
+    struct SymTableRetired *psRetired;
+    size_t uRetiredCount;
+    size_t uRetiredSize;
+    pthread_mutex_t oRetireLock;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+
+/* An entry of an iterator's snapshot: a binding it has yet to visit,
+its hash code, and whether that binding has been removed since. */
+
+struct SymTableIterEntry
+{
+    struct SymTableNode *psNode;
+    size_t uHash;
+    int iRemoved;
+};
+
+/* An iterator over a SymTable. The bindings are visited in order of
+their positions (see SymTable_iterPosition), and of their addresses
+among equal positions. With SYMTABLE_HASH_WORDS every bucket holds a
+range of positions that is split, never mixed with other buckets, as
+the table expands, so the iterator carries on correctly however the
+table changes between calls. The prime bucket counts of
+SYMTABLE_HASH_65599 mix the buckets instead, so before such a table
+changes its buckets, each iterator that is part way through it takes a
+snapshot of the bindings it has yet to visit, and visits those. */
+
+struct SymTableIter
+{
+    /* The table being iterated over. */
+    SymTable_T oSymTable;
+
+    /* The binding that SymTable_iterNext returned last, or NULL if
+    there is none or it has been removed. */
+    struct SymTableNode *psCurrentNode;
+
+    /* The position and address of the binding that SymTable_iterNext
+    returned last. Every binding after them is yet to be visited. The
+    address is 0 to make every binding at uPosition itself yet to be
+    visited, so both are 0 until the first binding is visited. */
+    uint64_t uPosition;
+    uintptr_t uAddress;
+
+    /* 1 (TRUE) once every binding has been visited. */
+    int iDone;
+
+    /* The snapshot in order of address, the number of its entries, and
+    the number of them visited, or NULL, 0 and 0 if there is none. */
+    struct SymTableIterEntry *psSnapshot;
+    size_t uSnapshotLength;
+    size_t uSnapshotIndex;
+
+    /* The address of the next live iterator over oSymTable */
+    struct SymTableIter *psNextIter;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A frozen table keeps its bindings in a SymTableFrozen, which is a
+minimal perfect hash function built in the manner of PTHash over the
+keys, and one entry per key. The hash code of a key under uSeed picks
+its bucket, and a pilot chosen for each bucket moves its keys to
+positions that no other key has, below uSlotCount. About one position
+in FROZEN_SLACK is left over, so the positions at or above the number
+of keys, n, are mapped to the unused ones below it, and every key ends
+up with a position of its own below n. */
+
+struct SymTableFrozen
+{
+    /* The initial state of SymTable_hashSeeded for the keys. */
+    uint64_t uSeed;
+
+    /* The number of buckets, and the number of dense ones among them,
+    which take most of the keys. */
+    size_t uBucketCount;
+    size_t uDenseCount;
+
+    /* The number of positions before those at or above n are mapped
+    below it. */
+    size_t uSlotCount;
+
+    /* The pilot of each bucket. */
+    uint16_t *puPilots;
+
+    /* For each position from n to uSlotCount-1, the unused position
+    below n that it stands for. */
+    uint32_t *puRemap;
+
+    /* For each position below n, the offset of its entry in pcEntries,
+    in units of 8 bytes. */
+    uint32_t *puOffsets;
+
+    /* The entries, SymTableFrozenEntry objects in the order of their
+    positions, each padded to a multiple of 8 bytes. */
+    char *pcEntries;
+};
+
+/* The binding that a position of a frozen table stands for, with its
+key, its key's length and its value side by side, so that a lookup
+reads one entry. */
+
+struct SymTableFrozenEntry
+{
+    /* The value of the binding. */
+    const void *pvValue;
+
+    /* The length of acKey, not counting its terminating '\0'. */
+    uint32_t uLength;
+
+    /* The key of the binding. */
+    char acKey[];
 };
 
+/* The buckets of a frozen table get FROZEN_KEYS_PER_BUCKET keys each
+on average, and pilots of at most FROZEN_MAX_PILOT, so the pilots take
+16 / FROZEN_KEYS_PER_BUCKET bits per key. There are n / FROZEN_SLACK + 1
+more positions than keys. A seed that leaves some bucket without a
+pilot is given up for another, up to FROZEN_ATTEMPTS seeds. */
+
+enum {FROZEN_KEYS_PER_BUCKET = 5, FROZEN_MAX_PILOT = 65535,
+    FROZEN_SLACK = 100, FROZEN_ATTEMPTS = 8};
+
+/* As in PTHash, the keys whose hash codes have their low 32 bits below
+FROZEN_DENSE_LIMIT, 60% of all keys, go to the first
+FROZEN_DENSE_PERCENT percent of the buckets, so that the crowded
+buckets are placed while most positions are still free. */
+
+#define FROZEN_DENSE_LIMIT ((uint64_t)2576980378U)
+
+enum {FROZEN_DENSE_PERCENT = 30};
+
+/* The odd constant that spreads the pilots over 64 bits. */
+
+static const uint64_t FROZEN_PILOT_MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+
 /*--------------------------------------------------------------------*/
 
-/* Return a hash code for pcKey that is between 0 and uBucketCount-1,
-   inclusive. */
+/* Return a hash code for pcKey using the 65599 hash, and store the
+length of pcKey in *puLength. Reduce the hash code modulo a bucket count
+to get a bucket between 0 and the bucket count-1, inclusive. */
 
-static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
+static size_t SymTable_hash65599(const char *pcKey, size_t *puLength)
 {
    const size_t HASH_MULTIPLIER = 65599;
    size_t u;
@@ -66,265 +429,5134 @@ static size_t SymTable_hash(const char *pcKey, size_t uBucketCount)
         uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
    }
 
-   return uHash % uBucketCount;
+   *puLength = u;
+   return uHash;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Return a new SymTable object with no bindings, or NULL if 
-insufficient memory is available. */
+/* The odd 64-bit constants that SymTable_hashWords mixes in. */
 
-SymTable_T SymTable_new(void)
-{
-    SymTable_T oSymTable;
+static const uint64_t WORDS_SECRET0 = 0xa0761d6478bd642fULL;
+static const uint64_t WORDS_SECRET1 = 0xe7037ed1a0b428dbULL;
 
-    oSymTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+/*--------------------------------------------------------------------*/
 
-    if (oSymTable == NULL)
-    {
-        return NULL;
-    }
+/* Return the 128-bit product of uA and uB with its two halves folded
+together by exclusive or. */
+
+static uint64_t SymTable_mulFold(uint64_t uA, uint64_t uB)
+{
+#ifdef __SIZEOF_INT128__
+    __uint128_t uProduct = (__uint128_t)uA * uB;
 
-    oSymTable->psFirstNode = calloc(uBucketCounts[0], sizeof(struct SymTableNode*));
-    oSymTable->uBucketCount = uBucketCounts[0];
+    return (uint64_t)uProduct ^ (uint64_t)(uProduct >> 64);
+#else
+    uint64_t uALow = uA & 0xffffffffU;
+    uint64_t uAHigh = uA >> 32;
+    uint64_t uBLow = uB & 0xffffffffU;
+    uint64_t uBHigh = uB >> 32;
+    uint64_t uLowLow = uALow * uBLow;
+    uint64_t uLowHigh = uALow * uBHigh;
+    uint64_t uHighLow = uAHigh * uBLow;
+    uint64_t uHighHigh = uAHigh * uBHigh;
+    uint64_t uMiddle = (uLowLow >> 32) + (uLowHigh & 0xffffffffU) +
+        (uHighLow & 0xffffffffU);
 
-    return oSymTable;
+    return ((uLowLow & 0xffffffffU) | (uMiddle << 32)) ^
+        (uHighHigh + (uLowHigh >> 32) + (uHighLow >> 32) +
+        (uMiddle >> 32));
+#endif
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Free all memory occupied by oSymTable */
+/* Return the 8 or 4 bytes at pucBytes as an unsigned integer in the
+machine's byte order. pucBytes need not be aligned. */
 
-void SymTable_free(SymTable_T oSymTable)
+static uint64_t SymTable_read64(const unsigned char *pucBytes)
 {
-    struct SymTableNode *psCurrentNode;
-    struct SymTableNode *psNextNode;
-    size_t i;
-    assert(oSymTable != NULL);
+    uint64_t u;
 
-    for (i = 0; i < oSymTable->uBucketCount; i++) 
-    {
-        for (psCurrentNode = oSymTable->psFirstNode[i]; psCurrentNode != NULL; 
-        psCurrentNode = psNextNode) 
-        {
-            psNextNode = psCurrentNode->psNextNode;
-            free((char *) psCurrentNode->pcKey);
-            free(psCurrentNode);
-        }
-    }
+    memcpy(&u, pucBytes, sizeof(u));
+    return u;
+}
 
-    free (oSymTable);
+static uint64_t SymTable_read32(const unsigned char *pucBytes)
+{
+    uint32_t u;
+
+    memcpy(&u, pucBytes, sizeof(u));
+    return u;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Return the number of bindings in oSymTable */
+/* Return a hash code for the uLength bytes at pcKey, computed in the
+manner of wyhash from the initial state uSeed: 16 bytes per round are
+folded into the state with one 64x64->128-bit multiply, and keys of up
+to 16 bytes take a single multiply from a few overlapping loads. Every
+bit of the result depends on every byte, so it can be reduced by
+masking. */
 
-size_t SymTable_getLength(SymTable_T oSymTable)
+static uint64_t SymTable_hashSeeded(const char *pcKey, size_t uLength,
+    uint64_t uSeed)
 {
-    assert(oSymTable != NULL);
+    const unsigned char *pucKey = (const unsigned char *)pcKey;
+    uint64_t uA;
+    uint64_t uB;
+    size_t uLeft = uLength;
+    size_t uQuarter;
+
+    if (uLength <= 16) {
+        if (uLength >= 4) {
+            uQuarter = (uLength >> 3) << 2;
+            uA = (SymTable_read32(pucKey) << 32) |
+                SymTable_read32(pucKey + uQuarter);
+            uB = (SymTable_read32(pucKey + uLength - 4) << 32) |
+                SymTable_read32(pucKey + uLength - 4 - uQuarter);
+        }
+        else if (uLength > 0) {
+            uA = ((uint64_t)pucKey[0] << 16) |
+                ((uint64_t)pucKey[uLength >> 1] << 8) | pucKey[uLength - 1];
+            uB = 0;
+        }
+        else {
+            uA = 0;
+            uB = 0;
+        }
+    }
+    else {
+        while (uLeft > 16) {
+            uSeed = SymTable_mulFold(SymTable_read64(pucKey) ^ WORDS_SECRET1,
+                SymTable_read64(pucKey + 8) ^ uSeed);
+            pucKey += 16;
+            uLeft -= 16;
+        }
+        uA = SymTable_read64(pucKey + uLeft - 16);
+        uB = SymTable_read64(pucKey + uLeft - 8);
+    }
 
-    return oSymTable->length;
+    return SymTable_mulFold(WORDS_SECRET1 ^ uLength,
+        SymTable_mulFold(uA ^ WORDS_SECRET1, uB ^ uSeed));
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Add a new binding to oSymTable consisting of key pcKey and value 
-pvValue and return 1 (TRUE) if oSymTable does not already contain a 
-binding with key pcKey. Otherwise, if either oSymTable contains such a 
-binding or insufficient memory is available, leave oSymTable unchanged 
-and return 0 (FALSE). */
+/* Return the SYMTABLE_HASH_WORDS hash code of the uLength bytes at
+pcKey: SymTable_hashSeeded from the fixed state WORDS_SECRET0. */
 
-int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void 
-*pvValue) 
+static size_t SymTable_hashWords(const char *pcKey, size_t uLength)
 {
-    struct SymTableNode *psNewNode;
-    size_t hashcode;
+    return (size_t)SymTable_hashSeeded(pcKey, uLength, WORDS_SECRET0);
+}
 
-    assert (oSymTable != NULL);
-    assert (pcKey != NULL);
+/*--------------------------------------------------------------------*/
 
-    hashcode = SymTable_hash(pcKey, oSymTable->uBucketCount);
+/* Return the hash code of the uLength bytes at pcKey under the hash
+function eHash. */
 
-    if (SymTable_contains(oSymTable, pcKey)) {
-        return 0;
-    }
+size_t SymTable_hashKey(enum SymTableHash eHash, const char *pcKey,
+    size_t uLength)
+{
+    const size_t HASH_MULTIPLIER = 65599;
+    size_t u;
+    size_t uHash = 0;
 
-    /* defensive copy */
-    psNewNode = (struct SymTableNode*)malloc(sizeof(struct SymTableNode));
+    assert(pcKey != NULL);
 
-    if (psNewNode == NULL) 
-    {
-        return 0;
+    if (eHash == SYMTABLE_HASH_WORDS) {
+        return SymTable_hashWords(pcKey, uLength);
     }
 
-    psNewNode->pcKey = (char*)malloc(strlen(pcKey) + 1);
-
-    if (psNewNode->pcKey == NULL) 
+    for (u = 0; u < uLength; u++)
     {
-        free (psNewNode);
-        return 0;
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
     }
 
-    strcpy((char *)psNewNode->pcKey, pcKey);
-    psNewNode->pvValue = pvValue;
-    psNewNode->psNextNode = oSymTable->psFirstNode[hashcode];
-    oSymTable->psFirstNode[hashcode] = psNewNode;
-    oSymTable->length++;
-    return 1;
+    return uHash;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* If oSymTable contains a binding with key pcKey, replace the binding's
-value with pvValue and return the old value. Otherwise leave oSymTable 
-unchanged and return NULL. */
+/* Return the hash code of pcKey under oSymTable's hash function, or
+under the seed of its keys if it is frozen, and store the length of
+pcKey in *puLength. */
 
-void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const 
-void *pvValue) 
+static size_t SymTable_hash(SymTable_T oSymTable, const char *pcKey,
+    size_t *puLength)
 {
-    struct SymTableNode *psCurrentNode;
-    struct SymTableNode *psNextNode;
-    size_t hashcode;
-
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
-
-    hashcode = SymTable_hash(pcKey, oSymTable->uBucketCount);
+    if (oSymTable->psFrozen != NULL) {
+        *puLength = strlen(pcKey);
+        return (size_t)SymTable_hashSeeded(pcKey, *puLength,
+            oSymTable->psFrozen->uSeed);
+    }
 
-    for (psCurrentNode = oSymTable->psFirstNode[hashcode]; psCurrentNode != NULL; 
-    psCurrentNode = psNextNode) 
-    {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
-            void *oldval = (void *) psCurrentNode->pvValue;
-            psCurrentNode->pvValue = pvValue;
-            return oldval;
-        }
-        psNextNode = psCurrentNode->psNextNode;
+    if (oSymTable->eHash == SYMTABLE_HASH_WORDS) {
+        *puLength = strlen(pcKey);
+        return SymTable_hashWords(pcKey, *puLength);
     }
 
-    return NULL;
+    return SymTable_hash65599(pcKey, puLength);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey, 
-or 0 (FALSE) if otherwise. */
+/* Return the hash code of *psKey under oSymTable's hash function: the
+one *psKey carries if it was made for that function, and otherwise one
+computed now, as it always is for a frozen table. */
 
-int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+static size_t SymTable_keyHash(SymTable_T oSymTable,
+    const SymTable_Key *psKey)
 {
-    struct SymTableNode *psCurrentNode;
-    struct SymTableNode *psNextNode;
-    size_t hashcode;
-
-    assert(oSymTable != NULL);
-    assert (pcKey != NULL);
+    assert(psKey != NULL);
+    assert(psKey->pcKey != NULL);
 
-    hashcode = SymTable_hash(pcKey, oSymTable->uBucketCount);
+    if (oSymTable->psFrozen != NULL) {
+        return (size_t)SymTable_hashSeeded(psKey->pcKey, psKey->uLength,
+            oSymTable->psFrozen->uSeed);
+    }
 
-    for (psCurrentNode = oSymTable->psFirstNode[hashcode]; psCurrentNode != NULL; 
-    psCurrentNode = psNextNode) 
-    {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
-            return 1;
-        }
-        psNextNode = psCurrentNode->psNextNode;
+    if (psKey->eHash == oSymTable->eHash) {
+        return psKey->uHash;
     }
 
-    return 0;
+    return SymTable_hashKey(oSymTable->eHash, psKey->pcKey, psKey->uLength);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Return the value of the binding within oSymTable whose key is pcKey, 
-or NULL if no such binding exists. */
+/* Return 1 (TRUE) if oSymTable is read-only, because it was opened with
+SymTable_openMapped or frozen with SymTable_freeze, or 0 (FALSE) if
+otherwise. */
 
-void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+static int SymTable_isReadOnly(SymTable_T oSymTable)
 {
-    struct SymTableNode *psCurrentNode;
-    struct SymTableNode *psNextNode;
-    size_t hashcode;
+    return oSymTable->pucMapped != NULL || oSymTable->psFrozen != NULL;
+}
 
-    assert(oSymTable != NULL);
-    assert (pcKey != NULL);
+/*--------------------------------------------------------------------*/
 
-    hashcode = SymTable_hash(pcKey, oSymTable->uBucketCount);
+/* Return the bucket, between 0 and uBucketCount-1, inclusive, of a key
+whose hash code under oSymTable's hash function is uHash. */
 
-    for (psCurrentNode = oSymTable->psFirstNode[hashcode]; psCurrentNode != NULL; 
-    psCurrentNode = psNextNode) 
-    {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
-            return (void *) psCurrentNode->pvValue;
-        }
-        psNextNode = psCurrentNode->psNextNode;
+static size_t SymTable_reduce(SymTable_T oSymTable, size_t uHash,
+    size_t uBucketCount)
+{
+    if (oSymTable->eHash == SYMTABLE_HASH_WORDS) {
+        return uHash & (uBucketCount - 1);
     }
 
-    return NULL;
+    return uHash % uBucketCount;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* If oSymTable contains a binding with key pcKey, remove that binding 
-from oSymTable and return the binding's value. Otherwise leave oSymTable
-unchanged and return NULL. */
+/* Return the smallest odd prime that is at least uMinimum, which must
+be at least 3 and well below the largest size_t. */
 
-void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+static size_t SymTable_primeAtLeast(size_t uMinimum)
 {
-    /* keep track of a prev pter, initially null*/
-    /* two cases, rming 1st node vs any other node */
-    /* we don't just free node, also key */
-    struct SymTableNode *psCurrentNode;
-    struct SymTableNode *psPrevNode = NULL;
-    size_t hashcode;
-
-    assert(oSymTable != NULL);
-    assert(pcKey != NULL);
+    size_t uCandidate;
+    size_t uDivisor;
 
-    hashcode = SymTable_hash(pcKey, oSymTable->uBucketCount);
+    assert(uMinimum >= 3);
 
-    for (psCurrentNode = oSymTable->psFirstNode[hashcode]; psCurrentNode != NULL; 
-    psCurrentNode = psCurrentNode->psNextNode) 
+    for (uCandidate = uMinimum | 1; ; uCandidate += 2)
     {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
-            void *oldval = (void *) psCurrentNode->pvValue;
-            /* relink to remove current node */
-            if (psPrevNode == NULL) {
-                oSymTable->psFirstNode[hashcode] = psCurrentNode->psNextNode;
-            }
-            else {
-                psPrevNode->psNextNode = psCurrentNode->psNextNode;
+        for (uDivisor = 3; uDivisor * uDivisor <= uCandidate; uDivisor += 2)
+        {
+            if (uCandidate % uDivisor == 0) {
+                break;
             }
-            free ((char *) psCurrentNode->pcKey);
-            free (psCurrentNode);
-            oSymTable->length--;
-            return oldval;
         }
-        psPrevNode = psCurrentNode;
+        if (uDivisor * uDivisor > uCandidate) {
+            return uCandidate;
+        }
     }
-    
-    return NULL;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Apply function *pfApply to each element of oSymTable, passing pvExtra
-as an extra argument. That is, for each element pcKey and its value 
-pvValue of oSymTable, call (*pfApply) (pcKey, pvValue, pvExtra).  */
+/* Return the bucket count that follows uBucketCount: below
+uBucketCounts[0], the smallest prime above twice uBucketCount, up to
+uBucketCounts[0] itself; then the next entry of uBucketCounts; and, past
+its end, the smallest prime above twice uBucketCount again. Return 0 if
+no larger bucket count is representable. */
 
-void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char 
-*pcKey, void *pvValue, void *pvExtra), const void *pvExtra)
+static size_t SymTable_nextBucketCount(size_t uBucketCount)
 {
-    struct SymTableNode *psCurrentNode;
     size_t i;
-    assert(oSymTable != NULL);
-    assert(pfApply != NULL);    
 
-    for (i = 0; i < oSymTable->uBucketCount; i++) 
+    if (uBucketCount < uBucketCounts[0]) {
+        if (2 * uBucketCount + 1 >= uBucketCounts[0]) {
+            return uBucketCounts[0];
+        }
+        return SymTable_primeAtLeast(2 * uBucketCount + 1);
+    }
+
+    for (i = 0; i < sizeof(uBucketCounts) / sizeof(uBucketCounts[0]); i++)
     {
-        for (psCurrentNode = oSymTable->psFirstNode[i]; psCurrentNode != NULL; 
-        psCurrentNode = psCurrentNode->psNextNode) 
-        {
-            (*pfApply) ((char *) psCurrentNode->pcKey, (void*) psCurrentNode->pvValue, (void*) pvExtra);
+        if (uBucketCounts[i] > uBucketCount) {
+            return uBucketCounts[i];
         }
-    }   
+    }
+
+    if (uBucketCount > ((size_t)-1 - 1) / 4) {
+        return 0;
+    }
+
+    return SymTable_primeAtLeast(2 * uBucketCount + 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Each string of a SymTablePool is stored once, in a
+SymTablePoolEntry, together with the number of references to it. */
+
+struct SymTablePoolEntry
+{
+    /* The address of the next SymTablePoolEntry in the bucket */
+    struct SymTablePoolEntry *psNextEntry;
+
+    /* The number of bindings and callers holding the string. */
+    size_t uRefCount;
+
+    /* The full hash code of the string. */
+    size_t uHash;
+
+    /* The length of the string. */
+    size_t uLength;
+
+    /* The string. */
+    char acString[];
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTablePool is a hash table of reference-counted strings that
+SymTable objects created by SymTable_newWithPool use as their keys. */
+
+struct SymTablePool
+{
+    /* The address of the first SymTablePoolEntry of each bucket */
+    struct SymTablePoolEntry **psFirstEntry;
+
+    /* The bucket number . */
+    size_t uBucketCount;
+
+    /* number of distinct strings in the pool */
+    size_t length;
+
+#ifdef SYMTABLE_CONCURRENT
+    /* The lock over the whole pool, which tables in different threads
+    may share. */
+    pthread_mutex_t oLock;
+#endif
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the SymTablePoolEntry whose string is pcString, which must
+have been returned by SymTablePool_intern. */
+
+static struct SymTablePoolEntry *SymTablePool_entry(const char *pcString)
+{
+    return (struct SymTablePoolEntry *)(void *)
+        (pcString - offsetof(struct SymTablePoolEntry, acString));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Lock oPool, in the concurrent build. */
+
+static void SymTablePool_lock(SymTablePool_T oPool)
+{
+#ifdef SYMTABLE_CONCURRENT
+    pthread_mutex_lock(&oPool->oLock);
+#else
+    (void)oPool;
+#endif
+}
+
+/* Unlock oPool, in the concurrent build. */
+
+static void SymTablePool_unlock(SymTablePool_T oPool)
+{
+#ifdef SYMTABLE_CONCURRENT
+    pthread_mutex_unlock(&oPool->oLock);
+#else
+    (void)oPool;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every entry of oPool into the next bucket count, or leave oPool
+unchanged if insufficient memory is available. */
+
+static void SymTablePool_grow(SymTablePool_T oPool)
+{
+    struct SymTablePoolEntry **psFirstEntry;
+    struct SymTablePoolEntry *psCurrentEntry;
+    struct SymTablePoolEntry *psNextEntry;
+    size_t uBucketCount;
+    size_t hashcode;
+    size_t i;
+
+    uBucketCount = SymTable_nextBucketCount(oPool->uBucketCount);
+    if (uBucketCount == 0) {
+        return;
+    }
+
+    psFirstEntry = calloc(uBucketCount, sizeof(struct SymTablePoolEntry*));
+    if (psFirstEntry == NULL) {
+        return;
+    }
+
+    for (i = 0; i < oPool->uBucketCount; i++)
+    {
+        for (psCurrentEntry = oPool->psFirstEntry[i]; psCurrentEntry != NULL;
+        psCurrentEntry = psNextEntry)
+        {
+            psNextEntry = psCurrentEntry->psNextEntry;
+            hashcode = psCurrentEntry->uHash % uBucketCount;
+            psCurrentEntry->psNextEntry = psFirstEntry[hashcode];
+            psFirstEntry[hashcode] = psCurrentEntry;
+        }
+    }
+
+    free(oPool->psFirstEntry);
+    oPool->psFirstEntry = psFirstEntry;
+    oPool->uBucketCount = uBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTablePool object with no strings, or NULL if
+insufficient memory is available. */
+
+SymTablePool_T SymTablePool_new(void)
+{
+    SymTablePool_T oPool;
+
+    oPool = (SymTablePool_T)calloc(1, sizeof(struct SymTablePool));
+
+    if (oPool == NULL)
+    {
+        return NULL;
+    }
+
+    oPool->psFirstEntry = calloc(uBucketCounts[0],
+        sizeof(struct SymTablePoolEntry*));
+
+    if (oPool->psFirstEntry == NULL)
+    {
+        free(oPool);
+        return NULL;
+    }
+
+#ifdef SYMTABLE_CONCURRENT
+    if (pthread_mutex_init(&oPool->oLock, NULL) != 0)
+    {
+        free(oPool->psFirstEntry);
+        free(oPool);
+        return NULL;
+    }
+#endif
+
+    oPool->uBucketCount = uBucketCounts[0];
+
+    return oPool;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oPool, including the strings that
+callers interned and never released. Every SymTable object using oPool
+must already have been freed. */
+
+void SymTablePool_free(SymTablePool_T oPool)
+{
+    struct SymTablePoolEntry *psCurrentEntry;
+    struct SymTablePoolEntry *psNextEntry;
+    size_t i;
+
+    assert(oPool != NULL);
+
+    for (i = 0; i < oPool->uBucketCount; i++)
+    {
+        for (psCurrentEntry = oPool->psFirstEntry[i];
+        psCurrentEntry != NULL; psCurrentEntry = psNextEntry)
+        {
+            psNextEntry = psCurrentEntry->psNextEntry;
+            free(psCurrentEntry);
+        }
+    }
+
+#ifdef SYMTABLE_CONCURRENT
+    pthread_mutex_destroy(&oPool->oLock);
+#endif
+    free(oPool->psFirstEntry);
+    free(oPool);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of distinct strings in oPool */
+
+size_t SymTablePool_getLength(SymTablePool_T oPool)
+{
+    size_t uLength;
+
+    assert(oPool != NULL);
+
+    SymTablePool_lock(oPool);
+    uLength = oPool->length;
+    SymTablePool_unlock(oPool);
+    return uLength;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return oPool's copy of the uLength characters at pcString, adding
+it to oPool as a '\0'-terminated string if it is not there yet, and take
+a reference to it. Return NULL if insufficient memory is available.
+The caller must hold oPool's lock. */
+
+static const char *SymTablePool_addLength(SymTablePool_T oPool,
+    const char *pcString, size_t uLength)
+{
+    struct SymTablePoolEntry *psCurrentEntry;
+    size_t uHash;
+    size_t hashcode;
+
+    uHash = SymTable_hashKey(SYMTABLE_HASH_65599, pcString, uLength);
+    hashcode = uHash % oPool->uBucketCount;
+
+    for (psCurrentEntry = oPool->psFirstEntry[hashcode];
+    psCurrentEntry != NULL; psCurrentEntry = psCurrentEntry->psNextEntry)
+    {
+        if (psCurrentEntry->uHash == uHash &&
+        psCurrentEntry->uLength == uLength &&
+        (psCurrentEntry->acString == pcString ||
+        memcmp(psCurrentEntry->acString, pcString, uLength) == 0)) {
+            psCurrentEntry->uRefCount++;
+            return psCurrentEntry->acString;
+        }
+    }
+
+    psCurrentEntry = (struct SymTablePoolEntry*)malloc(
+        sizeof(struct SymTablePoolEntry) + uLength + 1);
+
+    if (psCurrentEntry == NULL)
+    {
+        return NULL;
+    }
+
+    memcpy(psCurrentEntry->acString, pcString, uLength);
+    psCurrentEntry->acString[uLength] = '\0';
+    psCurrentEntry->uRefCount = 1;
+    psCurrentEntry->uHash = uHash;
+    psCurrentEntry->uLength = uLength;
+    psCurrentEntry->psNextEntry = oPool->psFirstEntry[hashcode];
+    oPool->psFirstEntry[hashcode] = psCurrentEntry;
+    oPool->length++;
+
+    if (oPool->length > oPool->uBucketCount) {
+        SymTablePool_grow(oPool);
+    }
+
+    return psCurrentEntry->acString;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return oPool's copy of the uLength characters at pcString, adding
+it to oPool as a '\0'-terminated string if it is not there yet, and take
+a reference to it. Return NULL if insufficient memory is available. */
+
+static const char *SymTablePool_internLength(SymTablePool_T oPool,
+    const char *pcString, size_t uLength)
+{
+    const char *pcInterned;
+
+    SymTablePool_lock(oPool);
+    pcInterned = SymTablePool_addLength(oPool, pcString, uLength);
+    SymTablePool_unlock(oPool);
+    return pcInterned;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return oPool's copy of pcString, adding it to oPool if it is not
+there yet, and take a reference to it. Return NULL if insufficient
+memory is available. */
+
+const char *SymTablePool_intern(SymTablePool_T oPool,
+    const char *pcString)
+{
+    assert(oPool != NULL);
+    assert(pcString != NULL);
+
+    return SymTablePool_internLength(oPool, pcString, strlen(pcString));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Drop one reference to pcString, which must have been returned by
+SymTablePool_intern for oPool, and unlink it from oPool once no
+references remain. Return its entry, for the caller to free, if it was
+unlinked, or NULL otherwise. */
+
+static struct SymTablePoolEntry *SymTablePool_drop(SymTablePool_T oPool,
+    const char *pcString)
+{
+    struct SymTablePoolEntry *psEntry;
+    struct SymTablePoolEntry **ppsLink;
+    size_t hashcode;
+
+    assert(oPool != NULL);
+    assert(pcString != NULL);
+
+    psEntry = SymTablePool_entry(pcString);
+
+    SymTablePool_lock(oPool);
+    assert(psEntry->uRefCount > 0);
+
+    if (--psEntry->uRefCount == 0) {
+        hashcode = psEntry->uHash % oPool->uBucketCount;
+
+        for (ppsLink = &oPool->psFirstEntry[hashcode]; *ppsLink != psEntry;
+        ppsLink = &(*ppsLink)->psNextEntry)
+        {
+            assert(*ppsLink != NULL);
+        }
+
+        *ppsLink = psEntry->psNextEntry;
+        oPool->length--;
+    }
+    else {
+        psEntry = NULL;
+    }
+    SymTablePool_unlock(oPool);
+    return psEntry;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Drop one reference to pcString, which must have been returned by
+SymTablePool_intern for oPool, and remove it from oPool once no
+references remain. */
+
+void SymTablePool_release(SymTablePool_T oPool, const char *pcString)
+{
+    free(SymTablePool_drop(oPool, pcString));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bytes taken up by a node of oSymTable whose key
+has uLength characters. */
+
+static size_t SymTable_nodeSize(SymTable_T oSymTable, size_t uLength)
+{
+    size_t uKeySize = uLength + 1;
+    size_t uNodeSize;
+
+    if (oSymTable->oPool != NULL) {
+        uKeySize = 0;
+    }
+    else if (uKeySize < SHORT_KEY_SIZE) {
+        uKeySize = SHORT_KEY_SIZE;
+    }
+
+    uNodeSize = sizeof(struct SymTableNode) + uKeySize;
+    return (uNodeSize + SLAB_ALIGN - 1) / SLAB_ALIGN * SLAB_ALIGN;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the next uNodeSize bytes of oSymTable's current slab, which
+must have that many left, as a node. */
+
+static struct SymTableNode *SymTable_carveNode(SymTable_T oSymTable,
+    size_t uNodeSize)
+{
+    struct SymTableNode *psNewNode;
+
+    assert(oSymTable->uSlabLeft >= uNodeSize);
+
+    psNewNode = (struct SymTableNode*)(void *)oSymTable->pcSlabFree;
+    oSymTable->pcSlabFree += uNodeSize;
+    oSymTable->uSlabLeft -= uNodeSize;
+    return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make the uLength characters at pcKey the key of psNode, a node of
+oSymTable, copying them into the node or interning them in oSymTable's
+pool, and '\0'-terminating them either way. Return 1 (TRUE), or 0
+(FALSE) if insufficient memory is available. */
+
+static int SymTable_setKey(SymTable_T oSymTable,
+    struct SymTableNode *psNode, const char *pcKey, size_t uLength)
+{
+    psNode->uLength = uLength;
+
+    if (oSymTable->oPool == NULL) {
+        memcpy(psNode->acKey, pcKey, uLength);
+        psNode->acKey[uLength] = '\0';
+        psNode->pcKey = psNode->acKey;
+        return 1;
+    }
+
+    psNode->pcKey = SymTablePool_internLength(oSymTable->oPool, pcKey,
+        uLength);
+    return psNode->pcKey != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Lock the slabs and free lists of oSymTable, in the concurrent
+build. */
+
+static void SymTable_lockAlloc(SymTable_T oSymTable)
+{
+#ifdef SYMTABLE_CONCURRENT
+    pthread_mutex_lock(&oSymTable->oAllocLock);
+#else
+    (void)oSymTable;
+#endif
+}
+
+/* Unlock the slabs and free lists of oSymTable, in the concurrent
+build. */
+
+static void SymTable_unlockAlloc(SymTable_T oSymTable)
+{
+#ifdef SYMTABLE_CONCURRENT
+    pthread_mutex_unlock(&oSymTable->oAllocLock);
+#else
+    (void)oSymTable;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size of the next slab of oSymTable. */
+
+static size_t SymTable_nextSlabSize(SymTable_T oSymTable)
+{
+    size_t uShortNodeSize;
+
+    if (oSymTable->uSlabSize != 0) {
+        if (oSymTable->uSlabSize >= SLAB_SIZE / 2) {
+            return SLAB_SIZE;
+        }
+        return 2 * oSymTable->uSlabSize;
+    }
+
+    uShortNodeSize = SymTable_nodeSize(oSymTable, 0);
+    if (oSymTable->uCapacity >= (SLAB_SIZE - SLAB_ALIGN) / uShortNodeSize) {
+        return SLAB_SIZE;
+    }
+    if (SLAB_ALIGN + oSymTable->uCapacity * uShortNodeSize < SLAB_MIN_SIZE) {
+        return SLAB_MIN_SIZE;
+    }
+    return SLAB_ALIGN + oSymTable->uCapacity * uShortNodeSize;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return uNodeSize bytes of oSymTable for a node, or NULL if
+insufficient memory is available. The node is reused from a free list
+if possible, and otherwise carved from the current slab. The caller
+must hold oSymTable's allocation lock. */
+
+static struct SymTableNode *SymTable_allocNode(SymTable_T oSymTable,
+    size_t uNodeSize)
+{
+    struct SymTableNode *psNewNode;
+    struct SymTableSlab *psNewSlab;
+    size_t uClass = uNodeSize / SLAB_ALIGN - 1;
+    size_t uSlabSize;
+
+    if (uNodeSize > SLAB_MAX_NODE_SIZE) {
+        psNewNode = (struct SymTableNode*)malloc(uNodeSize);
+        if (psNewNode == NULL)
+        {
+            return NULL;
+        }
+        oSymTable->uLargeNodeCount++;
+    }
+    else if (oSymTable->apsFreeNodes[uClass] != NULL) {
+        psNewNode = oSymTable->apsFreeNodes[uClass];
+        oSymTable->apsFreeNodes[uClass] = psNewNode->psNextNode;
+    }
+    else {
+        if (oSymTable->uSlabLeft < uNodeSize) {
+            uSlabSize = SymTable_nextSlabSize(oSymTable);
+            psNewSlab = (struct SymTableSlab*)malloc(uSlabSize);
+            if (psNewSlab == NULL)
+            {
+                return NULL;
+            }
+            psNewSlab->psNextSlab = oSymTable->psSlabs;
+            oSymTable->psSlabs = psNewSlab;
+            oSymTable->pcSlabFree = (char *)psNewSlab + SLAB_ALIGN;
+            oSymTable->uSlabLeft = uSlabSize - SLAB_ALIGN;
+            oSymTable->uSlabSize = uSlabSize;
+        }
+        psNewNode = SymTable_carveNode(oSymTable, uNodeSize);
+    }
+
+    return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTableNode of oSymTable whose key is the uLength
+characters at pcKey, copied into the node or interned in oSymTable's
+pool and '\0'-terminated either way, with its value, hash code and link
+unset, or NULL if insufficient memory is available. */
+
+static struct SymTableNode *SymTable_newNode(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength)
+{
+    struct SymTableNode *psNewNode;
+    size_t uNodeSize = SymTable_nodeSize(oSymTable, uLength);
+    size_t uClass = uNodeSize / SLAB_ALIGN - 1;
+
+    SymTable_lockAlloc(oSymTable);
+    psNewNode = SymTable_allocNode(oSymTable, uNodeSize);
+    SymTable_unlockAlloc(oSymTable);
+
+    if (psNewNode == NULL) {
+        return NULL;
+    }
+
+    if (! SymTable_setKey(oSymTable, psNewNode, pcKey, uLength)) {
+        SymTable_lockAlloc(oSymTable);
+        psNewNode->psNextNode = oSymTable->apsFreeNodes[uClass];
+        oSymTable->apsFreeNodes[uClass] = psNewNode;
+        SymTable_unlockAlloc(oSymTable);
+        return NULL;
+    }
+    return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give psNode, a node of oSymTable whose pooled key, if any, has
+already been released, back to oSymTable. Slab nodes go on the free
+list for their size. */
+
+static void SymTable_freeNode(SymTable_T oSymTable,
+    struct SymTableNode *psNode)
+{
+    size_t uNodeSize = SymTable_nodeSize(oSymTable, psNode->uLength);
+    size_t uClass = uNodeSize / SLAB_ALIGN - 1;
+
+    SymTable_lockAlloc(oSymTable);
+    if (uNodeSize > SLAB_MAX_NODE_SIZE) {
+        free(psNode);
+        oSymTable->uLargeNodeCount--;
+    }
+    else {
+        psNode->psNextNode = oSymTable->apsFreeNodes[uClass];
+        oSymTable->apsFreeNodes[uClass] = psNode;
+    }
+    SymTable_unlockAlloc(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_CONCURRENT
+
+/* Readers of the concurrent build hold no lock, so a node that a
+remove unlinks, or a bucket array that a rehash replaces, may still be
+in use by a reader that reached it earlier. Such objects are retired
+instead of freed: each records the global epoch of its retirement, and
+it is freed once the epoch has advanced twice. The epoch advances only
+when every thread that is reading has announced the current epoch, so
+by then every reader that could have reached the object has finished. */
+
+static size_t uGlobalEpoch = 1;
+
+/* The reader records of all threads that ever read, and the lock over
+the list and over advancing uGlobalEpoch. */
+
+static struct SymTableReader *psReaders;
+static pthread_mutex_t oReadersLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* The key under which each thread keeps its reader record. */
+
+static pthread_key_t oReaderKey;
+static pthread_once_t oReaderOnce = PTHREAD_ONCE_INIT;
+
+/*--------------------------------------------------------------------*/
+
+/* Give up the reader record psReader of a thread that is exiting, so
+that another thread can take it over. */
+
+static void SymTable_dropReader(void *psReader)
+{
+    pthread_mutex_lock(&oReadersLock);
+    ((struct SymTableReader *)psReader)->iInUse = 0;
+    pthread_mutex_unlock(&oReadersLock);
+}
+
+/* Create the key under which each thread keeps its reader record. */
+
+static void SymTable_createReaderKey(void)
+{
+    (void)pthread_key_create(&oReaderKey, SymTable_dropReader);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the reader record of the calling thread, taking over an
+abandoned one or adding a new one the first time, or NULL if
+insufficient memory is available. */
+
+static struct SymTableReader *SymTable_reader(void)
+{
+    struct SymTableReader *psReader;
+
+    (void)pthread_once(&oReaderOnce, SymTable_createReaderKey);
+    psReader = (struct SymTableReader *)pthread_getspecific(oReaderKey);
+    if (psReader != NULL) {
+        return psReader;
+    }
+
+    pthread_mutex_lock(&oReadersLock);
+    for (psReader = psReaders; psReader != NULL;
+    psReader = psReader->psNextReader)
+    {
+        if (! psReader->iInUse) {
+            break;
+        }
+    }
+    if (psReader == NULL) {
+        psReader = (struct SymTableReader *)calloc(1,
+            sizeof(struct SymTableReader));
+        if (psReader != NULL) {
+            psReader->psNextReader = psReaders;
+            psReaders = psReader;
+        }
+    }
+    if (psReader != NULL) {
+        psReader->iInUse = 1;
+        if (pthread_setspecific(oReaderKey, psReader) != 0) {
+            psReader->iInUse = 0;
+            psReader = NULL;
+        }
+    }
+    pthread_mutex_unlock(&oReadersLock);
+    return psReader;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Announce that the calling thread starts reading, and return its
+reader record, or NULL if it has none and must take locks instead. The
+announcement is a store to the thread's own record, so readers on
+different cores do not contend. */
+
+static struct SymTableReader *SymTable_enterRead(void)
+{
+    struct SymTableReader *psReader = SymTable_reader();
+
+    if (psReader != NULL) {
+        __atomic_store_n(&psReader->uEpoch,
+            __atomic_load_n(&uGlobalEpoch, __ATOMIC_SEQ_CST),
+            __ATOMIC_SEQ_CST);
+    }
+    return psReader;
+}
+
+/* Announce that the thread of psReader has finished reading. */
+
+static void SymTable_exitRead(struct SymTableReader *psReader)
+{
+    __atomic_store_n(&psReader->uEpoch, 0, __ATOMIC_RELEASE);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Advance the global epoch if every thread that is reading has
+announced it, and return the global epoch. */
+
+static size_t SymTable_advanceEpoch(void)
+{
+    struct SymTableReader *psReader;
+    size_t uEpoch;
+    size_t uReaderEpoch;
+
+    pthread_mutex_lock(&oReadersLock);
+    uEpoch = __atomic_load_n(&uGlobalEpoch, __ATOMIC_SEQ_CST);
+    for (psReader = psReaders; psReader != NULL;
+    psReader = psReader->psNextReader)
+    {
+        uReaderEpoch = __atomic_load_n(&psReader->uEpoch, __ATOMIC_SEQ_CST);
+        if (uReaderEpoch != 0 && uReaderEpoch != uEpoch) {
+            break;
+        }
+    }
+    if (psReader == NULL) {
+        uEpoch++;
+        __atomic_store_n(&uGlobalEpoch, uEpoch, __ATOMIC_SEQ_CST);
+    }
+    pthread_mutex_unlock(&oReadersLock);
+    return uEpoch;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvObject, a node of oSymTable if iIsNode is TRUE and a block
+from malloc, such as a bucket array, otherwise. */
+
+static void SymTable_dispose(SymTable_T oSymTable, void *pvObject,
+    int iIsNode)
+{
+    if (iIsNode) {
+        SymTable_freeNode(oSymTable, (struct SymTableNode *)pvObject);
+    }
+    else {
+        free(pvObject);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_CONCURRENT
+
+/* Free the objects retired by oSymTable that no reader can reach any
+more. The caller must hold oRetireLock. */
+
+static void SymTable_reclaim(SymTable_T oSymTable)
+{
+    struct SymTableRetired *psRetired = oSymTable->psRetired;
+    size_t uEpoch;
+    size_t uReady;
+
+    uEpoch = SymTable_advanceEpoch();
+    for (uReady = 0; uReady < oSymTable->uRetiredCount &&
+    psRetired[uReady].uEpoch + 2 <= uEpoch; uReady++)
+    {
+        SymTable_dispose(oSymTable, psRetired[uReady].pvObject,
+            psRetired[uReady].iIsNode);
+    }
+
+    if (uReady > 0) {
+        memmove(psRetired, psRetired + uReady,
+            (oSymTable->uRetiredCount - uReady) * sizeof(*psRetired));
+        oSymTable->uRetiredCount -= uReady;
+    }
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Free pvObject, a node of oSymTable if iIsNode is TRUE and a block
+from malloc otherwise, that has just been unlinked from oSymTable. The
+concurrent build retires it until no reader can reach it; if there is
+no memory to record it, it waits for the readers. */
+
+static void SymTable_retire(SymTable_T oSymTable, void *pvObject,
+    int iIsNode)
+{
+#ifdef SYMTABLE_CONCURRENT
+    struct SymTableRetired *psRetired;
+    size_t uRetiredSize;
+    size_t uEpoch;
+
+    if (pvObject == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&oSymTable->oRetireLock);
+    uEpoch = __atomic_load_n(&uGlobalEpoch, __ATOMIC_SEQ_CST);
+
+    if (oSymTable->uRetiredCount == oSymTable->uRetiredSize) {
+        SymTable_reclaim(oSymTable);
+    }
+    if (oSymTable->uRetiredCount == oSymTable->uRetiredSize) {
+        uRetiredSize = oSymTable->uRetiredSize == 0 ? RETIRE_BATCH :
+            2 * oSymTable->uRetiredSize;
+        psRetired = (struct SymTableRetired *)realloc(oSymTable->psRetired,
+            uRetiredSize * sizeof(struct SymTableRetired));
+        if (psRetired == NULL) {
+            while (SymTable_advanceEpoch() < uEpoch + 2) {
+                sched_yield();
+            }
+            SymTable_dispose(oSymTable, pvObject, iIsNode);
+            pthread_mutex_unlock(&oSymTable->oRetireLock);
+            return;
+        }
+        oSymTable->psRetired = psRetired;
+        oSymTable->uRetiredSize = uRetiredSize;
+    }
+
+    psRetired = &oSymTable->psRetired[oSymTable->uRetiredCount++];
+    psRetired->pvObject = pvObject;
+    psRetired->iIsNode = iIsNode;
+    psRetired->uEpoch = uEpoch;
+    pthread_mutex_unlock(&oSymTable->oRetireLock);
+#else
+    SymTable_dispose(oSymTable, pvObject, iIsNode);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_CONCURRENT
+
+/* Free every object that oSymTable has retired at once. No other
+thread may be using oSymTable. */
+
+static void SymTable_disposeRetired(SymTable_T oSymTable)
+{
+    for (; oSymTable->uRetiredCount > 0; oSymTable->uRetiredCount--)
+    {
+        SymTable_dispose(oSymTable,
+            oSymTable->psRetired[oSymTable->uRetiredCount - 1].pvObject,
+            oSymTable->psRetired[oSymTable->uRetiredCount - 1].iIsNode);
+    }
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Drop the reference of psNode, a node that has just been unlinked
+from oSymTable, to its key if the key is pooled. A key that leaves the
+pool is retired like the node itself, since readers may still be
+comparing against it. */
+
+static void SymTable_releaseKey(SymTable_T oSymTable,
+    struct SymTableNode *psNode)
+{
+    if (oSymTable->oPool != NULL) {
+        SymTable_retire(oSymTable,
+            SymTablePool_drop(oSymTable->oPool, psNode->pcKey), 0);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the bucket count that oSymTable expands into next, or 0 if
+no larger bucket count is representable. */
+
+static size_t SymTable_growBucketCount(SymTable_T oSymTable)
+{
+    if (oSymTable->eHash == SYMTABLE_HASH_WORDS) {
+        if (oSymTable->uBucketCount > ((size_t)-1) / 4) {
+            return 0;
+        }
+        return 2 * oSymTable->uBucketCount;
+    }
+
+    return SymTable_nextBucketCount(oSymTable->uBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the 64 bits of uValue in reverse order. */
+
+static uint64_t SymTable_reverseBits(uint64_t uValue)
+{
+    uValue = ((uValue >> 1) & 0x5555555555555555ULL) |
+        ((uValue & 0x5555555555555555ULL) << 1);
+    uValue = ((uValue >> 2) & 0x3333333333333333ULL) |
+        ((uValue & 0x3333333333333333ULL) << 2);
+    uValue = ((uValue >> 4) & 0x0f0f0f0f0f0f0f0fULL) |
+        ((uValue & 0x0f0f0f0f0f0f0f0fULL) << 4);
+    uValue = ((uValue >> 8) & 0x00ff00ff00ff00ffULL) |
+        ((uValue & 0x00ff00ff00ff00ffULL) << 8);
+    uValue = ((uValue >> 16) & 0x0000ffff0000ffffULL) |
+        ((uValue & 0x0000ffff0000ffffULL) << 16);
+    return (uValue >> 32) | (uValue << 32);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the position, for an iterator, of a binding of oSymTable
+whose hash code is uHash. With SYMTABLE_HASH_WORDS that is the hash
+code with its 64 bits reversed: the low bits that pick the bucket come
+first, so each bucket holds a range of positions, and doubling the
+bucket count splits every range in two. Otherwise it is the bucket,
+and oSymTable must not be expanding. */
+
+static uint64_t SymTable_iterPosition(SymTable_T oSymTable, size_t uHash)
+{
+    if (oSymTable->eHash == SYMTABLE_HASH_WORDS) {
+        return SymTable_reverseBits((uint64_t)uHash);
+    }
+
+    return (uint64_t)SymTable_reduce(oSymTable, uHash,
+        oSymTable->uBucketCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a negative number, 0, or a positive number as the binding of
+the SymTableIterEntry at pvEntry1 has a lower, the same, or a higher
+address than that of the one at pvEntry2. */
+
+static int SymTable_compareEntries(const void *pvEntry1,
+    const void *pvEntry2)
+{
+    uintptr_t uAddress1 =
+        (uintptr_t)((const struct SymTableIterEntry *)pvEntry1)->psNode;
+    uintptr_t uAddress2 =
+        (uintptr_t)((const struct SymTableIterEntry *)pvEntry2)->psNode;
+
+    return (uAddress1 > uAddress2) - (uAddress1 < uAddress2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give psIter, a started iterator over oSymTable, which uses the 65599
+hash and is not expanding, a snapshot of the bindings that it has yet
+to visit, or mark it done if there are none, and return 1 (TRUE). If
+insufficient memory is available, leave psIter unchanged and return 0
+(FALSE). */
+
+static int SymTable_snapshotIter(SymTable_T oSymTable,
+    struct SymTableIter *psIter)
+{
+    struct SymTableIterEntry *psSnapshot = NULL;
+    struct SymTableNode *psCurrentNode;
+    size_t uBucket;
+    size_t uLength;
+    int iPass;
+
+    assert(oSymTable->psGrowNode == NULL);
+
+    /* Count the bindings, then copy them. */
+    for (iPass = 0; iPass < 2; iPass++)
+    {
+        uLength = 0;
+        for (uBucket = (size_t)psIter->uPosition;
+        uBucket < oSymTable->uBucketCount; uBucket++)
+        {
+            for (psCurrentNode = oSymTable->psFirstNode[uBucket];
+            psCurrentNode != NULL; psCurrentNode = psCurrentNode->psNextNode)
+            {
+                if (uBucket == psIter->uPosition &&
+                (uintptr_t)psCurrentNode <= psIter->uAddress) {
+                    continue;
+                }
+                if (psSnapshot != NULL) {
+                    psSnapshot[uLength].psNode = psCurrentNode;
+                    psSnapshot[uLength].uHash = psCurrentNode->uHash;
+                    psSnapshot[uLength].iRemoved = 0;
+                }
+                uLength++;
+            }
+        }
+
+        if (uLength == 0) {
+            psIter->iDone = 1;
+            return 1;
+        }
+        if (psSnapshot == NULL) {
+            psSnapshot = (struct SymTableIterEntry *)malloc(uLength *
+                sizeof(struct SymTableIterEntry));
+            if (psSnapshot == NULL) {
+                return 0;
+            }
+        }
+    }
+
+    qsort(psSnapshot, uLength, sizeof(struct SymTableIterEntry),
+        SymTable_compareEntries);
+    psIter->psSnapshot = psSnapshot;
+    psIter->uSnapshotLength = uLength;
+    psIter->uSnapshotIndex = 0;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give a snapshot to every iterator over oSymTable that is about to
+lose its place because the table changes its buckets, and return 1
+(TRUE): with the 65599 hash, those started but neither done nor given
+one already. If insufficient memory is available, return 0 (FALSE),
+and the table must keep its buckets; the snapshots already given stay,
+since an iterator may as well use them. */
+
+static int SymTable_snapshotIters(SymTable_T oSymTable)
+{
+    struct SymTableIter *psIter;
+
+    if (oSymTable->eHash == SYMTABLE_HASH_WORDS) {
+        return 1;
+    }
+
+    for (psIter = oSymTable->psIters; psIter != NULL;
+    psIter = psIter->psNextIter)
+    {
+        if (psIter->psSnapshot != NULL || psIter->iDone ||
+        (psIter->uPosition == 0 && psIter->uAddress == 0)) {
+            continue;
+        }
+        if (! SymTable_snapshotIter(oSymTable, psIter)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move psIter off psNode, which has just been removed, if it is at
+it. In the concurrent build its owner may be moving it on at the same
+time under another stripe, and that move wins. */
+
+static void SymTable_moveIterOff(struct SymTableIter *psIter,
+    struct SymTableNode *psNode)
+{
+#ifdef SYMTABLE_CONCURRENT
+    (void)__atomic_compare_exchange_n(&psIter->psCurrentNode, &psNode,
+        NULL, 0, __ATOMIC_RELEASE, __ATOMIC_RELAXED);
+#else
+    if (psIter->psCurrentNode == psNode) {
+        psIter->psCurrentNode = NULL;
+    }
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Mark psNode, which has just been removed, in the snapshot of psIter
+if it is there. */
+
+static void SymTable_markRemoved(struct SymTableIter *psIter,
+    struct SymTableNode *psNode)
+{
+    size_t uLow = 0;
+    size_t uHigh = psIter->uSnapshotLength;
+    size_t uMiddle;
+
+    while (uLow < uHigh)
+    {
+        uMiddle = uLow + (uHigh - uLow) / 2;
+        if ((uintptr_t)psIter->psSnapshot[uMiddle].psNode <
+        (uintptr_t)psNode) {
+            uLow = uMiddle + 1;
+        }
+        else {
+            uHigh = uMiddle;
+        }
+    }
+
+    if (uLow < psIter->uSnapshotLength &&
+    psIter->psSnapshot[uLow].psNode == psNode) {
+        psIter->psSnapshot[uLow].iRemoved = 1;
+    }
+}
+
+#ifndef SYMTABLE_CONCURRENT
+
+/* Start expanding oSymTable into the next bucket count. The bindings
+are moved over a few buckets at a time by SymTable_growStep. If an
+expansion is already in progress or memory is insufficient, leave
+oSymTable unchanged; a later put tries again. */
+
+static void SymTable_startGrow(SymTable_T oSymTable)
+{
+    struct SymTableNode **psGrowNode;
+    size_t uGrowBucketCount;
+
+    assert(oSymTable != NULL);
+
+    if (oSymTable->psGrowNode != NULL) {
+        return;
+    }
+
+    uGrowBucketCount = SymTable_growBucketCount(oSymTable);
+    if (uGrowBucketCount == 0) {
+        return;
+    }
+
+    psGrowNode = calloc(uGrowBucketCount, sizeof(struct SymTableNode*));
+    if (psGrowNode == NULL) {
+        return;
+    }
+    if (! SymTable_snapshotIters(oSymTable)) {
+        free(psGrowNode);
+        return;
+    }
+
+    oSymTable->psGrowNode = psGrowNode;
+    oSymTable->uGrowBucketCount = uGrowBucketCount;
+    oSymTable->uGrowIndex = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable is expanding, move the bindings of the next few old
+buckets into the new buckets, and switch over to the new buckets once
+the old ones are empty. Every put, get and remove takes one step, so
+no single call pays for the whole expansion. */
+
+static void SymTable_growStep(SymTable_T oSymTable)
+{
+    enum {GROW_STEP_BUCKETS = 4};
+
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode *psNextNode;
+    size_t hashcode;
+    size_t uStep;
+
+    assert(oSymTable != NULL);
+
+    if (oSymTable->psGrowNode == NULL) {
+        return;
+    }
+
+    for (uStep = 0; uStep < GROW_STEP_BUCKETS &&
+    oSymTable->uGrowIndex < oSymTable->uBucketCount; uStep++)
+    {
+        for (psCurrentNode = oSymTable->psFirstNode[oSymTable->uGrowIndex];
+        psCurrentNode != NULL; psCurrentNode = psNextNode)
+        {
+            psNextNode = psCurrentNode->psNextNode;
+            hashcode = SymTable_reduce(oSymTable, psCurrentNode->uHash,
+                oSymTable->uGrowBucketCount);
+            psCurrentNode->psNextNode = oSymTable->psGrowNode[hashcode];
+            oSymTable->psGrowNode[hashcode] = psCurrentNode;
+        }
+        oSymTable->psFirstNode[oSymTable->uGrowIndex] = NULL;
+        oSymTable->uGrowIndex++;
+    }
+
+    if (oSymTable->uGrowIndex == oSymTable->uBucketCount) {
+        free(oSymTable->psFirstNode);
+        oSymTable->psFirstNode = oSymTable->psGrowNode;
+        oSymTable->uBucketCount = oSymTable->uGrowBucketCount;
+        oSymTable->psGrowNode = NULL;
+        oSymTable->uGrowBucketCount = 0;
+        oSymTable->uGrowIndex = 0;
+    }
+}
+
+#else
+
+/* The concurrent build never expands incrementally: SymTable_checkGrow
+rehashes the whole table at once, so there is no step to take. */
+
+static void SymTable_growStep(SymTable_T oSymTable)
+{
+    (void)oSymTable;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the first-node pointer of the bucket that
+holds, or would hold, a binding whose key has hash code uHash. While
+oSymTable is expanding that is an old bucket unless it has already been
+moved. */
+
+static struct SymTableNode **SymTable_bucket(SymTable_T oSymTable,
+    size_t uHash)
+{
+    size_t hashcode;
+
+    assert(oSymTable != NULL);
+
+    hashcode = SymTable_reduce(oSymTable, uHash, oSymTable->uBucketCount);
+
+    if (oSymTable->psGrowNode != NULL && hashcode < oSymTable->uGrowIndex)
+    {
+        hashcode = SymTable_reduce(oSymTable, uHash,
+            oSymTable->uGrowBucketCount);
+        return &oSymTable->psGrowNode[hashcode];
+    }
+
+    return &oSymTable->psFirstNode[hashcode];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if psNode is the binding of the uLength characters at
+pcKey, which have hash code uHash, or 0 (FALSE) if otherwise. */
+
+static int SymTable_matches(const struct SymTableNode *psNode,
+    const char *pcKey, size_t uLength, size_t uHash)
+{
+    return psNode->uHash == uHash && psNode->uLength == uLength &&
+        (psNode->pcKey == pcKey ||
+        memcmp(psNode->pcKey, pcKey, uLength) == 0);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the pointer to the binding of oSymTable whose
+key is the uLength characters at pcKey, which have hash code uHash, or,
+if there is no such binding, the address of the NULL pointer that ends
+its bucket. */
+
+static struct SymTableNode **SymTable_findLink(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash)
+{
+    struct SymTableNode **ppsLink;
+    struct SymTableNode *psCurrentNode;
+
+    for (ppsLink = SymTable_bucket(oSymTable, uHash);
+    (psCurrentNode = *ppsLink) != NULL;
+    ppsLink = &psCurrentNode->psNextNode)
+    {
+        if (SymTable_matches(psCurrentNode, pcKey, uLength, uHash)) {
+            break;
+        }
+    }
+
+    return ppsLink;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the smallest bucket count that the hash function eHash allows
+and that holds uLength bindings without expanding, or 0 if no such
+bucket count is representable. Below uBucketCounts[0] that is the
+smallest prime, or power of two, that is at least uLength. */
+
+static size_t SymTable_capacityBucketCount(enum SymTableHash eHash,
+    size_t uLength)
+{
+    size_t uBucketCount;
+
+    if (eHash == SYMTABLE_HASH_WORDS) {
+        for (uBucketCount = MIN_WORDS_BUCKET_COUNT; uBucketCount < uLength;
+        uBucketCount *= 2)
+        {
+            if (uBucketCount > ((size_t)-1) / 4) {
+                return 0;
+            }
+        }
+        return uBucketCount;
+    }
+
+    if (uLength < uBucketCounts[0]) {
+        if (uLength < MIN_PRIME_BUCKET_COUNT) {
+            uLength = MIN_PRIME_BUCKET_COUNT;
+        }
+        return SymTable_primeAtLeast(uLength);
+    }
+
+    for (uBucketCount = uBucketCounts[0]; uBucketCount < uLength; )
+    {
+        uBucketCount = SymTable_nextBucketCount(uBucketCount);
+        if (uBucketCount == 0) {
+            return 0;
+        }
+    }
+    return uBucketCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSymTable into uBucketCount new buckets at
+once, finishing any expansion in progress, and return 1 (TRUE). If
+insufficient memory is available, leave oSymTable unchanged and return
+0 (FALSE). uBucketCount must not be smaller than the current bucket
+count while other threads use oSymTable. */
+
+static int SymTable_rehash(SymTable_T oSymTable, size_t uBucketCount)
+{
+    struct SymTableNode **psFirstNode;
+    struct SymTableNode **apsOldNodes[2];
+    size_t auOldBucketCounts[2];
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode *psNextNode;
+    size_t hashcode;
+    size_t i;
+    size_t j;
+
+    psFirstNode = calloc(uBucketCount, sizeof(struct SymTableNode*));
+    if (psFirstNode == NULL) {
+        return 0;
+    }
+    if (! SymTable_snapshotIters(oSymTable)) {
+        free(psFirstNode);
+        return 0;
+    }
+
+#ifdef SYMTABLE_CONCURRENT
+    __atomic_store_n(&oSymTable->uSequence, oSymTable->uSequence + 1,
+        __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+
+    apsOldNodes[0] = oSymTable->psFirstNode;
+    auOldBucketCounts[0] = oSymTable->uBucketCount;
+    apsOldNodes[1] = oSymTable->psGrowNode;
+    auOldBucketCounts[1] = oSymTable->uGrowBucketCount;
+
+    for (j = 0; j < 2; j++)
+    {
+        for (i = 0; i < auOldBucketCounts[j]; i++)
+        {
+            for (psCurrentNode = apsOldNodes[j][i]; psCurrentNode != NULL;
+            psCurrentNode = psNextNode)
+            {
+                psNextNode = psCurrentNode->psNextNode;
+                hashcode = SymTable_reduce(oSymTable, psCurrentNode->uHash,
+                    uBucketCount);
+                SYMTABLE_STORE(psCurrentNode->psNextNode,
+                    psFirstNode[hashcode]);
+                psFirstNode[hashcode] = psCurrentNode;
+            }
+        }
+    }
+
+    /* Lock-free readers load the bucket count before the buckets, so
+    they never index the old buckets with the new, larger count. */
+    SYMTABLE_STORE(oSymTable->psFirstNode, psFirstNode);
+    SYMTABLE_STORE(oSymTable->uBucketCount, uBucketCount);
+    oSymTable->psGrowNode = NULL;
+    oSymTable->uGrowBucketCount = 0;
+    oSymTable->uGrowIndex = 0;
+
+#ifdef SYMTABLE_CONCURRENT
+    __atomic_store_n(&oSymTable->uSequence, oSymTable->uSequence + 1,
+        __ATOMIC_RELEASE);
+#endif
+
+    SymTable_retire(oSymTable, apsOldNodes[0], 0);
+    SymTable_retire(oSymTable, apsOldNodes[1], 0);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* In the concurrent build, lock the stripe of oSymTable that guards the
+bucket of hash code uHash, for writing if iWrite is TRUE and for reading
+otherwise, and return the stripe. The bucket count is checked again
+once the lock is held, since a rehash in between may have moved the
+bucket to another stripe. Otherwise just return 0. */
+
+static size_t SymTable_lockBucket(SymTable_T oSymTable, size_t uHash,
+    int iWrite)
+{
+#ifdef SYMTABLE_CONCURRENT
+    pthread_rwlock_t *poLock;
+    size_t uBucketCount;
+
+    for (;;)
+    {
+        uBucketCount = SYMTABLE_LOAD(oSymTable->uBucketCount);
+        poLock = &oSymTable->asStripes[SymTable_reduce(oSymTable, uHash,
+            uBucketCount) % STRIPE_COUNT].oLock;
+        if (iWrite) {
+            pthread_rwlock_wrlock(poLock);
+        }
+        else {
+            pthread_rwlock_rdlock(poLock);
+        }
+        if (oSymTable->uBucketCount == uBucketCount) {
+            return SymTable_reduce(oSymTable, uHash, uBucketCount) %
+                STRIPE_COUNT;
+        }
+        pthread_rwlock_unlock(poLock);
+    }
+#else
+    (void)oSymTable;
+    (void)uHash;
+    (void)iWrite;
+    return 0;
+#endif
+}
+
+/* Unlock stripe uStripe of oSymTable, in the concurrent build. */
+
+static void SymTable_unlockStripe(SymTable_T oSymTable, size_t uStripe)
+{
+#ifdef SYMTABLE_CONCURRENT
+    pthread_rwlock_unlock(&oSymTable->asStripes[uStripe].oLock);
+#else
+    (void)oSymTable;
+    (void)uStripe;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Lock every stripe of oSymTable, in order, for writing if iWrite is
+TRUE and for reading otherwise, in the concurrent build. */
+
+static void SymTable_lockAll(SymTable_T oSymTable, int iWrite)
+{
+#ifdef SYMTABLE_CONCURRENT
+    size_t u;
+
+    for (u = 0; u < STRIPE_COUNT; u++)
+    {
+        if (iWrite) {
+            pthread_rwlock_wrlock(&oSymTable->asStripes[u].oLock);
+        }
+        else {
+            pthread_rwlock_rdlock(&oSymTable->asStripes[u].oLock);
+        }
+    }
+#else
+    (void)oSymTable;
+    (void)iWrite;
+#endif
+}
+
+/* Unlock every stripe of oSymTable, in the concurrent build. */
+
+static void SymTable_unlockAll(SymTable_T oSymTable)
+{
+#ifdef SYMTABLE_CONCURRENT
+    size_t u;
+
+    for (u = 0; u < STRIPE_COUNT; u++)
+    {
+        pthread_rwlock_unlock(&oSymTable->asStripes[u].oLock);
+    }
+#else
+    (void)oSymTable;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Expand oSymTable if it has more bindings than buckets. Normally that
+starts an incremental expansion; in the concurrent build it rehashes at
+once with every stripe locked, and the caller must hold no stripe. */
+
+static void SymTable_checkGrow(SymTable_T oSymTable)
+{
+#ifdef SYMTABLE_CONCURRENT
+    size_t uBucketCount;
+
+    if (SYMTABLE_LOAD(oSymTable->length) <=
+    SYMTABLE_LOAD(oSymTable->uBucketCount)) {
+        return;
+    }
+
+    SymTable_lockAll(oSymTable, 1);
+    if (oSymTable->length > oSymTable->uBucketCount) {
+        uBucketCount = SymTable_growBucketCount(oSymTable);
+        if (uBucketCount != 0) {
+            (void)SymTable_rehash(oSymTable, uBucketCount);
+        }
+    }
+    SymTable_unlockAll(oSymTable);
+#else
+    if (oSymTable->length > oSymTable->uBucketCount) {
+        SymTable_startGrow(oSymTable);
+    }
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings, or NULL if 
+insufficient memory is available. */
+
+SymTable_T SymTable_new(void)
+{
+    return SymTable_newWithPool(NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_CONCURRENT
+
+/* Initialize the locks of oSymTable and return 1 (TRUE), or return 0
+(FALSE), with none of them initialized, if that fails. */
+
+static int SymTable_initLocks(SymTable_T oSymTable)
+{
+    size_t u;
+
+    if (pthread_mutex_init(&oSymTable->oAllocLock, NULL) != 0) {
+        return 0;
+    }
+    if (pthread_mutex_init(&oSymTable->oRetireLock, NULL) != 0) {
+        pthread_mutex_destroy(&oSymTable->oAllocLock);
+        return 0;
+    }
+
+    for (u = 0; u < STRIPE_COUNT; u++)
+    {
+        if (pthread_rwlock_init(&oSymTable->asStripes[u].oLock, NULL) != 0)
+        {
+            while (u-- > 0) {
+                pthread_rwlock_destroy(&oSymTable->asStripes[u].oLock);
+            }
+            pthread_mutex_destroy(&oSymTable->oRetireLock);
+            pthread_mutex_destroy(&oSymTable->oAllocLock);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Destroy the locks of oSymTable. */
+
+static void SymTable_destroyLocks(SymTable_T oSymTable)
+{
+    size_t u;
+
+    for (u = 0; u < STRIPE_COUNT; u++)
+    {
+        pthread_rwlock_destroy(&oSymTable->asStripes[u].oLock);
+    }
+    pthread_mutex_destroy(&oSymTable->oRetireLock);
+    pthread_mutex_destroy(&oSymTable->oAllocLock);
+}
+
+/*--------------------------------------------------------------------*/
+
+#endif
+
+/* Return a new SymTable object with no bindings and room for uCapacity
+of them, whose keys are kept in oPool, or in the table itself if oPool
+is NULL. Return NULL if insufficient memory is available. */
+
+static SymTable_T SymTable_newTable(SymTablePool_T oPool,
+    size_t uCapacity)
+{
+    SymTable_T oSymTable;
+    size_t uBucketCount;
+
+    uBucketCount = SymTable_capacityBucketCount(SYMTABLE_HASH_65599,
+        uCapacity);
+    if (uBucketCount == 0) {
+        return NULL;
+    }
+
+    oSymTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+
+    if (oSymTable == NULL)
+    {
+        return NULL;
+    }
+
+    oSymTable->psFirstNode = calloc(uBucketCount, sizeof(struct SymTableNode*));
+
+    if (oSymTable->psFirstNode == NULL)
+    {
+        free(oSymTable);
+        return NULL;
+    }
+
+    oSymTable->uBucketCount = uBucketCount;
+    oSymTable->oPool = oPool;
+    oSymTable->eHash = SYMTABLE_HASH_65599;
+    oSymTable->uCapacity = uCapacity;
+
+#ifdef SYMTABLE_CONCURRENT
+    if (! SymTable_initLocks(oSymTable))
+    {
+        free(oSymTable->psFirstNode);
+        free(oSymTable);
+        return NULL;
+    }
+#endif
+
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings whose keys are kept in
+oPool, or in the table itself if oPool is NULL. Return NULL if
+insufficient memory is available. oPool must outlive the table. */
+
+SymTable_T SymTable_newWithPool(SymTablePool_T oPool)
+{
+    return SymTable_newTable(oPool, uBucketCounts[0]);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings whose buckets are
+sized so that it holds uCapacity bindings without expanding, or NULL if
+insufficient memory is available. */
+
+SymTable_T SymTable_newWithCapacity(size_t uCapacity)
+{
+    return SymTable_newTable(NULL, uCapacity);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make eHash the hash function of oSymTable and return 1 (TRUE). If
+oSymTable is not empty, is read-only or has live iterators, or
+insufficient memory is available, leave oSymTable unchanged and return
+0 (FALSE). */
+
+int SymTable_setHash(SymTable_T oSymTable, enum SymTableHash eHash)
+{
+    struct SymTableNode **psFirstNode;
+    size_t uBucketCount;
+
+    assert(oSymTable != NULL);
+
+    if (oSymTable->length != 0 || SymTable_isReadOnly(oSymTable) ||
+    oSymTable->psIters != NULL) {
+        return 0;
+    }
+
+    uBucketCount = SymTable_capacityBucketCount(eHash, oSymTable->uCapacity);
+    if (uBucketCount == 0) {
+        return 0;
+    }
+
+    psFirstNode = calloc(uBucketCount, sizeof(struct SymTableNode*));
+    if (psFirstNode == NULL) {
+        return 0;
+    }
+
+    free(oSymTable->psGrowNode);
+    free(oSymTable->psFirstNode);
+    oSymTable->psGrowNode = NULL;
+    oSymTable->uGrowBucketCount = 0;
+    oSymTable->uGrowIndex = 0;
+    oSymTable->psFirstNode = psFirstNode;
+    oSymTable->uBucketCount = uBucketCount;
+    oSymTable->eHash = eHash;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make oSymTable hold uCapacity bindings without expanding, as
+SymTable_reserve does. The caller must hold every stripe for writing. */
+
+static int SymTable_reserveBuckets(SymTable_T oSymTable, size_t uCapacity)
+{
+    size_t uBucketCount;
+
+    uBucketCount = SymTable_capacityBucketCount(oSymTable->eHash,
+        uCapacity);
+    if (uBucketCount == 0) {
+        return 0;
+    }
+    if (uBucketCount < oSymTable->uGrowBucketCount) {
+        uBucketCount = oSymTable->uGrowBucketCount;
+    }
+    if (uBucketCount < oSymTable->uBucketCount) {
+        uBucketCount = oSymTable->uBucketCount;
+    }
+
+    if (uBucketCount != oSymTable->uBucketCount ||
+    oSymTable->psGrowNode != NULL) {
+        if (! SymTable_rehash(oSymTable, uBucketCount)) {
+            return 0;
+        }
+    }
+
+    if (uCapacity > oSymTable->uCapacity) {
+        oSymTable->uCapacity = uCapacity;
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make oSymTable hold uCapacity bindings without expanding, moving its
+bindings into larger buckets now if need be, and return 1 (TRUE). An
+expansion in progress is finished on the way. If insufficient memory is
+available, leave oSymTable unchanged and return 0 (FALSE). */
+
+int SymTable_reserve(SymTable_T oSymTable, size_t uCapacity)
+{
+    int iSuccessful;
+
+    assert(oSymTable != NULL);
+
+    SymTable_lockAll(oSymTable, 1);
+    iSuccessful = SymTable_reserveBuckets(oSymTable, uCapacity);
+    SymTable_unlockAll(oSymTable);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Release what the nodes in the uBucketCount buckets at psBuckets of
+oSymTable own outside the slabs: pooled keys, and nodes too large to
+have come from a slab. */
+
+static void SymTable_releaseNodes(SymTable_T oSymTable,
+    struct SymTableNode **psBuckets, size_t uBucketCount)
+{
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode *psNextNode;
+    size_t i;
+
+    for (i = 0; i < uBucketCount; i++) 
+    {
+        for (psCurrentNode = psBuckets[i]; psCurrentNode != NULL; 
+        psCurrentNode = psNextNode) 
+        {
+            psNextNode = psCurrentNode->psNextNode;
+            if (oSymTable->oPool != NULL) {
+                SymTablePool_release(oSymTable->oPool,
+                    psCurrentNode->pcKey);
+            }
+            else if (SymTable_nodeSize(oSymTable, psCurrentNode->uLength) >
+            SLAB_MAX_NODE_SIZE) {
+                free(psCurrentNode);
+            }
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free psFrozen and its arrays. */
+
+static void SymTable_freeFrozen(struct SymTableFrozen *psFrozen)
+{
+    free(psFrozen->puPilots);
+    free(psFrozen->puRemap);
+    free(psFrozen->puOffsets);
+    free(psFrozen->pcEntries);
+    free(psFrozen);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the nodes of oSymTable, and the slabs that they came from,
+leaving its buckets dangling. The slab nodes go away with their slabs,
+so the buckets are only walked if some node was too large for a slab or
+the keys are pooled. */
+
+static void SymTable_releaseStorage(SymTable_T oSymTable)
+{
+    struct SymTableSlab *psCurrentSlab;
+    struct SymTableSlab *psNextSlab;
+
+#ifdef SYMTABLE_CONCURRENT
+    SymTable_disposeRetired(oSymTable);
+#endif
+
+    if (oSymTable->uLargeNodeCount > 0 || oSymTable->oPool != NULL)
+    {
+        SymTable_releaseNodes(oSymTable, oSymTable->psFirstNode,
+            oSymTable->uBucketCount);
+        if (oSymTable->psGrowNode != NULL) {
+            SymTable_releaseNodes(oSymTable, oSymTable->psGrowNode,
+                oSymTable->uGrowBucketCount);
+        }
+    }
+
+    for (psCurrentSlab = oSymTable->psSlabs; psCurrentSlab != NULL;
+    psCurrentSlab = psNextSlab)
+    {
+        psNextSlab = psCurrentSlab->psNextSlab;
+        free(psCurrentSlab);
+    }
+
+    oSymTable->psSlabs = NULL;
+    oSymTable->pcSlabFree = NULL;
+    oSymTable->uSlabLeft = 0;
+    memset(oSymTable->apsFreeNodes, 0, sizeof(oSymTable->apsFreeNodes));
+    oSymTable->uLargeNodeCount = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oSymTable. A mapped table is unmapped. */
+
+void SymTable_free(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+    assert(oSymTable->psIters == NULL);
+
+    SymTable_releaseStorage(oSymTable);
+
+#ifdef SYMTABLE_CONCURRENT
+    free(oSymTable->psRetired);
+    SymTable_destroyLocks(oSymTable);
+#endif
+
+    if (oSymTable->pucMapped != NULL) {
+        munmap((void *)oSymTable->pucMapped, oSymTable->uMappedSize);
+    }
+    if (oSymTable->psFrozen != NULL) {
+        SymTable_freeFrozen(oSymTable->psFrozen);
+    }
+
+    free(oSymTable->psGrowNode);
+    free(oSymTable->psFirstNode);
+    free (oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable */
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+
+    return SYMTABLE_LOAD(oSymTable->length);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make psNewNode, a node of oSymTable that already holds its key, the
+binding of that key, whose hash code under oSymTable's hash function is
+uHash, to pvValue, linking it in at *ppsLink, the NULL pointer that
+SymTable_findLink returned for the key. */
+
+static void SymTable_linkNode(SymTable_T oSymTable,
+    struct SymTableNode **ppsLink, struct SymTableNode *psNewNode,
+    size_t uHash, const void *pvValue)
+{
+    assert(*ppsLink == NULL);
+
+    psNewNode->pvValue = pvValue;
+    psNewNode->uHash = uHash;
+    psNewNode->psNextNode = NULL;
+    SYMTABLE_STORE(*ppsLink, psNewNode);
+    SYMTABLE_ADD(oSymTable->length, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the uLength characters at pcKey, whose hash code
+under oSymTable's hash function is uHash, to pvValue at *ppsLink, the
+NULL pointer that SymTable_findLink returned for the key. Return the new
+node, or NULL if insufficient memory is available. */
+
+static struct SymTableNode *SymTable_insertAt(SymTable_T oSymTable,
+    struct SymTableNode **ppsLink, const char *pcKey, size_t uLength,
+    size_t uHash, const void *pvValue)
+{
+    struct SymTableNode *psNewNode;
+
+    /* defensive copy */
+    psNewNode = SymTable_newNode(oSymTable, pcKey, uLength);
+
+    if (psNewNode == NULL) 
+    {
+        return NULL;
+    }
+
+    SymTable_linkNode(oSymTable, ppsLink, psNewNode, uHash, pvValue);
+    return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the uLength characters at pcKey, whose hash code
+under oSymTable's hash function is uHash, to pvValue, as SymTable_put
+and SymTable_putK do. A read-only table takes no bindings. */
+
+static int SymTable_putHashed(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash, const void *pvValue)
+{
+    struct SymTableNode **ppsLink;
+
+    if (SymTable_isReadOnly(oSymTable)) {
+        return 0;
+    }
+
+    ppsLink = SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+    if (*ppsLink != NULL) {
+        return 0;
+    }
+
+    return SymTable_insertAt(oSymTable, ppsLink, pcKey, uLength, uHash,
+        pvValue) != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the value of the binding of the uLength
+characters at pcKey, whose hash code under oSymTable's hash function is
+uHash, adding a binding to pvValue first if there is none. Set
+*piInserted to 1 (TRUE) if the binding was added or 0 (FALSE) if it was
+already there or could not be added. Return NULL if insufficient memory
+is available or oSymTable is read-only. */
+
+static void **SymTable_slotHashed(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash, const void *pvValue, int *piInserted)
+{
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode **ppsLink;
+
+    *piInserted = 0;
+    if (SymTable_isReadOnly(oSymTable)) {
+        return NULL;
+    }
+
+    ppsLink = SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+    psCurrentNode = *ppsLink;
+
+    if (psCurrentNode == NULL) {
+        psCurrentNode = SymTable_insertAt(oSymTable, ppsLink, pcKey,
+            uLength, uHash, pvValue);
+        if (psCurrentNode == NULL) {
+            return NULL;
+        }
+        *piInserted = 1;
+    }
+
+    return (void **)(void *)&psCurrentNode->pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the binding of the uLength characters at pcKey, whose hash
+code under oSymTable's hash function is uHash, as SymTable_remove and
+SymTable_removeK do. */
+
+static void *SymTable_removeHashed(SymTable_T oSymTable,
+    const char *pcKey, size_t uLength, size_t uHash)
+{
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode **ppsLink;
+    struct SymTableIter *psIter;
+    void *oldval;
+
+    ppsLink = SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+    psCurrentNode = *ppsLink;
+    if (psCurrentNode == NULL) {
+        return NULL;
+    }
+
+    oldval = (void *) psCurrentNode->pvValue;
+    /* relink to remove current node */
+    SYMTABLE_STORE(*ppsLink, psCurrentNode->psNextNode);
+
+    /* move iterators off the node, and out of their snapshots */
+    for (psIter = oSymTable->psIters; psIter != NULL;
+    psIter = psIter->psNextIter)
+    {
+        SymTable_moveIterOff(psIter, psCurrentNode);
+        if (psIter->psSnapshot != NULL) {
+            SymTable_markRemoved(psIter, psCurrentNode);
+        }
+    }
+    SymTable_releaseKey(oSymTable, psCurrentNode);
+    SymTable_retire(oSymTable, psCurrentNode, 1);
+    SYMTABLE_ADD(oSymTable->length, (size_t)-1);
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A file that SymTable_save writes holds, in the byte order and word
+size of the machine that wrote it:
+   the 8 bytes of acSnapshotMagic;
+   one record per binding: a SymTableRecord, then the key and its '\0',
+   then the value's bytes, each of the last two padded with zeros to a
+   multiple of 8 bytes;
+   the slots, a power-of-two number of uint64_t values. The binding
+   whose key has SYMTABLE_HASH_WORDS hash code h is in the first slot
+   from h modulo the slot count on, wrapping around, that no other
+   binding took first. A slot holds 0 if it is empty, and otherwise the
+   offset of its record in the low SLOT_OFFSET_BITS bits and the bits
+   of h above those in the rest, so that most probes of other keys
+   fail without reading a record;
+   a SymTableTrailer.
+Everything is found by its offset from the start of the file, so the
+file can be mapped at any address and used as it is. */
+
+static const char acSnapshotMagic[8] = "SymTab\0\1";
+
+enum {SLOT_OFFSET_BITS = 48};
+
+#define SLOT_OFFSET_MASK ((((uint64_t)1) << SLOT_OFFSET_BITS) - 1)
+
+#define SNAPSHOT_TRAILER_MAGIC ((uint64_t)0x53796d5461624d70)
+
+/* The record of a binding: the length of its key, not counting the
+'\0', and the number of bytes of its value. */
+
+struct SymTableRecord
+{
+    uint64_t uKeyLength;
+    uint64_t uValueSize;
+};
+
+/* The end of a saved table. */
+
+struct SymTableTrailer
+{
+    /* SNAPSHOT_TRAILER_MAGIC, which reads differently on a machine of
+    the other byte order. */
+    uint64_t uMagic;
+
+    /* The number of bits of the hash codes, those of a size_t. */
+    uint64_t uHashBits;
+
+    /* The number of bindings. */
+    uint64_t uLength;
+
+    /* The number of slots, and the offset of the first one. */
+    uint64_t uSlotCount;
+    uint64_t uSlotsOffset;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the size of uSize bytes padded to a multiple of 8. */
+
+static size_t SymTable_pad8(size_t uSize)
+{
+    return (uSize + 7) & ~(size_t)7;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Find the record that slot uSlot of the mapping of oSymTable points
+to, store its key, the length of the key and the address of its value
+in *ppcKey, *puLength and *ppvValue, and return 1 (TRUE). Return 0
+(FALSE) if the record does not lie wholly among the records, as it
+would not in a damaged file. */
+
+static int SymTable_mappedRecord(SymTable_T oSymTable, uint64_t uSlot,
+    const char **ppcKey, size_t *puLength, void **ppvValue)
+{
+    const struct SymTableRecord *psRecord;
+    size_t uOffset;
+    size_t uLeft;
+    size_t uKeySize;
+
+    uOffset = (size_t)(uSlot & SLOT_OFFSET_MASK);
+    if ((uOffset & 7) != 0 || uOffset > oSymTable->uMappedRecordsEnd ||
+    oSymTable->uMappedRecordsEnd - uOffset < sizeof(*psRecord)) {
+        return 0;
+    }
+
+    psRecord = (const struct SymTableRecord *)(const void *)
+        (oSymTable->pucMapped + uOffset);
+    uOffset += sizeof(*psRecord);
+    uLeft = oSymTable->uMappedRecordsEnd - uOffset;
+    if (psRecord->uKeyLength >= uLeft) {
+        return 0;
+    }
+    uKeySize = SymTable_pad8((size_t)psRecord->uKeyLength + 1);
+    if (psRecord->uValueSize > uLeft - uKeySize ||
+    oSymTable->pucMapped[uOffset + psRecord->uKeyLength] != '\0') {
+        return 0;
+    }
+
+    *ppcKey = (const char *)(oSymTable->pucMapped + uOffset);
+    *puLength = (size_t)psRecord->uKeyLength;
+    *ppvValue = (void *)(oSymTable->pucMapped + uOffset + uKeySize);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the mapping of oSymTable has a binding of the
+uLength characters at pcKey, which have hash code uHash, and store the
+address of its value in *ppvValue, or return 0 (FALSE) if it has none.
+Slots with other hash bits are passed over without reading their
+records. */
+
+static int SymTable_lookupMapped(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash, void **ppvValue)
+{
+    uint64_t uHashBits;
+    uint64_t uSlot;
+    const char *pcRecordKey;
+    size_t uRecordLength;
+    void *pvValue;
+    size_t uIndex;
+    size_t uProbes;
+
+    uHashBits = (uint64_t)uHash & ~SLOT_OFFSET_MASK;
+    uIndex = uHash & oSymTable->uMappedSlotMask;
+    for (uProbes = 0; uProbes <= oSymTable->uMappedSlotMask; uProbes++)
+    {
+        uSlot = oSymTable->puMappedSlots[uIndex];
+        if (uSlot == 0) {
+            return 0;
+        }
+        if ((uSlot & ~SLOT_OFFSET_MASK) == uHashBits &&
+        SymTable_mappedRecord(oSymTable, uSlot, &pcRecordKey,
+        &uRecordLength, &pvValue) && uRecordLength == uLength &&
+        memcmp(pcRecordKey, pcKey, uLength) == 0) {
+            *ppvValue = pvValue;
+            return 1;
+        }
+        uIndex = (uIndex + 1) & oSymTable->uMappedSlotMask;
+    }
+    return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply *pfApply to each binding of the mapping of oSymTable, as
+SymTable_map does, in the order of their slots. */
+
+static void SymTable_mapMapped(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra)
+{
+    const char *pcKey;
+    size_t uLength;
+    void *pvValue;
+    size_t u;
+
+    for (u = 0; u <= oSymTable->uMappedSlotMask; u++)
+    {
+        if (oSymTable->puMappedSlots[u] != 0 &&
+        SymTable_mappedRecord(oSymTable, oSymTable->puMappedSlots[u],
+        &pcKey, &uLength, &pvValue)) {
+            (*pfApply)(pcKey, pvValue, (void *) pvExtra);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the bucket of psFrozen of a key whose hash code is uHash. The
+divisions are by constants, so they compile to multiplications. */
+
+static size_t SymTable_frozenBucket(const struct SymTableFrozen *psFrozen,
+    size_t uHash)
+{
+    uint64_t uLow = (uint32_t)uHash;
+
+    if (uLow < FROZEN_DENSE_LIMIT) {
+        return (size_t)(uLow * psFrozen->uDenseCount / FROZEN_DENSE_LIMIT);
+    }
+    return psFrozen->uDenseCount + (size_t)((uLow - FROZEN_DENSE_LIMIT) *
+        (psFrozen->uBucketCount - psFrozen->uDenseCount) /
+        ((((uint64_t)1) << 32) - FROZEN_DENSE_LIMIT));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the position, below the slot count of psFrozen, of a key
+whose hash code is uHash in a bucket with pilot uPilot. */
+
+static size_t SymTable_frozenPosition(
+    const struct SymTableFrozen *psFrozen, size_t uHash,
+    unsigned int uPilot)
+{
+    return (size_t)(SymTable_mulFold((uint64_t)uHash ^
+        ((uint64_t)uPilot * FROZEN_PILOT_MULTIPLIER), WORDS_SECRET1) %
+        psFrozen->uSlotCount);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the entry at offset uOffset, in units of 8 bytes, among the
+entries of psFrozen. */
+
+static const struct SymTableFrozenEntry *SymTable_frozenEntry(
+    const struct SymTableFrozen *psFrozen, size_t uOffset)
+{
+    return (const struct SymTableFrozenEntry *)(const void *)
+        (psFrozen->pcEntries + uOffset * 8);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if frozen oSymTable has a binding of the uLength
+characters at pcKey, which have hash code uHash under its seed, and
+store its value in *ppvValue, or return 0 (FALSE) if it has none. The
+pilot of the key's bucket gives the key's position, and the position
+its one entry, so each lookup compares one key. */
+
+static int SymTable_lookupFrozen(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash, void **ppvValue)
+{
+    const struct SymTableFrozen *psFrozen = oSymTable->psFrozen;
+    const struct SymTableFrozenEntry *psEntry;
+    size_t uPosition;
+
+    if (oSymTable->length == 0) {
+        return 0;
+    }
+
+    uPosition = SymTable_frozenPosition(psFrozen, uHash,
+        psFrozen->puPilots[SymTable_frozenBucket(psFrozen, uHash)]);
+    if (uPosition >= oSymTable->length) {
+        uPosition = psFrozen->puRemap[uPosition - oSymTable->length];
+    }
+
+    psEntry = SymTable_frozenEntry(psFrozen,
+        psFrozen->puOffsets[uPosition]);
+    if (psEntry->uLength != uLength ||
+    memcmp(psEntry->acKey, pcKey, uLength) != 0) {
+        return 0;
+    }
+    *ppvValue = (void *) psEntry->pvValue;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply *pfApply to each binding of frozen oSymTable, as SymTable_map
+does, in the order of their positions. */
+
+static void SymTable_mapFrozen(SymTable_T oSymTable,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra)
+{
+    const struct SymTableFrozenEntry *psEntry;
+    size_t u;
+
+    for (u = 0; u < oSymTable->length; u++)
+    {
+        psEntry = SymTable_frozenEntry(oSymTable->psFrozen,
+            oSymTable->psFrozen->puOffsets[u]);
+        (*pfApply)(psEntry->acKey, (void *) psEntry->pvValue,
+            (void *) pvExtra);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable has a binding of the uLength characters
+at pcKey, which have hash code uHash, and store its value in *ppvValue,
+or return 0 (FALSE) if it has none. A table that SymTable_openMapped
+returned is looked up in its mapping.
+
+The concurrent build takes no lock. A bucket count read before a
+rehash with the buckets read after it is still in range, because
+rehashes only add buckets, and a chain walk that a rehash disturbs may
+miss the key but always ends. A miss is therefore trusted only if
+uSequence shows that no rehash overlapped the walk. */
+
+static int SymTable_lookup(SymTable_T oSymTable, const char *pcKey,
+    size_t uLength, size_t uHash, void **ppvValue)
+{
+    struct SymTableNode *psCurrentNode;
+#ifdef SYMTABLE_CONCURRENT
+    struct SymTableReader *psReader;
+    struct SymTableNode **psFirstNode;
+    size_t uBucketCount;
+    size_t uSequence;
+    size_t uStripe;
+#endif
+
+    if (oSymTable->pucMapped != NULL) {
+        return SymTable_lookupMapped(oSymTable, pcKey, uLength, uHash,
+            ppvValue);
+    }
+    if (oSymTable->psFrozen != NULL) {
+        return SymTable_lookupFrozen(oSymTable, pcKey, uLength, uHash,
+            ppvValue);
+    }
+
+#ifdef SYMTABLE_CONCURRENT
+    psReader = SymTable_enterRead();
+    if (psReader == NULL) {
+        uStripe = SymTable_lockBucket(oSymTable, uHash, 0);
+        psCurrentNode = *SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+        if (psCurrentNode != NULL) {
+            *ppvValue = (void *) psCurrentNode->pvValue;
+        }
+        SymTable_unlockStripe(oSymTable, uStripe);
+        return psCurrentNode != NULL;
+    }
+
+    for (;;)
+    {
+        uSequence = SYMTABLE_LOAD(oSymTable->uSequence);
+        if ((uSequence & 1) != 0) {
+            sched_yield();
+            continue;
+        }
+
+        uBucketCount = SYMTABLE_LOAD(oSymTable->uBucketCount);
+        psFirstNode = SYMTABLE_LOAD(oSymTable->psFirstNode);
+        for (psCurrentNode = SYMTABLE_LOAD(psFirstNode[SymTable_reduce(
+        oSymTable, uHash, uBucketCount)]); psCurrentNode != NULL;
+        psCurrentNode = SYMTABLE_LOAD(psCurrentNode->psNextNode))
+        {
+            if (SymTable_matches(psCurrentNode, pcKey, uLength, uHash)) {
+                *ppvValue = (void *) SYMTABLE_LOAD(psCurrentNode->pvValue);
+                SymTable_exitRead(psReader);
+                return 1;
+            }
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&oSymTable->uSequence, __ATOMIC_RELAXED) ==
+        uSequence) {
+            SymTable_exitRead(psReader);
+            return 0;
+        }
+    }
+#else
+    psCurrentNode = *SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+    if (psCurrentNode == NULL) {
+        return 0;
+    }
+    *ppvValue = (void *) psCurrentNode->pvValue;
+    return 1;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new binding to oSymTable consisting of key pcKey and value 
+pvValue and return 1 (TRUE) if oSymTable does not already contain a 
+binding with key pcKey. Otherwise, if either oSymTable contains such a 
+binding or insufficient memory is available, leave oSymTable unchanged 
+and return 0 (FALSE). */
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void 
+*pvValue) 
+{
+    size_t uLength;
+    size_t uHash;
+    size_t uStripe;
+    int iSuccessful;
+
+    assert (oSymTable != NULL);
+    assert (pcKey != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hash(oSymTable, pcKey, &uLength);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    iSuccessful = SymTable_putHashed(oSymTable, pcKey, uLength, uHash,
+        pvValue);
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    SymTable_checkGrow(oSymTable);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, replace the binding's
+value with pvValue and return the old value. Otherwise leave oSymTable 
+unchanged and return NULL. */
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const 
+void *pvValue) 
+{
+    struct SymTableNode *psCurrentNode;
+    size_t uLength;
+    size_t uHash;
+    size_t uStripe;
+    void *oldval = NULL;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hash(oSymTable, pcKey, &uLength);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    psCurrentNode = *SymTable_findLink(oSymTable, pcKey, uLength, uHash);
+    if (psCurrentNode != NULL) {
+        oldval = (void *) psCurrentNode->pvValue;
+        SYMTABLE_STORE(psCurrentNode->pvValue, pvValue);
+    }
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey, 
+or 0 (FALSE) if otherwise. */
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uLength;
+    size_t uHash;
+    void *pvValue;
+
+    assert(oSymTable != NULL);
+    assert (pcKey != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hash(oSymTable, pcKey, &uLength);
+
+    return SymTable_lookup(oSymTable, pcKey, uLength, uHash, &pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is pcKey, 
+or NULL if no such binding exists. */
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uLength;
+    size_t uHash;
+    void *pvValue = NULL;
+
+    assert(oSymTable != NULL);
+    assert (pcKey != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hash(oSymTable, pcKey, &uLength);
+
+    (void)SymTable_lookup(oSymTable, pcKey, uLength, uHash, &pvValue);
+    return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, remove that binding 
+from oSymTable and return the binding's value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uLength;
+    size_t uHash;
+    size_t uStripe;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hash(oSymTable, pcKey, &uLength);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    oldval = SymTable_removeHashed(oSymTable, pcKey, uLength, uHash);
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a SymTable_Key for the uLength characters at pcKey, hashed
+with eHash. */
+
+SymTable_Key SymTable_makeKey(enum SymTableHash eHash, const char *pcKey,
+    size_t uLength)
+{
+    SymTable_Key sKey;
+
+    assert(pcKey != NULL);
+    assert(memchr(pcKey, '\0', uLength) == NULL);
+
+    sKey.pcKey = pcKey;
+    sKey.uLength = uLength;
+    sKey.eHash = eHash;
+    sKey.uHash = SymTable_hashKey(eHash, pcKey, uLength);
+    return sKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new binding to oSymTable consisting of key *psKey and value
+pvValue, as SymTable_put does. */
+
+int SymTable_putK(SymTable_T oSymTable, const SymTable_Key *psKey,
+    const void *pvValue)
+{
+    size_t uHash;
+    size_t uStripe;
+    int iSuccessful;
+
+    assert(oSymTable != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_keyHash(oSymTable, psKey);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    iSuccessful = SymTable_putHashed(oSymTable, psKey->pcKey,
+        psKey->uLength, uHash, pvValue);
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    SymTable_checkGrow(oSymTable);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is *psKey,
+or 0 (FALSE) if otherwise. */
+
+int SymTable_containsK(SymTable_T oSymTable, const SymTable_Key *psKey)
+{
+    size_t uHash;
+    void *pvValue;
+
+    assert(oSymTable != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_keyHash(oSymTable, psKey);
+
+    return SymTable_lookup(oSymTable, psKey->pcKey, psKey->uLength, uHash,
+        &pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is *psKey,
+or NULL if no such binding exists. */
+
+void *SymTable_getK(SymTable_T oSymTable, const SymTable_Key *psKey)
+{
+    size_t uHash;
+    void *pvValue = NULL;
+
+    assert(oSymTable != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_keyHash(oSymTable, psKey);
+
+    (void)SymTable_lookup(oSymTable, psKey->pcKey, psKey->uLength, uHash,
+        &pvValue);
+    return pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key *psKey, remove that binding
+from oSymTable and return the binding's value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_removeK(SymTable_T oSymTable, const SymTable_Key *psKey)
+{
+    size_t uHash;
+    size_t uStripe;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_keyHash(oSymTable, psKey);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    oldval = SymTable_removeHashed(oSymTable, psKey->pcKey, psKey->uLength,
+        uHash);
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Walk the uGroup chains that start at apsNodes in rounds, one node
+per unfinished chain per round, prefetching each next node, for the
+keys at ppcKeys, whose lengths and hash codes are at auLength and
+auHash. A chain may be NULL. For each key i found, set aiFound[i] to 1
+(TRUE) and store its value in apvValues[i]. Return the number of keys
+found. */
+
+static size_t SymTable_walkChains(const char *const *ppcKeys,
+    const size_t *auLength, const size_t *auHash,
+    struct SymTableNode **apsNodes, size_t uGroup, void **apvValues,
+    int *aiFound)
+{
+    struct SymTableNode *psCurrentNode;
+    size_t uFoundCount = 0;
+    size_t uActive;
+    size_t u;
+
+    do {
+        uActive = 0;
+        for (u = 0; u < uGroup; u++)
+        {
+            psCurrentNode = apsNodes[u];
+            if (psCurrentNode == NULL) {
+                continue;
+            }
+            if (SymTable_matches(psCurrentNode, ppcKeys[u], auLength[u],
+            auHash[u])) {
+                apvValues[u] = (void *) SYMTABLE_LOAD(
+                    psCurrentNode->pvValue);
+                aiFound[u] = 1;
+                uFoundCount++;
+                apsNodes[u] = NULL;
+                continue;
+            }
+            apsNodes[u] = SYMTABLE_LOAD(psCurrentNode->psNextNode);
+            if (apsNodes[u] != NULL) {
+                SYMTABLE_PREFETCH(apsNodes[u]);
+                uActive++;
+            }
+        }
+    } while (uActive > 0);
+
+    return uFoundCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up the uCount keys at ppcKeys in oSymTable. For each key i,
+store the value of its binding, or NULL, in ppvValues[i] if ppvValues
+is not NULL, and 1 (TRUE) or 0 (FALSE) in piFound[i] if piFound is not
+NULL. Return the number of keys found.
+
+The keys are handled in groups of BATCH_GROUP. All keys of a group are
+hashed and their buckets prefetched before any bucket is read, and then
+the chains are walked in rounds by SymTable_walkChains. The cache
+misses of a whole group thus overlap instead of following one another.
+
+The concurrent build takes no lock, as SymTable_lookup does not: each
+group is looked up within one read section, and its misses are looked
+up again if uSequence shows that a rehash overlapped the walk. */
+
+static size_t SymTable_lookupBatch(SymTable_T oSymTable,
+    const char *const *ppcKeys, size_t uCount, void **ppvValues,
+    int *piFound)
+{
+    enum {BATCH_GROUP = 16};
+
+    struct SymTableNode *apsNodes[BATCH_GROUP];
+    void *apvValues[BATCH_GROUP];
+    int aiFound[BATCH_GROUP];
+    size_t auHash[BATCH_GROUP];
+    size_t auLength[BATCH_GROUP];
+#ifdef SYMTABLE_CONCURRENT
+    struct SymTableReader *psReader;
+    struct SymTableNode **psFirstNode;
+    size_t auBuckets[BATCH_GROUP];
+    size_t uBucketCount;
+    size_t uSequence;
+#else
+    struct SymTableNode **appsBuckets[BATCH_GROUP];
+#endif
+    size_t uFoundCount = 0;
+    size_t uStart;
+    size_t uGroup;
+    size_t u;
+    int iWalkBuckets;
+
+    assert(oSymTable != NULL);
+    assert(ppcKeys != NULL || uCount == 0);
+
+    SymTable_growStep(oSymTable);
+
+    for (uStart = 0; uStart < uCount; uStart += uGroup)
+    {
+        uGroup = uCount - uStart;
+        if (uGroup > BATCH_GROUP) {
+            uGroup = BATCH_GROUP;
+        }
+
+        for (u = 0; u < uGroup; u++)
+        {
+            assert(ppcKeys[uStart + u] != NULL);
+            auHash[u] = SymTable_hash(oSymTable, ppcKeys[uStart + u],
+                &auLength[u]);
+            apvValues[u] = NULL;
+            aiFound[u] = 0;
+        }
+
+        /* A read-only table, or a thread that cannot get a read
+        section, looks the keys up one at a time instead: in the
+        mapping or the frozen table, or under their stripes. */
+        iWalkBuckets = ! SymTable_isReadOnly(oSymTable);
+#ifdef SYMTABLE_CONCURRENT
+        if (iWalkBuckets) {
+            psReader = SymTable_enterRead();
+            iWalkBuckets = psReader != NULL;
+        }
+#endif
+        if (! iWalkBuckets) {
+            for (u = 0; u < uGroup; u++)
+            {
+                aiFound[u] = SymTable_lookup(oSymTable, ppcKeys[uStart + u],
+                    auLength[u], auHash[u], &apvValues[u]);
+                uFoundCount += (size_t)aiFound[u];
+            }
+        }
+        else {
+#ifdef SYMTABLE_CONCURRENT
+            for (;;)
+            {
+                uSequence = SYMTABLE_LOAD(oSymTable->uSequence);
+                if ((uSequence & 1) != 0) {
+                    sched_yield();
+                    continue;
+                }
+
+                uBucketCount = SYMTABLE_LOAD(oSymTable->uBucketCount);
+                psFirstNode = SYMTABLE_LOAD(oSymTable->psFirstNode);
+                for (u = 0; u < uGroup; u++)
+                {
+                    auBuckets[u] = SymTable_reduce(oSymTable, auHash[u],
+                        uBucketCount);
+                    SYMTABLE_PREFETCH(&psFirstNode[auBuckets[u]]);
+                }
+                for (u = 0; u < uGroup; u++)
+                {
+                    apsNodes[u] = NULL;
+                    if (! aiFound[u]) {
+                        apsNodes[u] = SYMTABLE_LOAD(
+                            psFirstNode[auBuckets[u]]);
+                        SYMTABLE_PREFETCH(apsNodes[u]);
+                    }
+                }
+                uFoundCount += SymTable_walkChains(ppcKeys + uStart,
+                    auLength, auHash, apsNodes, uGroup, apvValues,
+                    aiFound);
+
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&oSymTable->uSequence,
+                __ATOMIC_RELAXED) == uSequence) {
+                    break;
+                }
+            }
+            SymTable_exitRead(psReader);
+#else
+            for (u = 0; u < uGroup; u++)
+            {
+                appsBuckets[u] = SymTable_bucket(oSymTable, auHash[u]);
+                SYMTABLE_PREFETCH(appsBuckets[u]);
+            }
+            for (u = 0; u < uGroup; u++)
+            {
+                apsNodes[u] = *appsBuckets[u];
+                SYMTABLE_PREFETCH(apsNodes[u]);
+            }
+            uFoundCount += SymTable_walkChains(ppcKeys + uStart, auLength,
+                auHash, apsNodes, uGroup, apvValues, aiFound);
+#endif
+        }
+
+        for (u = 0; u < uGroup; u++)
+        {
+            if (ppvValues != NULL) {
+                ppvValues[uStart + u] = apvValues[u];
+            }
+            if (piFound != NULL) {
+                piFound[uStart + u] = aiFound[u];
+            }
+        }
+    }
+
+    return uFoundCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* For each i below uCount, store in ppvValues[i] the value of the
+binding within oSymTable whose key is ppcKeys[i], or NULL if no such
+binding exists. Return the number of keys found. */
+
+size_t SymTable_getBatch(SymTable_T oSymTable, const char *const *ppcKeys,
+    size_t uCount, void **ppvValues)
+{
+    assert(ppvValues != NULL || uCount == 0);
+
+    return SymTable_lookupBatch(oSymTable, ppcKeys, uCount, ppvValues,
+        NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* For each i below uCount, store in piFound[i] 1 (TRUE) if oSymTable
+contains a binding whose key is ppcKeys[i], or 0 (FALSE) if otherwise.
+Return the number of keys found. */
+
+size_t SymTable_containsBatch(SymTable_T oSymTable,
+    const char *const *ppcKeys, size_t uCount, int *piFound)
+{
+    assert(piFound != NULL || uCount == 0);
+
+    return SymTable_lookupBatch(oSymTable, ppcKeys, uCount, NULL,
+        piFound);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the value of the binding within oSymTable whose
+key is pcKey, adding a binding of pcKey to NULL first if there is none,
+and set *piInserted to 1 (TRUE) if the binding was added or 0 (FALSE)
+if it was already there. Return NULL, leaving oSymTable unchanged and
+*piInserted 0, if insufficient memory is available. The address stays
+valid until the binding is removed, oSymTable is frozen, or oSymTable
+is freed; in the concurrent build, the caller must see to it that no
+other thread removes the binding while the address is in use. */
+
+void **SymTable_upsert(SymTable_T oSymTable, const char *pcKey,
+    int *piInserted)
+{
+    size_t uLength;
+    size_t uHash;
+    size_t uStripe;
+    void **ppvSlot;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+    assert(piInserted != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hash(oSymTable, pcKey, &uLength);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    ppvSlot = SymTable_slotHashed(oSymTable, pcKey, uLength, uHash, NULL,
+        piInserted);
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    SymTable_checkGrow(oSymTable);
+    return ppvSlot;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the value of the binding within oSymTable whose
+key is pcKey, adding a binding of pcKey to pvValue first if there is
+none. Return NULL, leaving oSymTable unchanged, if insufficient memory
+is available. The address stays valid until the binding is removed,
+oSymTable is frozen, or oSymTable is freed, as for SymTable_upsert. */
+
+void **SymTable_getOrInsert(SymTable_T oSymTable, const char *pcKey,
+    const void *pvValue)
+{
+    size_t uLength;
+    size_t uHash;
+    size_t uStripe;
+    void **ppvSlot;
+    int iInserted;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hash(oSymTable, pcKey, &uLength);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    ppvSlot = SymTable_slotHashed(oSymTable, pcKey, uLength, uHash, pvValue,
+        &iInserted);
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    SymTable_checkGrow(oSymTable);
+    return ppvSlot;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* One key of a SymTable_putBatch call: its position in the batch, its
+length and hash code, and the bucket that it goes into. */
+
+struct SymTableBatchEntry
+{
+    size_t uIndex;
+    size_t uLength;
+    size_t uHash;
+    size_t uBucket;
+};
+
+/* SymTable_putBatch divides the buckets into BATCH_RANGE_COUNT ranges of
+consecutive buckets and inserts the keys one range at a time. */
+
+enum {BATCH_RANGE_COUNT = 1024};
+
+/*--------------------------------------------------------------------*/
+
+/* Add to oSymTable the bindings of a SymTable_putBatch call, as
+SymTable_putBatch does. The caller must hold every stripe for writing. */
+
+static int SymTable_putBatchLocked(SymTable_T oSymTable,
+    const char *const *ppcKeys, const void *const *ppvValues,
+    size_t uCount, int *piInserted)
+{
+    size_t auRangeStarts[BATCH_RANGE_COUNT + 1];
+    struct SymTableBatchEntry *psEntries;
+    struct SymTableBatchEntry *psSorted;
+    struct SymTableBatchEntry *psEntry;
+    struct SymTableNode **ppsLink;
+    struct SymTableNode *psNewNode;
+    struct SymTableSlab *psBlock;
+    size_t uBucketCount;
+    size_t uRangeSize;
+    size_t uNodeSize;
+    size_t uBlockSize = 0;
+    size_t u;
+    int iSuccessful = 1;
+
+    assert(oSymTable != NULL);
+    assert((ppcKeys != NULL && ppvValues != NULL) || uCount == 0);
+
+    if (SymTable_isReadOnly(oSymTable)) {
+        return 0;
+    }
+
+    if (piInserted != NULL) {
+        for (u = 0; u < uCount; u++)
+        {
+            piInserted[u] = 0;
+        }
+    }
+
+    if (uCount == 0) {
+        return 1;
+    }
+
+    if (uCount > ((size_t)-1) / 2 / sizeof(struct SymTableBatchEntry) ||
+    uCount > ((size_t)-1) - oSymTable->length) {
+        return 0;
+    }
+
+    /* Size the buckets once for the whole batch. */
+    if (! SymTable_reserveBuckets(oSymTable, oSymTable->length + uCount)) {
+        return 0;
+    }
+    uBucketCount = oSymTable->uBucketCount;
+
+    psEntries = (struct SymTableBatchEntry*)malloc(
+        2 * uCount * sizeof(struct SymTableBatchEntry));
+    if (psEntries == NULL) {
+        return 0;
+    }
+    psSorted = psEntries + uCount;
+
+    uRangeSize = (uBucketCount + BATCH_RANGE_COUNT - 1) / BATCH_RANGE_COUNT;
+    for (u = 0; u <= BATCH_RANGE_COUNT; u++)
+    {
+        auRangeStarts[u] = 0;
+    }
+
+    for (u = 0; u < uCount; u++)
+    {
+        assert(ppcKeys[u] != NULL);
+        psEntry = &psEntries[u];
+        psEntry->uIndex = u;
+        psEntry->uHash = SymTable_hash(oSymTable, ppcKeys[u],
+            &psEntry->uLength);
+        psEntry->uBucket = SymTable_reduce(oSymTable, psEntry->uHash,
+            uBucketCount);
+        auRangeStarts[psEntry->uBucket / uRangeSize + 1]++;
+        uNodeSize = SymTable_nodeSize(oSymTable, psEntry->uLength);
+        if (uNodeSize <= SLAB_MAX_NODE_SIZE) {
+            uBlockSize += uNodeSize;
+        }
+    }
+
+    for (u = 1; u <= BATCH_RANGE_COUNT; u++)
+    {
+        auRangeStarts[u] += auRangeStarts[u - 1];
+    }
+    for (u = 0; u < uCount; u++)
+    {
+        psSorted[auRangeStarts[psEntries[u].uBucket / uRangeSize]++] =
+            psEntries[u];
+    }
+
+    /* Carve the nodes from the current slab if they fit, and otherwise
+    from a block of their own that becomes the current slab. */
+    if (uBlockSize > oSymTable->uSlabLeft) {
+        psBlock = (struct SymTableSlab*)malloc(SLAB_ALIGN + uBlockSize);
+        if (psBlock == NULL) {
+            free(psEntries);
+            return 0;
+        }
+        psBlock->psNextSlab = oSymTable->psSlabs;
+        oSymTable->psSlabs = psBlock;
+        oSymTable->pcSlabFree = (char *)psBlock + SLAB_ALIGN;
+        oSymTable->uSlabLeft = uBlockSize;
+    }
+
+    for (u = 0; u < uCount; u++)
+    {
+        psEntry = &psSorted[u];
+        ppsLink = SymTable_findLink(oSymTable, ppcKeys[psEntry->uIndex],
+            psEntry->uLength, psEntry->uHash);
+        if (*ppsLink != NULL) {
+            continue;
+        }
+
+        uNodeSize = SymTable_nodeSize(oSymTable, psEntry->uLength);
+        if (uNodeSize > SLAB_MAX_NODE_SIZE) {
+            psNewNode = SymTable_newNode(oSymTable,
+                ppcKeys[psEntry->uIndex], psEntry->uLength);
+        }
+        else {
+            psNewNode = SymTable_carveNode(oSymTable, uNodeSize);
+            if (! SymTable_setKey(oSymTable, psNewNode,
+            ppcKeys[psEntry->uIndex], psEntry->uLength)) {
+                psNewNode->psNextNode =
+                    oSymTable->apsFreeNodes[uNodeSize / SLAB_ALIGN - 1];
+                oSymTable->apsFreeNodes[uNodeSize / SLAB_ALIGN - 1] =
+                    psNewNode;
+                psNewNode = NULL;
+            }
+        }
+
+        if (psNewNode == NULL) {
+            iSuccessful = 0;
+            continue;
+        }
+
+        SymTable_linkNode(oSymTable, ppsLink, psNewNode, psEntry->uHash,
+            ppvValues[psEntry->uIndex]);
+        if (piInserted != NULL) {
+            piInserted[psEntry->uIndex] = 1;
+        }
+    }
+
+    free(psEntries);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add to oSymTable a binding of ppcKeys[i] to ppvValues[i] for each i
+below uCount for which neither oSymTable nor an earlier key of the batch
+already has the key, and, if piInserted is not NULL, set piInserted[i]
+to whether that binding was added. Return 1 (TRUE), or 0 (FALSE) if
+insufficient memory is available, in which case piInserted still tells
+which bindings were added.
+
+The buckets are sized for the whole batch before anything is inserted,
+so the table does not expand while the batch goes in. The keys are then
+sorted by bucket range with one counting pass, which keeps each range
+in batch order, and inserted range by range, with their nodes carved
+one after another from a single block. The buckets that the inserts
+touch at any moment thus fit in the cache, and the nodes of neighbouring
+buckets are neighbours in memory. */
+
+int SymTable_putBatch(SymTable_T oSymTable, const char *const *ppcKeys,
+    const void *const *ppvValues, size_t uCount, int *piInserted)
+{
+    int iSuccessful;
+
+    assert(oSymTable != NULL);
+
+    SymTable_lockAll(oSymTable, 1);
+    iSuccessful = SymTable_putBatchLocked(oSymTable, ppcKeys, ppvValues,
+        uCount, piInserted);
+    SymTable_unlockAll(oSymTable);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give the slabs and free nodes of oSource, and its count of large
+nodes, to oDest, so that the nodes of oSource can move into oDest. The
+slabs of oSource go after the current slab of oDest, which keeps
+carving from where it was. */
+
+static void SymTable_adoptStorage(SymTable_T oDest, SymTable_T oSource)
+{
+    struct SymTableSlab *psLastSlab;
+    struct SymTableNode *psLastNode;
+    size_t u;
+
+    SymTable_lockAlloc(oDest);
+
+    if (oSource->psSlabs != NULL) {
+        for (psLastSlab = oSource->psSlabs; psLastSlab->psNextSlab != NULL;
+        psLastSlab = psLastSlab->psNextSlab)
+        {
+        }
+        if (oDest->psSlabs == NULL) {
+            oDest->psSlabs = oSource->psSlabs;
+            oDest->pcSlabFree = oSource->pcSlabFree;
+            oDest->uSlabLeft = oSource->uSlabLeft;
+        }
+        else {
+            psLastSlab->psNextSlab = oDest->psSlabs->psNextSlab;
+            oDest->psSlabs->psNextSlab = oSource->psSlabs;
+        }
+    }
+
+    for (u = 0; u < SLAB_CLASS_COUNT; u++)
+    {
+        if (oSource->apsFreeNodes[u] == NULL) {
+            continue;
+        }
+        for (psLastNode = oSource->apsFreeNodes[u];
+        psLastNode->psNextNode != NULL; psLastNode = psLastNode->psNextNode)
+        {
+        }
+        psLastNode->psNextNode = oDest->apsFreeNodes[u];
+        oDest->apsFreeNodes[u] = oSource->apsFreeNodes[u];
+        oSource->apsFreeNodes[u] = NULL;
+    }
+
+    oDest->uLargeNodeCount += oSource->uLargeNodeCount;
+    SymTable_unlockAlloc(oDest);
+
+    oSource->psSlabs = NULL;
+    oSource->pcSlabFree = NULL;
+    oSource->uSlabLeft = 0;
+    oSource->uLargeNodeCount = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the nodes of the uBucketCount buckets at psBuckets, which
+belong to a table whose storage oDest has adopted, into oDest, and
+leave the buckets empty. If iDisjoint is TRUE the keys are known not to
+be in oDest, so each node is pushed onto its bucket; otherwise each key
+is looked up and, if oDest already has it, combined by pfCombine and
+pvExtra as SymTable_merge does. oDest must already have buckets enough
+for the nodes. */
+
+static void SymTable_absorbBuckets(SymTable_T oDest,
+    struct SymTableNode **psBuckets, size_t uBucketCount, int iDisjoint,
+    void *(*pfCombine)(const char *pcKey, void *pvDestValue,
+    void *pvSourceValue, void *pvExtra), const void *pvExtra)
+{
+    struct SymTableNode **ppsLink;
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode *psNextNode;
+    size_t i;
+
+    for (i = 0; i < uBucketCount; i++)
+    {
+        psCurrentNode = psBuckets[i];
+        psBuckets[i] = NULL;
+        if (psCurrentNode == NULL) {
+            continue;
+        }
+
+        for (; psCurrentNode != NULL; psCurrentNode = psNextNode)
+        {
+            psNextNode = psCurrentNode->psNextNode;
+
+            if (iDisjoint) {
+                ppsLink = SymTable_bucket(oDest, psCurrentNode->uHash);
+                psCurrentNode->psNextNode = *ppsLink;
+                SYMTABLE_STORE(*ppsLink, psCurrentNode);
+                SYMTABLE_ADD(oDest->length, 1);
+                continue;
+            }
+
+            ppsLink = SymTable_findLink(oDest, psCurrentNode->pcKey,
+                psCurrentNode->uLength, psCurrentNode->uHash);
+            if (*ppsLink == NULL) {
+                SymTable_linkNode(oDest, ppsLink, psCurrentNode,
+                    psCurrentNode->uHash, psCurrentNode->pvValue);
+                continue;
+            }
+
+            if (pfCombine != NULL) {
+                SYMTABLE_STORE((*ppsLink)->pvValue, (*pfCombine)(
+                    (*ppsLink)->pcKey, (void *) (*ppsLink)->pvValue,
+                    (void *) psCurrentNode->pvValue, (void *) pvExtra));
+            }
+            if (oDest->oPool != NULL) {
+                SymTablePool_release(oDest->oPool, psCurrentNode->pcKey);
+            }
+            SymTable_freeNode(oDest, psCurrentNode);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if the bindings of oSource can move into oDest:
+both tables use the same pool and hash function, neither is read-only,
+and oSource, which the move frees, has no live iterators. Return 0
+(FALSE) otherwise. */
+
+static int SymTable_canAbsorb(SymTable_T oDest, SymTable_T oSource)
+{
+    return oDest->oPool == oSource->oPool &&
+        oDest->eHash == oSource->eHash &&
+        ! SymTable_isReadOnly(oDest) && ! SymTable_isReadOnly(oSource) &&
+        oSource->psIters == NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSource into oDest, as SymTable_merge does,
+without looking the keys up in oDest if iDisjoint is TRUE, and free
+oSource. The caller must hold every stripe of oDest for writing. */
+
+static int SymTable_absorb(SymTable_T oDest, SymTable_T oSource,
+    int iDisjoint, void *(*pfCombine)(const char *pcKey,
+    void *pvDestValue, void *pvSourceValue, void *pvExtra),
+    const void *pvExtra)
+{
+    if (! SymTable_canAbsorb(oDest, oSource)) {
+        return 0;
+    }
+    if (oSource->length > ((size_t)-1) - oDest->length ||
+    ! SymTable_reserveBuckets(oDest, oDest->length + oSource->length)) {
+        return 0;
+    }
+
+#ifdef SYMTABLE_CONCURRENT
+    SymTable_disposeRetired(oSource);
+#endif
+    SymTable_adoptStorage(oDest, oSource);
+
+    SymTable_absorbBuckets(oDest, oSource->psFirstNode,
+        oSource->uBucketCount, iDisjoint, pfCombine, pvExtra);
+    if (oSource->psGrowNode != NULL) {
+        SymTable_absorbBuckets(oDest, oSource->psGrowNode,
+            oSource->uGrowBucketCount, iDisjoint, pfCombine, pvExtra);
+    }
+
+    oSource->length = 0;
+    SymTable_free(oSource);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSource into oDest and free oSource, returning
+1 (TRUE). Where both tables have a key, oDest keeps its binding, with
+its value replaced by (*pfCombine)(pcKey, pvDestValue, pvSourceValue,
+pvExtra) if pfCombine is not NULL. If the tables use different pools or
+hash functions, either is read-only, oSource has live iterators, or
+insufficient memory is available, leave both unchanged and return 0
+(FALSE). */
+
+int SymTable_merge(SymTable_T oDest, SymTable_T oSource,
+    void *(*pfCombine)(const char *pcKey, void *pvDestValue,
+    void *pvSourceValue, void *pvExtra), const void *pvExtra)
+{
+    int iSuccessful;
+
+    assert(oDest != NULL);
+    assert(oSource != NULL);
+    assert(oDest != oSource);
+
+    SymTable_lockAll(oDest, 1);
+    iSuccessful = SymTable_absorb(oDest, oSource, 0, pfCombine, pvExtra);
+    SymTable_unlockAll(oDest);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableShards is an array of shards, the SymTable objects that
+hold the keys whose hash codes have each value of the top uShardBits
+bits. */
+
+struct SymTableShards
+{
+    /* The shards, indexed by the top bits of their keys' hash codes. */
+    SymTable_T *aoShards;
+
+    /* The number of shards, 1 << uShardBits. */
+    size_t uShardCount;
+    unsigned int uShardBits;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTableShards object of uShardCount empty shards,
+which must be a power of two, sized together for uCapacity bindings.
+Return NULL if insufficient memory is available. */
+
+SymTableShards_T SymTableShards_new(size_t uShardCount, size_t uCapacity)
+{
+    SymTableShards_T oShards;
+    size_t u;
+
+    assert(uShardCount > 0);
+    assert((uShardCount & (uShardCount - 1)) == 0);
+
+    oShards = (SymTableShards_T)calloc(1, sizeof(struct SymTableShards));
+    if (oShards == NULL) {
+        return NULL;
+    }
+
+    oShards->aoShards = (SymTable_T *)calloc(uShardCount,
+        sizeof(SymTable_T));
+    if (oShards->aoShards == NULL) {
+        free(oShards);
+        return NULL;
+    }
+    oShards->uShardCount = uShardCount;
+    while (((size_t)1 << oShards->uShardBits) < uShardCount) {
+        oShards->uShardBits++;
+    }
+
+    for (u = 0; u < uShardCount; u++)
+    {
+        oShards->aoShards[u] = SymTable_newWithCapacity(
+            uCapacity / uShardCount);
+        if (oShards->aoShards[u] == NULL ||
+        ! SymTable_setHash(oShards->aoShards[u], SYMTABLE_HASH_WORDS)) {
+            SymTableShards_free(oShards);
+            return NULL;
+        }
+    }
+
+    return oShards;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free oShards and all of its shards. */
+
+void SymTableShards_free(SymTableShards_T oShards)
+{
+    size_t u;
+
+    assert(oShards != NULL);
+
+    for (u = 0; u < oShards->uShardCount; u++)
+    {
+        if (oShards->aoShards[u] != NULL) {
+            SymTable_free(oShards->aoShards[u]);
+        }
+    }
+    free(oShards->aoShards);
+    free(oShards);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of shards of oShards. */
+
+size_t SymTableShards_getCount(SymTableShards_T oShards)
+{
+    assert(oShards != NULL);
+
+    return oShards->uShardCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the shard of oShards that key pcKey belongs in:
+the top bits of its SYMTABLE_HASH_WORDS hash code. A table with that
+hash picks the bucket by masking the low bits, so the keys of each
+shard still spread over all of its buckets. */
+
+size_t SymTableShards_route(SymTableShards_T oShards, const char *pcKey)
+{
+    size_t uHash;
+
+    assert(oShards != NULL);
+    assert(pcKey != NULL);
+
+    if (oShards->uShardBits == 0) {
+        return 0;
+    }
+
+    uHash = SymTable_hashKey(SYMTABLE_HASH_WORDS, pcKey, strlen(pcKey));
+    return uHash >> (sizeof(size_t) * CHAR_BIT - oShards->uShardBits);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return shard uShard of oShards. */
+
+SymTable_T SymTableShards_shard(SymTableShards_T oShards, size_t uShard)
+{
+    assert(oShards != NULL);
+    assert(uShard < oShards->uShardCount);
+
+    return oShards->aoShards[uShard];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge the shards of oShards, in order, into one new SymTable object,
+free oShards, and return the table. Return NULL, leaving oShards
+unchanged, if a shard was frozen, was given another hash function or
+has live iterators, or if insufficient memory is available. The table
+is sized for all the shards and every shard is checked before any
+moves, so once the first shard moves the rest cannot fail. Since no key
+is in two shards, each node is relinked on its own by its cached hash
+code, without being looked up. */
+
+SymTable_T SymTableShards_merge(SymTableShards_T oShards)
+{
+    SymTable_T oSymTable;
+    size_t uLength = 0;
+    size_t u;
+    int iAbsorbed;
+
+    assert(oShards != NULL);
+
+    for (u = 0; u < oShards->uShardCount; u++)
+    {
+        uLength += SymTable_getLength(oShards->aoShards[u]);
+    }
+
+    oSymTable = SymTable_newWithCapacity(uLength);
+    if (oSymTable == NULL) {
+        return NULL;
+    }
+    if (! SymTable_setHash(oSymTable, SYMTABLE_HASH_WORDS)) {
+        SymTable_free(oSymTable);
+        return NULL;
+    }
+
+    for (u = 0; u < oShards->uShardCount; u++)
+    {
+        if (! SymTable_canAbsorb(oSymTable, oShards->aoShards[u])) {
+            SymTable_free(oSymTable);
+            return NULL;
+        }
+    }
+
+    /* The buckets are already sized for every shard, so absorbing
+    cannot fail now. */
+    for (u = 0; u < oShards->uShardCount; u++)
+    {
+        iAbsorbed = SymTable_absorb(oSymTable, oShards->aoShards[u], 1,
+            NULL, NULL);
+        assert(iAbsorbed);
+        (void)iAbsorbed;
+        oShards->aoShards[u] = NULL;
+    }
+
+    SymTableShards_free(oShards);
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable, passing pvExtra
+as an extra argument. That is, for each element pcKey and its value 
+pvValue of oSymTable, call (*pfApply) (pcKey, pvValue, pvExtra). In the
+concurrent build *pfApply runs with every stripe held for reading, so it
+must not change oSymTable. */
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char 
+*pcKey, void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    struct SymTableNode *psCurrentNode;
+    size_t i;
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);    
+
+    if (oSymTable->pucMapped != NULL) {
+        SymTable_mapMapped(oSymTable, pfApply, pvExtra);
+        return;
+    }
+    if (oSymTable->psFrozen != NULL) {
+        SymTable_mapFrozen(oSymTable, pfApply, pvExtra);
+        return;
+    }
+
+    SymTable_lockAll(oSymTable, 0);
+
+    for (i = 0; i < oSymTable->uBucketCount; i++) 
+    {
+        for (psCurrentNode = oSymTable->psFirstNode[i]; psCurrentNode != NULL; 
+        psCurrentNode = psCurrentNode->psNextNode) 
+        {
+            (*pfApply) (psCurrentNode->pcKey, (void*) psCurrentNode->pvValue, (void*) pvExtra);
+        }
+    }   
+
+    if (oSymTable->psGrowNode != NULL) {
+        for (i = 0; i < oSymTable->uGrowBucketCount; i++) 
+        {
+            for (psCurrentNode = oSymTable->psGrowNode[i];
+            psCurrentNode != NULL; psCurrentNode = psCurrentNode->psNextNode) 
+            {
+                (*pfApply) (psCurrentNode->pcKey, (void*) psCurrentNode->pvValue, (void*) pvExtra);
+            }
+        }
+    }
+
+    SymTable_unlockAll(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_mapParallel splits the buckets into chunks of consecutive
+buckets, and gives each worker an even share of the chunks. A
+SymTableMapShare is the share of one worker: the next chunk that
+nobody has claimed yet, and the chunk after the last. Workers claim
+chunks from their own share first and then from the others', so a
+worker that drew long chains is helped by those that finished. Shares
+are padded so that the counters of different workers do not share a
+cache line. */
+
+struct SymTableMapShare
+{
+    size_t uNextChunk;
+    size_t uEndChunk;
+    char acPadding[128];
+};
+
+/* A SymTableMapJob is what the workers of a SymTable_mapParallel call
+share. */
+
+struct SymTableMapJob
+{
+    SymTable_T oSymTable;
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra);
+    void *const *ppvExtras;
+    struct SymTableMapShare *psShares;
+    size_t uWorkerCount;
+    size_t uChunkSize;
+};
+
+/* A SymTableMapWorker is one worker of a SymTable_mapParallel call:
+its job, its index, and its thread. */
+
+struct SymTableMapWorker
+{
+    struct SymTableMapJob *psJob;
+    size_t uWorker;
+    pthread_t oThread;
+};
+
+/* SymTable_mapParallel cuts the buckets into about this many chunks
+per worker, so that stealing can even out uneven chains. */
+
+enum {MAP_CHUNKS_PER_WORKER = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of psJob to each binding of buckets uStart to
+uEnd-1 of its table, counting the buckets of psFirstNode before those
+of psGrowNode, passing pvExtra as the extra argument. */
+
+static void SymTable_mapBuckets(struct SymTableMapJob *psJob,
+    size_t uStart, size_t uEnd, void *pvExtra)
+{
+    SymTable_T oSymTable = psJob->oSymTable;
+    struct SymTableNode *psCurrentNode;
+    size_t i;
+
+    for (i = uStart; i < uEnd; i++)
+    {
+        psCurrentNode = i < oSymTable->uBucketCount ?
+            oSymTable->psFirstNode[i] :
+            oSymTable->psGrowNode[i - oSymTable->uBucketCount];
+        for (; psCurrentNode != NULL;
+        psCurrentNode = psCurrentNode->psNextNode)
+        {
+            (*psJob->pfApply)(psCurrentNode->pcKey,
+                (void *) psCurrentNode->pvValue, pvExtra);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Run the worker at pvWorker: claim chunks from its own share, then
+from each other share in turn, until every chunk has been claimed.
+Return NULL. */
+
+static void *SymTable_runMapWorker(void *pvWorker)
+{
+    struct SymTableMapWorker *psWorker =
+        (struct SymTableMapWorker *)pvWorker;
+    struct SymTableMapJob *psJob = psWorker->psJob;
+    struct SymTableMapShare *psShare;
+    size_t uBucketTotal;
+    size_t uChunk;
+    size_t u;
+    void *pvExtra = NULL;
+
+    if (psJob->ppvExtras != NULL) {
+        pvExtra = psJob->ppvExtras[psWorker->uWorker];
+    }
+    uBucketTotal = psJob->oSymTable->uBucketCount +
+        psJob->oSymTable->uGrowBucketCount;
+
+    for (u = 0; u < psJob->uWorkerCount; u++)
+    {
+        psShare = &psJob->psShares[(psWorker->uWorker + u) %
+            psJob->uWorkerCount];
+        for (;;)
+        {
+            uChunk = __atomic_fetch_add(&psShare->uNextChunk, 1,
+                __ATOMIC_RELAXED);
+            if (uChunk >= psShare->uEndChunk) {
+                break;
+            }
+            SymTable_mapBuckets(psJob, uChunk * psJob->uChunkSize,
+                uChunk * psJob->uChunkSize + psJob->uChunkSize <
+                uBucketTotal ? uChunk * psJob->uChunkSize +
+                psJob->uChunkSize : uBucketTotal, pvExtra);
+        }
+    }
+
+    return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable from
+uThreadCount threads, as SymTable_map does, with the calling thread as
+worker 0. Worker i passes ppvExtras[i], or NULL if ppvExtras is NULL,
+as the extra argument. The buckets are split into chunks that the
+workers claim, each from its own share first and then from the others'
+shares. The calls run in no particular order, and different bindings
+concurrently. If a thread cannot be created or insufficient memory is
+available, the remaining workers, and at worst the calling thread
+alone, do all the work, as the calling thread does for a read-only
+table. */
+
+void SymTable_mapParallel(SymTable_T oSymTable, void (*pfApply)(const
+char *pcKey, void *pvValue, void *pvExtra), void *const *ppvExtras,
+    size_t uThreadCount)
+{
+    struct SymTableMapJob sJob;
+    struct SymTableMapShare *psShares;
+    struct SymTableMapWorker *psWorkers;
+    size_t uBucketTotal;
+    size_t uChunkCount;
+    int *piStarted;
+    size_t u;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+    assert(uThreadCount > 0);
+
+    if (SymTable_isReadOnly(oSymTable)) {
+        SymTable_map(oSymTable, pfApply,
+            ppvExtras == NULL ? NULL : ppvExtras[0]);
+        return;
+    }
+
+    psShares = (struct SymTableMapShare *)calloc(uThreadCount,
+        sizeof(struct SymTableMapShare));
+    psWorkers = (struct SymTableMapWorker *)calloc(uThreadCount,
+        sizeof(struct SymTableMapWorker));
+    piStarted = (int *)calloc(uThreadCount, sizeof(int));
+    if (psShares == NULL || psWorkers == NULL || piStarted == NULL) {
+        free(psShares);
+        free(psWorkers);
+        free(piStarted);
+        SymTable_map(oSymTable, pfApply,
+            ppvExtras == NULL ? NULL : ppvExtras[0]);
+        return;
+    }
+
+    SymTable_lockAll(oSymTable, 0);
+
+    uBucketTotal = oSymTable->uBucketCount + oSymTable->uGrowBucketCount;
+    sJob.oSymTable = oSymTable;
+    sJob.pfApply = pfApply;
+    sJob.ppvExtras = ppvExtras;
+    sJob.psShares = psShares;
+    sJob.uWorkerCount = uThreadCount;
+    sJob.uChunkSize = uBucketTotal / (uThreadCount * MAP_CHUNKS_PER_WORKER);
+    if (sJob.uChunkSize == 0) {
+        sJob.uChunkSize = 1;
+    }
+
+    uChunkCount = (uBucketTotal + sJob.uChunkSize - 1) / sJob.uChunkSize;
+    for (u = 0; u < uThreadCount; u++)
+    {
+        psShares[u].uNextChunk = uChunkCount * u / uThreadCount;
+        psShares[u].uEndChunk = uChunkCount * (u + 1) / uThreadCount;
+        psWorkers[u].psJob = &sJob;
+        psWorkers[u].uWorker = u;
+    }
+
+    for (u = 1; u < uThreadCount; u++)
+    {
+        piStarted[u] = pthread_create(&psWorkers[u].oThread, NULL,
+            SymTable_runMapWorker, &psWorkers[u]) == 0;
+    }
+    (void)SymTable_runMapWorker(&psWorkers[0]);
+    for (u = 1; u < uThreadCount; u++)
+    {
+        if (piStarted[u]) {
+            pthread_join(psWorkers[u].oThread, NULL);
+        }
+    }
+
+    SymTable_unlockAll(oSymTable);
+
+    free(psShares);
+    free(psWorkers);
+    free(piStarted);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new iterator over oSymTable, positioned before its first
+binding, or NULL if oSymTable is read-only or insufficient memory is
+available. */
+
+SymTableIter_T SymTable_iterBegin(SymTable_T oSymTable)
+{
+    struct SymTableIter *psIter;
+
+    assert(oSymTable != NULL);
+
+    if (SymTable_isReadOnly(oSymTable)) {
+        return NULL;
+    }
+
+    psIter = (struct SymTableIter *)calloc(1, sizeof(struct SymTableIter));
+    if (psIter == NULL) {
+        return NULL;
+    }
+
+    psIter->oSymTable = oSymTable;
+
+    SymTable_lockAll(oSymTable, 1);
+    psIter->psNextIter = oSymTable->psIters;
+    oSymTable->psIters = psIter;
+    SymTable_unlockAll(oSymTable);
+
+    return psIter;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the first node of the bucket of oSymTable that holds the
+bindings at position uPosition. Store in *puEnd the position up to
+which that bucket holds every binding, or set *piLast to 1 (TRUE)
+instead if it holds every binding from uPosition on. While the table
+is expanding, the bucket is an old one unless its bindings have moved,
+and then a new one whose range is part of the old one's. */
+
+static struct SymTableNode *SymTable_iterBucket(SymTable_T oSymTable,
+    uint64_t uPosition, uint64_t *puEnd, int *piLast)
+{
+    size_t uHash;
+    size_t uBucket;
+    uint64_t uLastPosition;
+
+    if (oSymTable->eHash != SYMTABLE_HASH_WORDS) {
+        assert(oSymTable->psGrowNode == NULL);
+        *piLast = uPosition + 1 == oSymTable->uBucketCount;
+        *puEnd = uPosition + 1;
+        return oSymTable->psFirstNode[uPosition];
+    }
+
+    /* The bucket holds the positions that share its top bits. */
+    uHash = (size_t)SymTable_reverseBits(uPosition);
+    uBucket = SymTable_reduce(oSymTable, uHash, oSymTable->uBucketCount);
+    if (oSymTable->psGrowNode == NULL || uBucket >= oSymTable->uGrowIndex)
+    {
+        uLastPosition = uPosition |
+            (UINT64_MAX / (uint64_t)oSymTable->uBucketCount);
+        *piLast = uLastPosition == UINT64_MAX;
+        *puEnd = uLastPosition + 1;
+        return oSymTable->psFirstNode[uBucket];
+    }
+
+    uBucket = SymTable_reduce(oSymTable, uHash,
+        oSymTable->uGrowBucketCount);
+    uLastPosition = uPosition |
+        (UINT64_MAX / (uint64_t)oSymTable->uGrowBucketCount);
+    *piLast = uLastPosition == UINT64_MAX;
+    *puEnd = uLastPosition + 1;
+    return oSymTable->psGrowNode[uBucket];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* In the concurrent build, lock for reading the stripe of oSymTable
+that guards the bucket holding the bindings at position uPosition, and
+return the stripe. A rehash between finding the bucket and taking the
+lock, which the sequence count shows, may have moved the bucket, so
+then the lock is dropped and the bucket found again. Otherwise just
+return 0. */
+
+static size_t SymTable_lockPosition(SymTable_T oSymTable,
+    uint64_t uPosition)
+{
+#ifdef SYMTABLE_CONCURRENT
+    pthread_rwlock_t *poLock;
+    size_t uSequence;
+    size_t uBucket;
+
+    for (;;)
+    {
+        uSequence = SYMTABLE_LOAD(oSymTable->uSequence);
+        if (oSymTable->eHash == SYMTABLE_HASH_WORDS) {
+            uBucket = SymTable_reduce(oSymTable,
+                (size_t)SymTable_reverseBits(uPosition),
+                SYMTABLE_LOAD(oSymTable->uBucketCount));
+        }
+        else {
+            uBucket = (size_t)uPosition;
+        }
+        poLock = &oSymTable->asStripes[uBucket % STRIPE_COUNT].oLock;
+        pthread_rwlock_rdlock(poLock);
+        if (oSymTable->uSequence == uSequence) {
+            return uBucket % STRIPE_COUNT;
+        }
+        pthread_rwlock_unlock(poLock);
+    }
+#else
+    (void)oSymTable;
+    (void)uPosition;
+    return 0;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look through the bucket that holds the position of oIter for the
+next binding after it. Return that binding and move oIter to it, or, if
+there is none, move oIter to the end of the bucket's range, or mark it
+done after the last bucket, and return NULL. The caller must hold the
+bucket's stripe. */
+
+static struct SymTableNode *SymTable_iterScan(SymTableIter_T oIter)
+{
+    SymTable_T oSymTable = oIter->oSymTable;
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode *psNextNode = NULL;
+    uint64_t uPosition;
+    uint64_t uNextPosition = 0;
+    uint64_t uEnd = 0;
+    int iLast;
+
+    for (psCurrentNode = SymTable_iterBucket(oSymTable, oIter->uPosition,
+        &uEnd, &iLast);
+    psCurrentNode != NULL; psCurrentNode = psCurrentNode->psNextNode)
+    {
+        uPosition = SymTable_iterPosition(oSymTable, psCurrentNode->uHash);
+        if (uPosition < oIter->uPosition ||
+        (uPosition == oIter->uPosition &&
+        (uintptr_t)psCurrentNode <= oIter->uAddress) ||
+        (! iLast && uPosition >= uEnd)) {
+            continue;
+        }
+        if (psNextNode == NULL || uPosition < uNextPosition ||
+        (uPosition == uNextPosition &&
+        (uintptr_t)psCurrentNode < (uintptr_t)psNextNode)) {
+            psNextNode = psCurrentNode;
+            uNextPosition = uPosition;
+        }
+    }
+
+    if (psNextNode != NULL) {
+        oIter->uPosition = uNextPosition;
+        oIter->uAddress = (uintptr_t)psNextNode;
+    }
+    else if (iLast) {
+        oIter->iDone = 1;
+    }
+    else {
+        oIter->uPosition = uEnd;
+        oIter->uAddress = 0;
+    }
+    return psNextNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Advance oIter to the next binding of its table and return 1 (TRUE),
+or return 0 (FALSE) if every binding has been visited. Each call scans
+the buckets from the last binding's position on until one holds a
+binding after it, or takes the next binding of the snapshot that is
+still in the table. In the concurrent build only the stripe of the
+bucket or binding at hand is locked at a time, and oIter is moved on
+under it, so that a rehash, which takes every stripe, sees oIter at a
+binding or between buckets. */
+
+int SymTable_iterNext(SymTableIter_T oIter)
+{
+    SymTable_T oSymTable;
+    struct SymTableNode *psNextNode = NULL;
+    struct SymTableIterEntry *psEntry;
+    size_t uStripe;
+
+    assert(oIter != NULL);
+
+    oSymTable = oIter->oSymTable;
+
+#ifndef SYMTABLE_CONCURRENT
+    /* A walk over prime buckets starts after any expansion, so that
+    the positions stay put until the next one. */
+    if (oIter->uPosition == 0 && oIter->uAddress == 0 &&
+    oSymTable->eHash != SYMTABLE_HASH_WORDS) {
+        while (oSymTable->psGrowNode != NULL)
+        {
+            SymTable_growStep(oSymTable);
+        }
+    }
+#endif
+
+    /* Scan the buckets until there is a binding, a snapshot to turn to,
+    or nothing left. */
+    for (;;)
+    {
+        uStripe = SymTable_lockPosition(oSymTable, oIter->uPosition);
+        if (oIter->psSnapshot != NULL || oIter->iDone) {
+            SymTable_unlockStripe(oSymTable, uStripe);
+            break;
+        }
+        psNextNode = SymTable_iterScan(oIter);
+        if (psNextNode != NULL) {
+            SYMTABLE_STORE(oIter->psCurrentNode, psNextNode);
+            SymTable_unlockStripe(oSymTable, uStripe);
+            return 1;
+        }
+        SymTable_unlockStripe(oSymTable, uStripe);
+    }
+
+    /* Take the next binding of the snapshot that has not been removed,
+    under the stripe that a remove of it would hold. */
+    while (! oIter->iDone &&
+    oIter->uSnapshotIndex < oIter->uSnapshotLength)
+    {
+        psEntry = &oIter->psSnapshot[oIter->uSnapshotIndex++];
+        uStripe = SymTable_lockBucket(oSymTable, psEntry->uHash, 0);
+        if (! psEntry->iRemoved) {
+            SYMTABLE_STORE(oIter->psCurrentNode, psEntry->psNode);
+            SymTable_unlockStripe(oSymTable, uStripe);
+            return 1;
+        }
+        SymTable_unlockStripe(oSymTable, uStripe);
+    }
+
+    SYMTABLE_STORE(oIter->psCurrentNode, NULL);
+    return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the key of the binding that oIter is at, or NULL if it is at
+none or the binding has been removed. */
+
+const char *SymTable_iterKey(SymTableIter_T oIter)
+{
+    struct SymTableNode *psCurrentNode;
+
+    assert(oIter != NULL);
+
+    psCurrentNode = SYMTABLE_LOAD(oIter->psCurrentNode);
+    if (psCurrentNode == NULL) {
+        return NULL;
+    }
+    return psCurrentNode->pcKey;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding that oIter is at, or NULL if it is
+at none or the binding has been removed. */
+
+void *SymTable_iterValue(SymTableIter_T oIter)
+{
+    struct SymTableNode *psCurrentNode;
+
+    assert(oIter != NULL);
+
+    psCurrentNode = SYMTABLE_LOAD(oIter->psCurrentNode);
+    if (psCurrentNode == NULL) {
+        return NULL;
+    }
+    return (void *) SYMTABLE_LOAD(psCurrentNode->pvValue);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free oIter. */
+
+void SymTable_iterFree(SymTableIter_T oIter)
+{
+    SymTable_T oSymTable;
+    struct SymTableIter **ppsLink;
+
+    assert(oIter != NULL);
+
+    oSymTable = oIter->oSymTable;
+    SymTable_lockAll(oSymTable, 1);
+    for (ppsLink = &oSymTable->psIters; *ppsLink != oIter;
+    ppsLink = &(*ppsLink)->psNextIter)
+    {
+        assert(*ppsLink != NULL);
+    }
+    *ppsLink = oIter->psNextIter;
+    SymTable_unlockAll(oSymTable);
+
+    free(oIter->psSnapshot);
+    free(oIter);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_save collects its output in a buffer of SAVE_BUFFER_SIZE
+bytes, so that most bindings cost no system call of their own. */
+
+enum {SAVE_BUFFER_SIZE = 64 * 1024};
+
+/* A SymTableSave is the state of a SymTable_save call. */
+
+struct SymTableSave
+{
+    /* The file descriptor being written, the buffered bytes not yet
+    written to it, and the number of them. */
+    int iFd;
+    unsigned char *pucBuffer;
+    size_t uBuffered;
+
+    /* The number of bytes saved so far, buffered ones included. */
+    uint64_t uOffset;
+
+    /* TRUE once a write has failed or memory has run out, after which
+    nothing more is written. */
+    int iFailed;
+
+    /* The value serializer, and a buffer of uValueBufferSize bytes that
+    it writes each value into. */
+    size_t (*pfSerialize)(const void *pvValue, void *pvBuffer,
+        size_t uBufferSize);
+    unsigned char *pucValue;
+    size_t uValueBufferSize;
+
+    /* The slots being filled, their number minus 1, and the number
+    of them filled so far. */
+    uint64_t *puSlots;
+    size_t uSlotMask;
+    size_t uSaved;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Write the uSize bytes at pvBytes to iFd, in as many calls as it
+takes. Return 1 (TRUE), or 0 (FALSE) if a write fails. */
+
+static int SymTable_writeAll(int iFd, const void *pvBytes, size_t uSize)
+{
+    const unsigned char *pucBytes = (const unsigned char *)pvBytes;
+    ssize_t iWritten;
+
+    while (uSize > 0)
+    {
+        iWritten = write(iFd, pucBytes, uSize);
+        if (iWritten < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return 0;
+        }
+        pucBytes += iWritten;
+        uSize -= (size_t)iWritten;
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write out the buffered bytes of psSave. */
+
+static void SymTable_saveFlush(struct SymTableSave *psSave)
+{
+    if (! psSave->iFailed &&
+    ! SymTable_writeAll(psSave->iFd, psSave->pucBuffer,
+    psSave->uBuffered)) {
+        psSave->iFailed = 1;
+    }
+    psSave->uBuffered = 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Save the uSize bytes at pvBytes, followed by enough zeros to pad
+them to a multiple of 8 bytes if iPad is TRUE. */
+
+static void SymTable_saveBytes(struct SymTableSave *psSave,
+    const void *pvBytes, size_t uSize, int iPad)
+{
+    static const unsigned char aucZeros[8];
+    size_t uPadding = 0;
+
+    if (iPad) {
+        uPadding = SymTable_pad8(uSize) - uSize;
+    }
+    if (psSave->iFailed) {
+        return;
+    }
+
+    if (uSize > SAVE_BUFFER_SIZE - psSave->uBuffered) {
+        SymTable_saveFlush(psSave);
+    }
+    if (uSize >= SAVE_BUFFER_SIZE) {
+        if (! SymTable_writeAll(psSave->iFd, pvBytes, uSize)) {
+            psSave->iFailed = 1;
+        }
+    }
+    else {
+        memcpy(psSave->pucBuffer + psSave->uBuffered, pvBytes, uSize);
+        psSave->uBuffered += uSize;
+    }
+    psSave->uOffset += uSize;
+
+    if (uPadding > 0) {
+        SymTable_saveBytes(psSave, aucZeros, uPadding, 0);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Save the record of the binding of pcKey to pvValue, and fill the
+slot of pcKey with its offset. This is the function that SymTable_save
+maps over the table, with its SymTableSave as pvExtra. */
+
+static void SymTable_saveBinding(const char *pcKey, void *pvValue,
+    void *pvExtra)
+{
+    struct SymTableSave *psSave = (struct SymTableSave *)pvExtra;
+    struct SymTableRecord sRecord;
+    unsigned char *pucValue;
+    size_t uValueSize = 0;
+    size_t uLength;
+    size_t uHash;
+    size_t uIndex;
+
+    if (psSave->iFailed) {
+        return;
+    }
+
+    if (psSave->pfSerialize != NULL) {
+        uValueSize = (*psSave->pfSerialize)(pvValue, psSave->pucValue,
+            psSave->uValueBufferSize);
+        if (uValueSize > psSave->uValueBufferSize) {
+            pucValue = (unsigned char *)realloc(psSave->pucValue,
+                uValueSize);
+            if (pucValue == NULL) {
+                psSave->iFailed = 1;
+                return;
+            }
+            psSave->pucValue = pucValue;
+            psSave->uValueBufferSize = uValueSize;
+            uValueSize = (*psSave->pfSerialize)(pvValue, pucValue,
+                uValueSize);
+            assert(uValueSize <= psSave->uValueBufferSize);
+        }
+    }
+
+    /* A table that grew during the save could fill every slot. */
+    if (psSave->uOffset > SLOT_OFFSET_MASK ||
+    psSave->uSaved == psSave->uSlotMask) {
+        psSave->iFailed = 1;
+        return;
+    }
+
+    uLength = strlen(pcKey);
+    uHash = SymTable_hashWords(pcKey, uLength);
+    uIndex = uHash & psSave->uSlotMask;
+    while (psSave->puSlots[uIndex] != 0) {
+        uIndex = (uIndex + 1) & psSave->uSlotMask;
+    }
+    psSave->puSlots[uIndex] =
+        ((uint64_t)uHash & ~SLOT_OFFSET_MASK) | psSave->uOffset;
+    psSave->uSaved++;
+
+    sRecord.uKeyLength = uLength;
+    sRecord.uValueSize = uValueSize;
+    SymTable_saveBytes(psSave, &sRecord, sizeof(sRecord), 0);
+    SymTable_saveBytes(psSave, pcKey, uLength + 1, 1);
+    SymTable_saveBytes(psSave, psSave->pucValue, uValueSize, 1);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Write the bindings of oSymTable to the file descriptor iFd, in the
+format that SymTable_openMapped maps, and return 1 (TRUE). Each value
+is saved as the bytes that (*pfSerialize)(pvValue, pvBuffer, uSize)
+stores at pvBuffer, whose number it returns. If that number exceeds
+uSize the call stores nothing and is made again with a buffer of that
+size. With a NULL pfSerialize only the keys are saved. Return 0
+(FALSE) if a write fails or insufficient memory is available. In the
+concurrent build, no put may overlap the save. The
+slots are filled in memory while the records are written, and written
+after them, so iFd need not be seekable. */
+
+int SymTable_save(SymTable_T oSymTable, int iFd,
+    size_t (*pfSerialize)(const void *pvValue, void *pvBuffer,
+    size_t uBufferSize))
+{
+    struct SymTableSave sSave;
+    struct SymTableTrailer sTrailer;
+    size_t uLength;
+    size_t uSlotCount = 1;
+
+    assert(oSymTable != NULL);
+
+    /* Keep the slots at most 3/4 full, with at least one empty. */
+    uLength = SymTable_getLength(oSymTable);
+    while (uSlotCount - uSlotCount / 4 <= uLength)
+    {
+        if (uSlotCount > ((size_t)-1) / (2 * sizeof(uint64_t))) {
+            return 0;
+        }
+        uSlotCount *= 2;
+    }
+
+    memset(&sSave, 0, sizeof(sSave));
+    sSave.iFd = iFd;
+    sSave.pfSerialize = pfSerialize;
+    sSave.uSlotMask = uSlotCount - 1;
+    sSave.pucBuffer = (unsigned char *)malloc(SAVE_BUFFER_SIZE);
+    sSave.puSlots = (uint64_t *)calloc(uSlotCount, sizeof(uint64_t));
+    if (sSave.pucBuffer == NULL || sSave.puSlots == NULL) {
+        free(sSave.pucBuffer);
+        free(sSave.puSlots);
+        return 0;
+    }
+
+    SymTable_saveBytes(&sSave, acSnapshotMagic, sizeof(acSnapshotMagic),
+        0);
+    SymTable_map(oSymTable, SymTable_saveBinding, &sSave);
+
+    sTrailer.uMagic = SNAPSHOT_TRAILER_MAGIC;
+    sTrailer.uHashBits = sizeof(size_t) * CHAR_BIT;
+    sTrailer.uLength = sSave.uSaved;
+    sTrailer.uSlotCount = uSlotCount;
+    sTrailer.uSlotsOffset = sSave.uOffset;
+    SymTable_saveBytes(&sSave, sSave.puSlots,
+        uSlotCount * sizeof(uint64_t), 0);
+    SymTable_saveBytes(&sSave, &sTrailer, sizeof(sTrailer), 0);
+    SymTable_saveFlush(&sSave);
+
+    free(sSave.pucBuffer);
+    free(sSave.pucValue);
+    free(sSave.puSlots);
+    return ! sSave.iFailed;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a read-only SymTable object over the file at pcPath that
+SymTable_save wrote, mapping the file instead of reading it, or NULL if
+the file cannot be opened or mapped, was not written by SymTable_save
+on a machine like this one, or insufficient memory is available. The
+trailer and the bounds of the slots are checked here; each record is
+checked when a lookup first reads it. */
+
+SymTable_T SymTable_openMapped(const char *pcPath)
+{
+    SymTable_T oSymTable;
+    const struct SymTableTrailer *psTrailer;
+    const unsigned char *pucMapped;
+    struct stat sStat;
+    size_t uSize;
+    size_t uSlotsEnd;
+    void *pvMapped;
+    int iFd;
+
+    assert(pcPath != NULL);
+
+    iFd = open(pcPath, O_RDONLY);
+    if (iFd < 0) {
+        return NULL;
+    }
+    if (fstat(iFd, &sStat) != 0 || sStat.st_size < 0 ||
+    (uintmax_t)sStat.st_size > (size_t)-1 ||
+    (size_t)sStat.st_size < sizeof(acSnapshotMagic) +
+    sizeof(struct SymTableTrailer)) {
+        close(iFd);
+        return NULL;
+    }
+    uSize = (size_t)sStat.st_size;
+
+    pvMapped = mmap(NULL, uSize, PROT_READ, MAP_SHARED, iFd, 0);
+    close(iFd);
+    if (pvMapped == MAP_FAILED) {
+        return NULL;
+    }
+    pucMapped = (const unsigned char *)pvMapped;
+
+    uSlotsEnd = uSize - sizeof(struct SymTableTrailer);
+    psTrailer = (const struct SymTableTrailer *)(const void *)
+        (pucMapped + uSlotsEnd);
+    if ((uSize & 7) != 0 ||
+    memcmp(pucMapped, acSnapshotMagic, sizeof(acSnapshotMagic)) != 0 ||
+    psTrailer->uMagic != SNAPSHOT_TRAILER_MAGIC ||
+    psTrailer->uHashBits != sizeof(size_t) * CHAR_BIT ||
+    psTrailer->uSlotsOffset < sizeof(acSnapshotMagic) ||
+    psTrailer->uSlotsOffset > uSlotsEnd ||
+    (psTrailer->uSlotsOffset & 7) != 0 ||
+    psTrailer->uSlotCount != (uSlotsEnd - psTrailer->uSlotsOffset) /
+    sizeof(uint64_t) ||
+    (psTrailer->uSlotCount & (psTrailer->uSlotCount - 1)) != 0 ||
+    psTrailer->uLength >= psTrailer->uSlotCount) {
+        munmap(pvMapped, uSize);
+        return NULL;
+    }
+
+    oSymTable = SymTable_newTable(NULL, 0);
+    if (oSymTable == NULL) {
+        munmap(pvMapped, uSize);
+        return NULL;
+    }
+    if (! SymTable_setHash(oSymTable, SYMTABLE_HASH_WORDS)) {
+        SymTable_free(oSymTable);
+        munmap(pvMapped, uSize);
+        return NULL;
+    }
+
+    oSymTable->pucMapped = pucMapped;
+    oSymTable->uMappedSize = uSize;
+    oSymTable->puMappedSlots = (const uint64_t *)(const void *)
+        (pucMapped + psTrailer->uSlotsOffset);
+    oSymTable->uMappedSlotMask = (size_t)psTrailer->uSlotCount - 1;
+    oSymTable->uMappedRecordsEnd = (size_t)psTrailer->uSlotsOffset;
+    oSymTable->length = (size_t)psTrailer->uLength;
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* SymTable_loadStream reads LOAD_BLOCK_SIZE bytes at a time, or more
+when one record does not fit. The size of a record header of
+SYMTABLE_FORMAT_BINARY is LOAD_HEADER_SIZE. */
+
+enum {LOAD_BLOCK_SIZE = 1024 * 1024, LOAD_HEADER_SIZE = 8};
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of the uKeyLength bytes at pcKey to the value that
+(*pfParse)(pcValue, uValueLength) returns, or to NULL if pfParse is
+NULL, unless oSymTable already has that key, in which case the value
+is not parsed at all. The byte after the value is '\0' during the call,
+so pcValue must be followed by a writable byte. Return 1 (TRUE), or 0
+(FALSE) if the key holds a '\0' or insufficient memory is available. */
+
+static int SymTable_loadBinding(SymTable_T oSymTable, const char *pcKey,
+    size_t uKeyLength, char *pcValue, size_t uValueLength,
+    void *(*pfParse)(const char *pcValue, size_t uLength))
+{
+    struct SymTableNode **ppsLink;
+    void *pvValue = NULL;
+    size_t uHash;
+    size_t uStripe;
+    int iSuccessful = 1;
+    char cSaved;
+
+    if (memchr(pcKey, '\0', uKeyLength) != NULL) {
+        return 0;
+    }
+
+    SymTable_growStep(oSymTable);
+    uHash = SymTable_hashKey(oSymTable->eHash, pcKey, uKeyLength);
+
+    uStripe = SymTable_lockBucket(oSymTable, uHash, 1);
+    ppsLink = SymTable_findLink(oSymTable, pcKey, uKeyLength, uHash);
+    if (*ppsLink == NULL) {
+        if (pfParse != NULL) {
+            cSaved = pcValue[uValueLength];
+            pcValue[uValueLength] = '\0';
+            pvValue = (*pfParse)(pcValue, uValueLength);
+            pcValue[uValueLength] = cSaved;
+        }
+        iSuccessful = SymTable_insertAt(oSymTable, ppsLink, pcKey,
+            uKeyLength, uHash, pvValue) != NULL;
+    }
+    SymTable_unlockStripe(oSymTable, uStripe);
+
+    SymTable_checkGrow(oSymTable);
+    return iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add to oSymTable the bindings of the whole records of format eFormat
+among the uSize bytes at pcBytes, which are followed by a writable
+byte, and return the number of bytes that those records take. If
+iFinal is TRUE no more bytes follow, so a last line that lacks its
+'\n' is whole too. Set *piSuccessful to 0 (FALSE) and stop if a binding
+cannot be added. */
+
+static size_t SymTable_loadRecords(SymTable_T oSymTable, char *pcBytes,
+    size_t uSize, enum SymTableFormat eFormat,
+    void *(*pfParse)(const char *pcValue, size_t uLength), int iFinal,
+    int *piSuccessful)
+{
+    char *pcLine;
+    char *pcTab;
+    char *pcValue;
+    char *pcNewline;
+    char *pcEnd = pcBytes + uSize;
+    uint32_t uKeyLength;
+    uint32_t uValueLength;
+    size_t uUsed = 0;
+
+    if (eFormat == SYMTABLE_FORMAT_BINARY) {
+        while (uSize - uUsed >= LOAD_HEADER_SIZE)
+        {
+            memcpy(&uKeyLength, pcBytes + uUsed, sizeof(uKeyLength));
+            memcpy(&uValueLength, pcBytes + uUsed + sizeof(uKeyLength),
+                sizeof(uValueLength));
+            if (uKeyLength > uSize - uUsed - LOAD_HEADER_SIZE ||
+            uValueLength > uSize - uUsed - LOAD_HEADER_SIZE - uKeyLength) {
+                break;
+            }
+            uUsed += LOAD_HEADER_SIZE;
+            if (! SymTable_loadBinding(oSymTable, pcBytes + uUsed,
+            uKeyLength, pcBytes + uUsed + uKeyLength, uValueLength,
+            pfParse)) {
+                *piSuccessful = 0;
+                break;
+            }
+            uUsed += (size_t)uKeyLength + uValueLength;
+        }
+        return uUsed;
+    }
+
+    assert(eFormat == SYMTABLE_FORMAT_TSV);
+
+    for (pcLine = pcBytes; pcLine < pcEnd; pcLine = pcNewline + 1)
+    {
+        pcNewline = (char *)memchr(pcLine, '\n', (size_t)(pcEnd - pcLine));
+        if (pcNewline == NULL) {
+            if (! iFinal) {
+                break;
+            }
+            pcNewline = pcEnd;
+        }
+        if (pcNewline == pcLine) {
+            continue;
+        }
+
+        /* A line without a tab is a key with an empty value. */
+        pcTab = (char *)memchr(pcLine, '\t', (size_t)(pcNewline - pcLine));
+        pcValue = pcNewline;
+        if (pcTab != NULL) {
+            pcValue = pcTab + 1;
+        }
+        else {
+            pcTab = pcNewline;
+        }
+        if (! SymTable_loadBinding(oSymTable, pcLine,
+        (size_t)(pcTab - pcLine), pcValue, (size_t)(pcNewline - pcValue),
+        pfParse)) {
+            *piSuccessful = 0;
+            break;
+        }
+    }
+
+    if (pcLine > pcEnd) {
+        return uSize;
+    }
+    return (size_t)(pcLine - pcBytes);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add to oSymTable the bindings of the records of format eFormat read
+from iFd up to its end, as SymTable_put would, with values made by
+pfParse. The input is read a block at a time into one buffer, record
+boundaries are found with memchr, and keys go from the buffer straight
+into their nodes. If iFd is a regular file, the table is reserved after
+the first block for as many bindings as the rest of the file seems to
+hold, so that it does not expand step by step. Return 1 (TRUE), or
+0 (FALSE) if a read fails, the input ends inside a record, a key holds
+a '\0', oSymTable is read-only, or insufficient memory is available.
+The bindings added before a failure stay. */
+
+int SymTable_loadStream(SymTable_T oSymTable, int iFd,
+    enum SymTableFormat eFormat,
+    void *(*pfParse)(const char *pcValue, size_t uLength))
+{
+    char *pcBuffer;
+    char *pcLarger;
+    struct stat sStat;
+    off_t iOffset;
+    size_t uBufferSize = LOAD_BLOCK_SIZE;
+    size_t uStart = 0;
+    size_t uEnd = 0;
+    size_t uUsed;
+    size_t uInitialLength;
+    double dBytesLeft = 0.0;
+    ssize_t iRead;
+    int iFinal = 0;
+    int iSuccessful = 1;
+
+    assert(oSymTable != NULL);
+    assert(eFormat == SYMTABLE_FORMAT_TSV ||
+        eFormat == SYMTABLE_FORMAT_BINARY);
+
+    if (SymTable_isReadOnly(oSymTable)) {
+        return 0;
+    }
+
+    /* One byte more than is read, for SymTable_loadBinding to
+    terminate the value of a last line that lacks its '\n'. */
+    pcBuffer = (char *)malloc(uBufferSize + 1);
+    if (pcBuffer == NULL) {
+        return 0;
+    }
+
+    uInitialLength = SymTable_getLength(oSymTable);
+    if (fstat(iFd, &sStat) == 0 && S_ISREG(sStat.st_mode)) {
+        iOffset = lseek(iFd, 0, SEEK_CUR);
+        if (iOffset >= 0 && iOffset < sStat.st_size) {
+            dBytesLeft = (double)(sStat.st_size - iOffset);
+        }
+    }
+
+    for (;;)
+    {
+        uUsed = SymTable_loadRecords(oSymTable, pcBuffer + uStart,
+            uEnd - uStart, eFormat, pfParse, iFinal, &iSuccessful);
+        uStart += uUsed;
+        if (! iSuccessful || iFinal) {
+            break;
+        }
+
+        /* The first block shows how many bytes a binding takes. */
+        if (uUsed > 0 && dBytesLeft > (double)uStart) {
+            (void)SymTable_reserve(oSymTable,
+                SymTable_getLength(oSymTable) + (size_t)((dBytesLeft -
+                (double)uStart) / (double)uStart *
+                (double)(SymTable_getLength(oSymTable) - uInitialLength)));
+            dBytesLeft = 0.0;
+        }
+
+        /* Move the partial record to the front, and make the buffer
+        larger if the record fills it. */
+        memmove(pcBuffer, pcBuffer + uStart, uEnd - uStart);
+        uEnd -= uStart;
+        uStart = 0;
+        if (uEnd == uBufferSize) {
+            pcLarger = NULL;
+            if (uBufferSize < ((size_t)-1) / 2) {
+                pcLarger = (char *)realloc(pcBuffer, 2 * uBufferSize + 1);
+            }
+            if (pcLarger == NULL) {
+                iSuccessful = 0;
+                break;
+            }
+            pcBuffer = pcLarger;
+            uBufferSize *= 2;
+        }
+
+        iRead = read(iFd, pcBuffer + uEnd, uBufferSize - uEnd);
+        if (iRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            iSuccessful = 0;
+            break;
+        }
+        iFinal = iRead == 0;
+        uEnd += (size_t)iRead;
+    }
+
+    free(pcBuffer);
+    return iSuccessful && uStart == uEnd;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A key of a table being frozen: its node, its hash code under the
+seed being tried, and its position. */
+
+struct SymTableFreezeKey
+{
+    const struct SymTableNode *psNode;
+    size_t uHash;
+    size_t uPosition;
+};
+
+/* A seed that puts more than FROZEN_MAX_BUCKET_SIZE keys in a bucket
+is given up, since such a bucket would hardly find a pilot. */
+
+enum {FROZEN_MAX_BUCKET_SIZE = 255};
+
+/*--------------------------------------------------------------------*/
+
+/* Give each of the uLength keys at psKeys, whose hash codes under the
+seed of psFrozen are in their uHash fields, a position of its own, by
+choosing a pilot for each bucket of psFrozen, largest buckets first.
+puStarts, puOrder, puBuckets and pucTaken are work arrays of
+uBucketCount + 1, uLength, uBucketCount and uSlotCount elements.
+Return 1 (TRUE), or 0 (FALSE) if some bucket is too large or has no
+pilot. */
+
+static int SymTable_placeFrozen(struct SymTableFrozen *psFrozen,
+    struct SymTableFreezeKey *psKeys, size_t uLength, size_t *puStarts,
+    size_t *puOrder, size_t *puBuckets, unsigned char *pucTaken)
+{
+    size_t auSizeStarts[FROZEN_MAX_BUCKET_SIZE + 2];
+    struct SymTableFreezeKey *psKey;
+    size_t uBucket;
+    size_t uSize;
+    size_t u;
+    size_t i;
+    unsigned int uPilot;
+
+    /* Sort the keys by bucket with one counting pass. */
+    memset(puStarts, 0, (psFrozen->uBucketCount + 1) * sizeof(size_t));
+    for (i = 0; i < uLength; i++)
+    {
+        puStarts[SymTable_frozenBucket(psFrozen, psKeys[i].uHash) + 1]++;
+    }
+    for (uBucket = 0; uBucket < psFrozen->uBucketCount; uBucket++)
+    {
+        if (puStarts[uBucket + 1] > FROZEN_MAX_BUCKET_SIZE) {
+            return 0;
+        }
+        puStarts[uBucket + 1] += puStarts[uBucket];
+    }
+    for (i = 0; i < uLength; i++)
+    {
+        puOrder[puStarts[SymTable_frozenBucket(psFrozen,
+            psKeys[i].uHash)]++] = i;
+    }
+    for (uBucket = psFrozen->uBucketCount; uBucket > 0; uBucket--)
+    {
+        puStarts[uBucket] = puStarts[uBucket - 1];
+    }
+    puStarts[0] = 0;
+
+    /* Sort the buckets by decreasing size, the same way. */
+    memset(auSizeStarts, 0, sizeof(auSizeStarts));
+    for (uBucket = 0; uBucket < psFrozen->uBucketCount; uBucket++)
+    {
+        uSize = puStarts[uBucket + 1] - puStarts[uBucket];
+        auSizeStarts[FROZEN_MAX_BUCKET_SIZE - uSize + 1]++;
+    }
+    for (u = 1; u <= FROZEN_MAX_BUCKET_SIZE + 1; u++)
+    {
+        auSizeStarts[u] += auSizeStarts[u - 1];
+    }
+    for (uBucket = 0; uBucket < psFrozen->uBucketCount; uBucket++)
+    {
+        uSize = puStarts[uBucket + 1] - puStarts[uBucket];
+        puBuckets[auSizeStarts[FROZEN_MAX_BUCKET_SIZE - uSize]++] = uBucket;
+    }
+
+    memset(pucTaken, 0, psFrozen->uSlotCount);
+    for (u = 0; u < psFrozen->uBucketCount; u++)
+    {
+        uBucket = puBuckets[u];
+        uSize = puStarts[uBucket + 1] - puStarts[uBucket];
+        psFrozen->puPilots[uBucket] = 0;
+        if (uSize == 0) {
+            continue;
+        }
+
+        /* Try pilots until every key of the bucket has a free position,
+        taking back the positions of a pilot that fails. */
+        for (uPilot = 0; ; uPilot++)
+        {
+            for (i = 0; i < uSize; i++)
+            {
+                psKey = &psKeys[puOrder[puStarts[uBucket] + i]];
+                psKey->uPosition = SymTable_frozenPosition(psFrozen,
+                    psKey->uHash, uPilot);
+                if (pucTaken[psKey->uPosition]) {
+                    break;
+                }
+                pucTaken[psKey->uPosition] = 1;
+            }
+            if (i == uSize) {
+                break;
+            }
+            while (i > 0) {
+                i--;
+                pucTaken[psKeys[puOrder[puStarts[uBucket] + i]].uPosition]
+                    = 0;
+            }
+            if (uPilot == FROZEN_MAX_PILOT) {
+                return 0;
+            }
+        }
+        psFrozen->puPilots[uBucket] = (uint16_t)uPilot;
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Map the positions of psFrozen at or above uLength to the unused ones
+below it, and lay out the entries of the uLength keys at psKeys, which
+have their positions, in pcEntries in the order of their positions,
+recording their offsets. pucTaken marks the positions that keys have,
+and puOrder is a work array of uLength elements. */
+
+static void SymTable_fillFrozen(struct SymTableFrozen *psFrozen,
+    struct SymTableFreezeKey *psKeys, size_t uLength,
+    const unsigned char *pucTaken, size_t *puOrder)
+{
+    struct SymTableFrozenEntry *psEntry;
+    const struct SymTableNode *psNode;
+    size_t uFree = 0;
+    size_t uOffset = 0;
+    size_t uPosition;
+    size_t i;
+
+    for (uPosition = uLength; uPosition < psFrozen->uSlotCount;
+    uPosition++)
+    {
+        psFrozen->puRemap[uPosition - uLength] = 0;
+        if (pucTaken[uPosition]) {
+            while (pucTaken[uFree]) {
+                uFree++;
+            }
+            psFrozen->puRemap[uPosition - uLength] = (uint32_t)uFree;
+            uFree++;
+        }
+    }
+
+    for (i = 0; i < uLength; i++)
+    {
+        uPosition = psKeys[i].uPosition;
+        if (uPosition >= uLength) {
+            uPosition = psFrozen->puRemap[uPosition - uLength];
+        }
+        puOrder[uPosition] = i;
+    }
+
+    for (uPosition = 0; uPosition < uLength; uPosition++)
+    {
+        psNode = psKeys[puOrder[uPosition]].psNode;
+        psFrozen->puOffsets[uPosition] = (uint32_t)(uOffset / 8);
+        psEntry = (struct SymTableFrozenEntry *)(void *)
+            (psFrozen->pcEntries + uOffset);
+        psEntry->pvValue = psNode->pvValue;
+        psEntry->uLength = (uint32_t)psNode->uLength;
+        memcpy(psEntry->acKey, psNode->pcKey, psNode->uLength + 1);
+        uOffset += SymTable_pad8(offsetof(struct SymTableFrozenEntry,
+            acKey) + psNode->uLength + 1);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make oSymTable read-only, as a table that SymTable_openMapped
+returns is, and return 1 (TRUE). Its bindings move out of the nodes
+and buckets into a minimal perfect hash over one array of entries:
+pilots of 16 bits per FROZEN_KEYS_PER_BUCKET keys, a 32-bit offset per
+key, and the entries themselves, so that a lookup reads one pilot, one
+offset and one entry. If oSymTable is already read-only, has live
+iterators, has 2^32 or more bindings or too many key bytes, no seed
+gives the buckets pilots, or insufficient memory is available, leave
+oSymTable unchanged and return 0 (FALSE). */
+
+int SymTable_freeze(SymTable_T oSymTable)
+{
+    struct SymTableFrozen *psFrozen;
+    struct SymTableFreezeKey *psKeys = NULL;
+    struct SymTableNode *psCurrentNode;
+    struct SymTableNode **psNewBuckets = NULL;
+    size_t *puStarts = NULL;
+    size_t *puOrder = NULL;
+    size_t *puBuckets = NULL;
+    unsigned char *pucTaken = NULL;
+    size_t uLength;
+    size_t uBucketTotal;
+    size_t uNewBucketCount;
+    size_t uEntriesSize = 0;
+    size_t uBucket;
+    size_t i;
+    int iAttempt;
+    int iSuccessful;
+
+    assert(oSymTable != NULL);
+
+    uLength = oSymTable->length;
+    if (SymTable_isReadOnly(oSymTable) || oSymTable->psIters != NULL ||
+    uLength >= UINT32_MAX) {
+        return 0;
+    }
+
+    psFrozen = (struct SymTableFrozen *)calloc(1,
+        sizeof(struct SymTableFrozen));
+    if (psFrozen == NULL) {
+        return 0;
+    }
+    psFrozen->uBucketCount = uLength / FROZEN_KEYS_PER_BUCKET + 1;
+    psFrozen->uDenseCount = psFrozen->uBucketCount * FROZEN_DENSE_PERCENT
+        / 100;
+    psFrozen->uSlotCount = uLength + uLength / FROZEN_SLACK + 1;
+
+    uNewBucketCount = SymTable_capacityBucketCount(oSymTable->eHash, 0);
+    psFrozen->puPilots = (uint16_t *)malloc(psFrozen->uBucketCount *
+        sizeof(uint16_t));
+    psFrozen->puRemap = (uint32_t *)malloc((psFrozen->uSlotCount -
+        uLength) * sizeof(uint32_t));
+    psFrozen->puOffsets = (uint32_t *)malloc((uLength + 1) *
+        sizeof(uint32_t));
+    psKeys = (struct SymTableFreezeKey *)malloc((uLength + 1) *
+        sizeof(struct SymTableFreezeKey));
+    puStarts = (size_t *)malloc((psFrozen->uBucketCount + 1) *
+        sizeof(size_t));
+    puOrder = (size_t *)malloc((uLength + 1) * sizeof(size_t));
+    puBuckets = (size_t *)malloc(psFrozen->uBucketCount * sizeof(size_t));
+    pucTaken = (unsigned char *)malloc(psFrozen->uSlotCount);
+    psNewBuckets = (struct SymTableNode **)calloc(uNewBucketCount,
+        sizeof(struct SymTableNode *));
+    iSuccessful = psFrozen->puPilots != NULL && psFrozen->puRemap != NULL
+        && psFrozen->puOffsets != NULL && psKeys != NULL &&
+        puStarts != NULL && puOrder != NULL && puBuckets != NULL &&
+        pucTaken != NULL && psNewBuckets != NULL;
+
+    /* Collect the keys, and add up the sizes of their entries. */
+    if (iSuccessful) {
+        i = 0;
+        uBucketTotal = oSymTable->uBucketCount +
+            oSymTable->uGrowBucketCount;
+        for (uBucket = 0; uBucket < uBucketTotal; uBucket++)
+        {
+            psCurrentNode = uBucket < oSymTable->uBucketCount ?
+                oSymTable->psFirstNode[uBucket] :
+                oSymTable->psGrowNode[uBucket - oSymTable->uBucketCount];
+            for (; psCurrentNode != NULL;
+            psCurrentNode = psCurrentNode->psNextNode)
+            {
+                psKeys[i++].psNode = psCurrentNode;
+                if (psCurrentNode->uLength >= UINT32_MAX) {
+                    iSuccessful = 0;
+                }
+                uEntriesSize += SymTable_pad8(offsetof(
+                    struct SymTableFrozenEntry, acKey) +
+                    psCurrentNode->uLength + 1);
+            }
+        }
+        assert(i == uLength);
+        if (uEntriesSize / 8 > UINT32_MAX) {
+            iSuccessful = 0;
+        }
+    }
+
+    if (iSuccessful) {
+        psFrozen->pcEntries = (char *)malloc(uEntriesSize + 1);
+        iSuccessful = psFrozen->pcEntries != NULL;
+    }
+
+    /* Try seeds until one gives every bucket a pilot. */
+    if (iSuccessful) {
+        iSuccessful = 0;
+        for (iAttempt = 0; iAttempt < FROZEN_ATTEMPTS && ! iSuccessful;
+        iAttempt++)
+        {
+            psFrozen->uSeed = WORDS_SECRET0 +
+                (uint64_t)iAttempt * FROZEN_PILOT_MULTIPLIER;
+            for (i = 0; i < uLength; i++)
+            {
+                psKeys[i].uHash = (size_t)SymTable_hashSeeded(
+                    psKeys[i].psNode->pcKey, psKeys[i].psNode->uLength,
+                    psFrozen->uSeed);
+            }
+            iSuccessful = SymTable_placeFrozen(psFrozen, psKeys, uLength,
+                puStarts, puOrder, puBuckets, pucTaken);
+        }
+    }
+
+    if (iSuccessful) {
+        SymTable_fillFrozen(psFrozen, psKeys, uLength, pucTaken, puOrder);
+    }
+
+    free(psKeys);
+    free(puStarts);
+    free(puOrder);
+    free(puBuckets);
+    free(pucTaken);
+
+    if (! iSuccessful) {
+        free(psNewBuckets);
+        SymTable_freeFrozen(psFrozen);
+        return 0;
+    }
+
+    /* The entries hold copies of the keys, so the nodes can go. */
+    SymTable_releaseStorage(oSymTable);
+    free(oSymTable->psGrowNode);
+    free(oSymTable->psFirstNode);
+    oSymTable->psGrowNode = NULL;
+    oSymTable->uGrowBucketCount = 0;
+    oSymTable->uGrowIndex = 0;
+    oSymTable->psFirstNode = psNewBuckets;
+    oSymTable->uBucketCount = uNewBucketCount;
+    oSymTable->psFrozen = psFrozen;
+    return 1;
 }
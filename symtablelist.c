@@ -15,18 +15,57 @@ to form a list. */
 
 struct SymTableNode
 {
-    /* The binding's key. */
-    const char *pcKey;
-    
+    /* The address of the next SymTableNode */
+    struct SymTableNode *psNextNode;
+
     /* The value associated with the binding's key. */
     const void *pvValue; 
 
-    /* The address of the next SymTableNode */
-    struct SymTableNode *psNextNode;
+    /* The binding's key, stored in the same allocation as the node so
+    that comparing it reads the same cache line as psNextNode. */
+    char acKey[];
 };
 
 /*--------------------------------------------------------------------*/
 
+/* Keys of up to SHORT_KEY_SIZE bytes, including the terminating '\0',
+all get nodes of the same size, so malloc can hand a freed short node
+straight to the next short key. Longer keys get nodes of exactly the
+size they need. */
+
+enum {SHORT_KEY_SIZE = 24};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTableNode holding a copy of the uKeySize bytes of
+pcKey, with its other fields unset, or NULL if insufficient memory is
+available. */
+
+static struct SymTableNode *SymTable_newNode(const char *pcKey,
+    size_t uKeySize)
+{
+    struct SymTableNode *psNewNode;
+
+    if (uKeySize <= SHORT_KEY_SIZE) {
+        psNewNode = (struct SymTableNode*)malloc(sizeof(struct SymTableNode)
+            + SHORT_KEY_SIZE);
+    }
+    else {
+        psNewNode = (struct SymTableNode*)malloc(sizeof(struct SymTableNode)
+            + uKeySize);
+    }
+
+    if (psNewNode == NULL) 
+    {
+        return NULL;
+    }
+
+    memcpy(psNewNode->acKey, pcKey, uKeySize);
+    return psNewNode;
+}
+
+/*--------------------------------------------------------------------*/
+
 /* A SymTable is a "dummy" node that points to the first SymTable Node*/
 
 struct SymTable 
@@ -110,22 +149,13 @@ int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void
     }
 
     /* defensive copy */
-    psNewNode = (struct SymTableNode*)malloc(sizeof(struct SymTableNode));
+    psNewNode = SymTable_newNode(pcKey, strlen(pcKey) + 1);
 
     if (psNewNode == NULL) 
     {
         return 0;
     }
 
-    psNewNode->pcKey = (char*)malloc(strlen(pcKey) + 1);
-
-    if (psNewNode->pcKey == NULL) 
-    {
-        free (psNewNode);
-        return 0;
-    }
-
-    strcpy((char *)psNewNode->pcKey, pcKey);
     psNewNode->pvValue = pvValue;
     psNewNode->psNextNode = oSymTable->psFirstNode;
     oSymTable->psFirstNode = psNewNode;
@@ -151,7 +181,7 @@ void *pvValue)
     for (psCurrentNode = oSymTable->psFirstNode; psCurrentNode != NULL; 
     psCurrentNode = psNextNode) 
     {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
+        if (strcmp(psCurrentNode->acKey, pcKey) == 0) {
             void *oldval = (void *) psCurrentNode->pvValue;
             psCurrentNode->pvValue = pvValue;
             return oldval;
@@ -178,7 +208,7 @@ int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
     for (psCurrentNode = oSymTable->psFirstNode; psCurrentNode != NULL; 
     psCurrentNode = psNextNode) 
     {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
+        if (strcmp(psCurrentNode->acKey, pcKey) == 0) {
             return 1;
         }
         psNextNode = psCurrentNode->psNextNode;
@@ -203,7 +233,7 @@ void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
     for (psCurrentNode = oSymTable->psFirstNode; psCurrentNode != NULL; 
     psCurrentNode = psNextNode) 
     {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
+        if (strcmp(psCurrentNode->acKey, pcKey) == 0) {
             return (void *) psCurrentNode->pvValue;
         }
         psNextNode = psCurrentNode->psNextNode;
@@ -232,7 +262,7 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
     for (psCurrentNode = oSymTable->psFirstNode; psCurrentNode != NULL; 
     psCurrentNode = psCurrentNode->psNextNode) 
     {
-        if (strcmp(psCurrentNode->pcKey, pcKey) == 0) {
+        if (strcmp(psCurrentNode->acKey, pcKey) == 0) {
             void *oldval = (void *) psCurrentNode->pvValue;
             /* relink to remove current node */
             if (psPrevNode == NULL) {
@@ -241,7 +271,6 @@ void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
             else {
                 psPrevNode->psNextNode = psCurrentNode->psNextNode;
             }
-            free ((char *) psCurrentNode->pcKey);
             free (psCurrentNode);
             oSymTable->length--;
             return oldval;
@@ -269,6 +298,6 @@ void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char
     for (psCurrentNode = oSymTable->psFirstNode; psCurrentNode != NULL; 
     psCurrentNode = psCurrentNode->psNextNode) 
     {
-        (*pfApply) ((char *) psCurrentNode->pcKey, (void*) psCurrentNode->pvValue, (void*) pvExtra);
+        (*pfApply) (psCurrentNode->acKey, (void*) psCurrentNode->pvValue, (void*) pvExtra);
     }
 }
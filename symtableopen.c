@@ -0,0 +1,431 @@
+/*--------------------------------------------------------------------*/
+/* symtableopen.c                                                     */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* Each binding is stored in a SymTableSlot. The slots form one flat
+array that is probed linearly, so a lookup reads neighbouring slots
+instead of following pointers between nodes. */
+
+struct SymTableSlot
+{
+    /* The binding's key, or NULL if the slot is empty. */
+    const char *pcKey;
+
+    /* The value associated with the binding's key. */
+    const void *pvValue;
+
+    /* The full hash code of the binding's key. */
+    size_t uHash;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is an open addressing hash table that uses Robin Hood
+probing: a binding that is far from its home slot may displace one
+that is closer to its own, which keeps every probe sequence short. */
+
+struct SymTable
+{
+    /* The address of the first SymTableSlot */
+    struct SymTableSlot *psSlots;
+
+    /* The number of slots, always a power of two. */
+    size_t uSlotCount;
+
+    /* number of bindings in symtable */
+    size_t length;
+};
+
+/*--------------------------------------------------------------------*/
+
+enum {INITIAL_SLOT_COUNT = 16};
+
+/* The table expands before more than MAX_LOAD_NUMERATOR /
+MAX_LOAD_DENOMINATOR of its slots are in use. */
+
+enum {MAX_LOAD_NUMERATOR = 7, MAX_LOAD_DENOMINATOR = 8};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for pcKey. The 65599 hash is mixed afterwards
+so that its low bits, which select the home slot, depend on every
+character of pcKey. */
+
+static size_t SymTable_hash(const char *pcKey)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = 0;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+   {
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+   }
+
+   uHash ^= uHash >> 17;
+   uHash *= 0xed5ad4bbU;
+   uHash ^= uHash >> 11;
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return how many slots the binding in slot uIndex of oSymTable lies
+past its home slot. */
+
+static size_t SymTable_distance(SymTable_T oSymTable, size_t uIndex)
+{
+    size_t uMask = oSymTable->uSlotCount - 1;
+
+    return (uIndex - (oSymTable->psSlots[uIndex].uHash & uMask)) & uMask;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the slot of oSymTable that holds the binding with
+key pcKey whose hash code is uHash, or oSymTable->uSlotCount if there
+is no such binding. */
+
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+    size_t uHash)
+{
+    size_t uMask = oSymTable->uSlotCount - 1;
+    size_t uIndex;
+    size_t uDistance;
+    struct SymTableSlot *psSlot;
+
+    for (uIndex = uHash & uMask, uDistance = 0; ;
+    uIndex = (uIndex + 1) & uMask, uDistance++)
+    {
+        psSlot = &oSymTable->psSlots[uIndex];
+
+        /* A binding with this key would have displaced any binding
+        that is closer to its home slot. */
+        if (psSlot->pcKey == NULL ||
+        SymTable_distance(oSymTable, uIndex) < uDistance) {
+            return oSymTable->uSlotCount;
+        }
+
+        if (psSlot->uHash == uHash && strcmp(psSlot->pcKey, pcKey) == 0) {
+            return uIndex;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Insert the binding *psEntry into oSymTable, which must not already
+contain its key and must have an empty slot. Whenever the binding being
+placed is farther from home than a slot's binding, the two swap and the
+displaced binding continues the probe. */
+
+static void SymTable_insert(SymTable_T oSymTable,
+    struct SymTableSlot *psEntry)
+{
+    size_t uMask = oSymTable->uSlotCount - 1;
+    size_t uIndex;
+    size_t uDistance;
+    size_t uSlotDistance;
+    struct SymTableSlot sCarried = *psEntry;
+    struct SymTableSlot sSwap;
+
+    for (uIndex = sCarried.uHash & uMask, uDistance = 0; ;
+    uIndex = (uIndex + 1) & uMask, uDistance++)
+    {
+        if (oSymTable->psSlots[uIndex].pcKey == NULL) {
+            oSymTable->psSlots[uIndex] = sCarried;
+            return;
+        }
+
+        uSlotDistance = SymTable_distance(oSymTable, uIndex);
+        if (uSlotDistance < uDistance) {
+            sSwap = oSymTable->psSlots[uIndex];
+            oSymTable->psSlots[uIndex] = sCarried;
+            sCarried = sSwap;
+            uDistance = uSlotDistance;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSymTable into a slot array twice as large.
+Return 1 (TRUE) on success, or 0 (FALSE) and leave oSymTable unchanged
+if insufficient memory is available. */
+
+static int SymTable_grow(SymTable_T oSymTable)
+{
+    struct SymTableSlot *psOldSlots = oSymTable->psSlots;
+    size_t uOldSlotCount = oSymTable->uSlotCount;
+    struct SymTableSlot *psNewSlots;
+    size_t i;
+
+    if (uOldSlotCount > ((size_t)-1) / 2 / sizeof(struct SymTableSlot)) {
+        return 0;
+    }
+
+    psNewSlots = calloc(uOldSlotCount * 2, sizeof(struct SymTableSlot));
+    if (psNewSlots == NULL) {
+        return 0;
+    }
+
+    oSymTable->psSlots = psNewSlots;
+    oSymTable->uSlotCount = uOldSlotCount * 2;
+
+    for (i = 0; i < uOldSlotCount; i++)
+    {
+        if (psOldSlots[i].pcKey != NULL) {
+            SymTable_insert(oSymTable, &psOldSlots[i]);
+        }
+    }
+
+    free(psOldSlots);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings, or NULL if
+insufficient memory is available. */
+
+SymTable_T SymTable_new(void)
+{
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+
+    if (oSymTable == NULL)
+    {
+        return NULL;
+    }
+
+    oSymTable->psSlots = calloc(INITIAL_SLOT_COUNT,
+        sizeof(struct SymTableSlot));
+
+    if (oSymTable->psSlots == NULL)
+    {
+        free(oSymTable);
+        return NULL;
+    }
+
+    oSymTable->uSlotCount = INITIAL_SLOT_COUNT;
+
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oSymTable */
+
+void SymTable_free(SymTable_T oSymTable)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < oSymTable->uSlotCount; i++)
+    {
+        free((char *) oSymTable->psSlots[i].pcKey);
+    }
+
+    free(oSymTable->psSlots);
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable */
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+
+    return oSymTable->length;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new binding to oSymTable consisting of key pcKey and value
+pvValue and return 1 (TRUE) if oSymTable does not already contain a
+binding with key pcKey. Otherwise, if either oSymTable contains such a
+binding or insufficient memory is available, leave oSymTable unchanged
+and return 0 (FALSE). */
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void
+*pvValue)
+{
+    struct SymTableSlot sEntry;
+    char *pcKeyCopy;
+    size_t uHash;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+
+    if (SymTable_find(oSymTable, pcKey, uHash) != oSymTable->uSlotCount) {
+        return 0;
+    }
+
+    if ((oSymTable->length + 1) * MAX_LOAD_DENOMINATOR >
+    oSymTable->uSlotCount * MAX_LOAD_NUMERATOR) {
+        if (! SymTable_grow(oSymTable)) {
+            return 0;
+        }
+    }
+
+    /* defensive copy */
+    pcKeyCopy = (char*)malloc(strlen(pcKey) + 1);
+
+    if (pcKeyCopy == NULL)
+    {
+        return 0;
+    }
+
+    strcpy(pcKeyCopy, pcKey);
+    sEntry.pcKey = pcKeyCopy;
+    sEntry.pvValue = pvValue;
+    sEntry.uHash = uHash;
+    SymTable_insert(oSymTable, &sEntry);
+    oSymTable->length++;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, replace the binding's
+value with pvValue and return the old value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const
+void *pvValue)
+{
+    size_t uIndex;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uIndex == oSymTable->uSlotCount) {
+        return NULL;
+    }
+
+    oldval = (void *) oSymTable->psSlots[uIndex].pvValue;
+    oSymTable->psSlots[uIndex].pvValue = pvValue;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey,
+or 0 (FALSE) if otherwise. */
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey)) !=
+        oSymTable->uSlotCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is pcKey,
+or NULL if no such binding exists. */
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uIndex == oSymTable->uSlotCount) {
+        return NULL;
+    }
+
+    return (void *) oSymTable->psSlots[uIndex].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, remove that binding
+from oSymTable and return the binding's value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uMask;
+    size_t uIndex;
+    size_t uNext;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uIndex == oSymTable->uSlotCount) {
+        return NULL;
+    }
+
+    oldval = (void *) oSymTable->psSlots[uIndex].pvValue;
+    free((char *) oSymTable->psSlots[uIndex].pcKey);
+
+    /* backward shift: pull each following displaced binding one slot
+    closer to home, so no tombstone is needed */
+    uMask = oSymTable->uSlotCount - 1;
+    for (uNext = (uIndex + 1) & uMask;
+    oSymTable->psSlots[uNext].pcKey != NULL &&
+    SymTable_distance(oSymTable, uNext) != 0;
+    uNext = (uNext + 1) & uMask)
+    {
+        oSymTable->psSlots[uIndex] = oSymTable->psSlots[uNext];
+        uIndex = uNext;
+    }
+
+    oSymTable->psSlots[uIndex].pcKey = NULL;
+    oSymTable->psSlots[uIndex].pvValue = NULL;
+    oSymTable->psSlots[uIndex].uHash = 0;
+    oSymTable->length--;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable, passing pvExtra
+as an extra argument. That is, for each element pcKey and its value
+pvValue of oSymTable, call (*pfApply) (pcKey, pvValue, pvExtra).  */
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char
+*pcKey, void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    for (i = 0; i < oSymTable->uSlotCount; i++)
+    {
+        if (oSymTable->psSlots[i].pcKey != NULL) {
+            (*pfApply) ((char *) oSymTable->psSlots[i].pcKey,
+                (void*) oSymTable->psSlots[i].pvValue, (void*) pvExtra);
+        }
+    }
+}
@@ -0,0 +1,648 @@
+/*--------------------------------------------------------------------*/
+/* symtableswiss.c                                                    */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SYMTABLE_HAVE_SSE2
+#include <immintrin.h>
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The slots are divided into groups of GROUP_WIDTH. Each slot has one
+control byte, and a whole group of control bytes is compared against a
+tag at once: by one AVX2 compare, two SSE2 compares, or a byte loop. A
+control byte is CTRL_EMPTY, CTRL_DELETED, or, for a slot that holds a
+binding, the low 7 bits of the binding's hash code. */
+
+enum {GROUP_WIDTH = 32};
+
+enum {CTRL_EMPTY = 0x80, CTRL_DELETED = 0xFE, CTRL_TAG_MASK = 0x7F};
+
+enum {INITIAL_GROUP_COUNT = 1};
+
+/* The table is rebuilt before more than MAX_LOAD_NUMERATOR /
+MAX_LOAD_DENOMINATOR of its slots are in use or deleted. */
+
+enum {MAX_LOAD_NUMERATOR = 7, MAX_LOAD_DENOMINATOR = 8};
+
+/*--------------------------------------------------------------------*/
+
+/* Each binding is stored in a SymTableSlot. */
+
+struct SymTableSlot
+{
+    /* The binding's key. */
+    const char *pcKey;
+
+    /* The value associated with the binding's key. */
+    const void *pvValue;
+
+    /* The full hash code of the binding's key. */
+    size_t uHash;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is an open addressing hash table whose probe sequence
+visits whole groups of slots. */
+
+struct SymTable
+{
+    /* The control bytes, one per slot. */
+    unsigned char *pucCtrl;
+
+    /* The address of the first SymTableSlot */
+    struct SymTableSlot *psSlots;
+
+    /* The number of groups, always a power of two. */
+    size_t uGroupCount;
+
+    /* number of bindings in symtable */
+    size_t length;
+
+    /* The number of empty slots that may still be filled before the
+    table must be rebuilt. */
+    size_t uGrowthLeft;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask whose bit i is set if control byte i of the group
+at pucGroup equals ucCtrl. */
+
+static unsigned SymTable_matchScalar(const unsigned char *pucGroup,
+    unsigned char ucCtrl)
+{
+    unsigned uMask = 0;
+    int i;
+
+    for (i = 0; i < GROUP_WIDTH; i++)
+    {
+        if (pucGroup[i] == ucCtrl) {
+            uMask |= 1U << i;
+        }
+    }
+
+    return uMask;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a bit mask whose bit i is set if slot i of the group at
+pucGroup is empty or deleted. */
+
+static unsigned SymTable_matchFreeScalar(const unsigned char *pucGroup)
+{
+    unsigned uMask = 0;
+    int i;
+
+    for (i = 0; i < GROUP_WIDTH; i++)
+    {
+        if ((pucGroup[i] & CTRL_EMPTY) != 0) {
+            uMask |= 1U << i;
+        }
+    }
+
+    return uMask;
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_HAVE_SSE2
+
+/* SSE2 version of SymTable_matchScalar: compare the two halves of the
+group, 16 control bytes per instruction. */
+
+__attribute__((target("sse2")))
+static unsigned SymTable_matchSse2(const unsigned char *pucGroup,
+    unsigned char ucCtrl)
+{
+    __m128i xCtrl = _mm_set1_epi8((char)ucCtrl);
+    __m128i xLow = _mm_loadu_si128((const __m128i *)pucGroup);
+    __m128i xHigh = _mm_loadu_si128((const __m128i *)(pucGroup + 16));
+
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(xLow, xCtrl)) |
+        (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(xHigh, xCtrl)) << 16;
+}
+
+/* SSE2 version of SymTable_matchFreeScalar. Empty and deleted control
+bytes are exactly those with the high bit set. */
+
+__attribute__((target("sse2")))
+static unsigned SymTable_matchFreeSse2(const unsigned char *pucGroup)
+{
+    return (unsigned)_mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *)pucGroup)) |
+        (unsigned)_mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *)(pucGroup + 16))) << 16;
+}
+
+/* AVX2 version of SymTable_matchScalar: compare all 32 control bytes
+with one instruction. */
+
+__attribute__((target("avx2")))
+static unsigned SymTable_matchAvx2(const unsigned char *pucGroup,
+    unsigned char ucCtrl)
+{
+    __m256i yGroup = _mm256_loadu_si256((const __m256i *)pucGroup);
+
+    return (unsigned)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(yGroup, _mm256_set1_epi8((char)ucCtrl)));
+}
+
+/* AVX2 version of SymTable_matchFreeScalar. */
+
+__attribute__((target("avx2")))
+static unsigned SymTable_matchFreeAvx2(const unsigned char *pucGroup)
+{
+    return (unsigned)_mm256_movemask_epi8(
+        _mm256_loadu_si256((const __m256i *)pucGroup));
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* The group matching functions in use, chosen at run time by
+SymTable_selectEngine. */
+
+static unsigned (*pfMatch)(const unsigned char *pucGroup,
+    unsigned char ucCtrl) = NULL;
+
+static unsigned (*pfMatchFree)(const unsigned char *pucGroup) = NULL;
+
+/*--------------------------------------------------------------------*/
+
+/* Choose the AVX2 group matching functions if the processor supports
+them, else the SSE2 ones if it supports those, or the scalar ones
+otherwise. Setting the environment variable SYMTABLE_NO_AVX2 rules out
+the AVX2 functions, and setting SYMTABLE_NO_SIMD forces the scalar
+functions, so that every path can be tested on one machine. */
+
+static void SymTable_selectEngine(void)
+{
+    if (pfMatch != NULL) {
+        return;
+    }
+
+    pfMatchFree = SymTable_matchFreeScalar;
+    pfMatch = SymTable_matchScalar;
+
+#ifdef SYMTABLE_HAVE_SSE2
+    if (getenv("SYMTABLE_NO_SIMD") != NULL) {
+        return;
+    }
+    if (getenv("SYMTABLE_NO_AVX2") == NULL &&
+    __builtin_cpu_supports("avx2")) {
+        pfMatchFree = SymTable_matchFreeAvx2;
+        pfMatch = SymTable_matchAvx2;
+    }
+    else if (__builtin_cpu_supports("sse2")) {
+        pfMatchFree = SymTable_matchFreeSse2;
+        pfMatch = SymTable_matchSse2;
+    }
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the lowest set bit of uMask, which must not be
+0. */
+
+static size_t SymTable_lowestBit(unsigned uMask)
+{
+#ifdef __GNUC__
+    return (size_t)__builtin_ctz(uMask);
+#else
+    size_t u = 0;
+
+    while ((uMask & 1U) == 0) {
+        uMask >>= 1;
+        u++;
+    }
+    return u;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a hash code for pcKey. The 65599 hash is mixed afterwards
+so that both the tag bits and the group bits depend on every character
+of pcKey. */
+
+static size_t SymTable_hash(const char *pcKey)
+{
+   const size_t HASH_MULTIPLIER = 65599;
+   size_t u;
+   size_t uHash = 0;
+
+   assert(pcKey != NULL);
+
+   for (u = 0; pcKey[u] != '\0'; u++)
+   {
+        uHash = uHash * HASH_MULTIPLIER + (size_t)pcKey[u];
+   }
+
+   uHash ^= uHash >> 17;
+   uHash *= 0xed5ad4bbU;
+   uHash ^= uHash >> 11;
+
+   return uHash;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings that oSymTable can hold when it has
+uGroupCount groups. */
+
+static size_t SymTable_capacity(size_t uGroupCount)
+{
+    return uGroupCount * GROUP_WIDTH / MAX_LOAD_DENOMINATOR *
+        MAX_LOAD_NUMERATOR;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the slot of oSymTable that holds the binding with
+key pcKey whose hash code is uHash, or the slot count if there is no
+such binding. The groups are probed in triangular order, which visits
+every group when the group count is a power of two. */
+
+static size_t SymTable_find(SymTable_T oSymTable, const char *pcKey,
+    size_t uHash)
+{
+    size_t uGroupMask = oSymTable->uGroupCount - 1;
+    size_t uGroup = (uHash >> 7) & uGroupMask;
+    size_t uProbe = 0;
+    unsigned char ucTag = (unsigned char)(uHash & CTRL_TAG_MASK);
+    const unsigned char *pucGroup;
+    struct SymTableSlot *psSlot;
+    unsigned uMatch;
+
+    for (;;)
+    {
+        pucGroup = oSymTable->pucCtrl + uGroup * GROUP_WIDTH;
+
+        for (uMatch = (*pfMatch)(pucGroup, ucTag); uMatch != 0;
+        uMatch &= uMatch - 1)
+        {
+            psSlot = &oSymTable->psSlots[uGroup * GROUP_WIDTH +
+                SymTable_lowestBit(uMatch)];
+            if (psSlot->uHash == uHash &&
+            strcmp(psSlot->pcKey, pcKey) == 0) {
+                return (size_t)(psSlot - oSymTable->psSlots);
+            }
+        }
+
+        /* An insertion only moves on from a group that is full, so a
+        group with an empty slot ends the probe sequence. */
+        if ((*pfMatch)(pucGroup, CTRL_EMPTY) != 0) {
+            return oSymTable->uGroupCount * GROUP_WIDTH;
+        }
+
+        uProbe++;
+        uGroup = (uGroup + uProbe) & uGroupMask;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Store the binding *psEntry in the first empty or deleted slot on
+its probe sequence. oSymTable must not already contain its key and must
+have uGrowthLeft > 0. */
+
+static void SymTable_insert(SymTable_T oSymTable,
+    const struct SymTableSlot *psEntry)
+{
+    size_t uGroupMask = oSymTable->uGroupCount - 1;
+    size_t uGroup = (psEntry->uHash >> 7) & uGroupMask;
+    size_t uProbe = 0;
+    size_t uIndex;
+    unsigned uFree;
+
+    for (;;)
+    {
+        uFree = (*pfMatchFree)(oSymTable->pucCtrl + uGroup * GROUP_WIDTH);
+        if (uFree != 0) {
+            break;
+        }
+        uProbe++;
+        uGroup = (uGroup + uProbe) & uGroupMask;
+    }
+
+    uIndex = uGroup * GROUP_WIDTH + SymTable_lowestBit(uFree);
+    if (oSymTable->pucCtrl[uIndex] == CTRL_EMPTY) {
+        oSymTable->uGrowthLeft--;
+    }
+    oSymTable->pucCtrl[uIndex] =
+        (unsigned char)(psEntry->uHash & CTRL_TAG_MASK);
+    oSymTable->psSlots[uIndex] = *psEntry;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move every binding of oSymTable into new arrays of uGroupCount
+groups, dropping all deleted slots. Return 1 (TRUE) on success, or
+0 (FALSE) and leave oSymTable unchanged if insufficient memory is
+available. */
+
+static int SymTable_rehash(SymTable_T oSymTable, size_t uGroupCount)
+{
+    unsigned char *pucOldCtrl = oSymTable->pucCtrl;
+    struct SymTableSlot *psOldSlots = oSymTable->psSlots;
+    size_t uOldSlotCount = oSymTable->uGroupCount * GROUP_WIDTH;
+    unsigned char *pucCtrl;
+    struct SymTableSlot *psSlots;
+    size_t i;
+
+    if (uGroupCount > ((size_t)-1) / GROUP_WIDTH /
+    sizeof(struct SymTableSlot)) {
+        return 0;
+    }
+
+    pucCtrl = (unsigned char *)malloc(uGroupCount * GROUP_WIDTH);
+    psSlots = (struct SymTableSlot *)malloc(uGroupCount * GROUP_WIDTH *
+        sizeof(struct SymTableSlot));
+
+    if (pucCtrl == NULL || psSlots == NULL) {
+        free(pucCtrl);
+        free(psSlots);
+        return 0;
+    }
+
+    memset(pucCtrl, CTRL_EMPTY, uGroupCount * GROUP_WIDTH);
+    oSymTable->pucCtrl = pucCtrl;
+    oSymTable->psSlots = psSlots;
+    oSymTable->uGroupCount = uGroupCount;
+    oSymTable->uGrowthLeft = SymTable_capacity(uGroupCount);
+
+    for (i = 0; i < uOldSlotCount; i++)
+    {
+        if ((pucOldCtrl[i] & CTRL_EMPTY) == 0) {
+            SymTable_insert(oSymTable, &psOldSlots[i]);
+        }
+    }
+
+    free(pucOldCtrl);
+    free(psOldSlots);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings, or NULL if
+insufficient memory is available. */
+
+SymTable_T SymTable_new(void)
+{
+    SymTable_T oSymTable;
+
+    SymTable_selectEngine();
+
+    oSymTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+
+    if (oSymTable == NULL)
+    {
+        return NULL;
+    }
+
+    oSymTable->pucCtrl = (unsigned char *)malloc(INITIAL_GROUP_COUNT *
+        GROUP_WIDTH);
+    oSymTable->psSlots = (struct SymTableSlot *)malloc(
+        INITIAL_GROUP_COUNT * GROUP_WIDTH * sizeof(struct SymTableSlot));
+
+    if (oSymTable->pucCtrl == NULL || oSymTable->psSlots == NULL)
+    {
+        free(oSymTable->pucCtrl);
+        free(oSymTable->psSlots);
+        free(oSymTable);
+        return NULL;
+    }
+
+    memset(oSymTable->pucCtrl, CTRL_EMPTY,
+        INITIAL_GROUP_COUNT * GROUP_WIDTH);
+    oSymTable->uGroupCount = INITIAL_GROUP_COUNT;
+    oSymTable->uGrowthLeft = SymTable_capacity(INITIAL_GROUP_COUNT);
+
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oSymTable */
+
+void SymTable_free(SymTable_T oSymTable)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+
+    for (i = 0; i < oSymTable->uGroupCount * GROUP_WIDTH; i++)
+    {
+        if ((oSymTable->pucCtrl[i] & CTRL_EMPTY) == 0) {
+            free((char *) oSymTable->psSlots[i].pcKey);
+        }
+    }
+
+    free(oSymTable->pucCtrl);
+    free(oSymTable->psSlots);
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable */
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+
+    return oSymTable->length;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new binding to oSymTable consisting of key pcKey and value
+pvValue and return 1 (TRUE) if oSymTable does not already contain a
+binding with key pcKey. Otherwise, if either oSymTable contains such a
+binding or insufficient memory is available, leave oSymTable unchanged
+and return 0 (FALSE). */
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void
+*pvValue)
+{
+    struct SymTableSlot sEntry;
+    char *pcKeyCopy;
+    size_t uHash;
+    size_t uGroupCount;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uHash = SymTable_hash(pcKey);
+
+    if (SymTable_find(oSymTable, pcKey, uHash) !=
+    oSymTable->uGroupCount * GROUP_WIDTH) {
+        return 0;
+    }
+
+    if (oSymTable->uGrowthLeft == 0)
+    {
+        /* Double the table unless deleted slots, which a rebuild at
+        the same size reclaims, account for at least half the load. */
+        uGroupCount = oSymTable->uGroupCount;
+        if (oSymTable->length * 2 >= SymTable_capacity(uGroupCount)) {
+            uGroupCount *= 2;
+        }
+        if (! SymTable_rehash(oSymTable, uGroupCount)) {
+            return 0;
+        }
+    }
+
+    /* defensive copy */
+    pcKeyCopy = (char*)malloc(strlen(pcKey) + 1);
+
+    if (pcKeyCopy == NULL)
+    {
+        return 0;
+    }
+
+    strcpy(pcKeyCopy, pcKey);
+    sEntry.pcKey = pcKeyCopy;
+    sEntry.pvValue = pvValue;
+    sEntry.uHash = uHash;
+    SymTable_insert(oSymTable, &sEntry);
+    oSymTable->length++;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, replace the binding's
+value with pvValue and return the old value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const
+void *pvValue)
+{
+    size_t uIndex;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH) {
+        return NULL;
+    }
+
+    oldval = (void *) oSymTable->psSlots[uIndex].pvValue;
+    oSymTable->psSlots[uIndex].pvValue = pvValue;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey,
+or 0 (FALSE) if otherwise. */
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    return SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey)) !=
+        oSymTable->uGroupCount * GROUP_WIDTH;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is pcKey,
+or NULL if no such binding exists. */
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH) {
+        return NULL;
+    }
+
+    return (void *) oSymTable->psSlots[uIndex].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, remove that binding
+from oSymTable and return the binding's value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+    size_t uIndex;
+    const unsigned char *pucGroup;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    uIndex = SymTable_find(oSymTable, pcKey, SymTable_hash(pcKey));
+
+    if (uIndex == oSymTable->uGroupCount * GROUP_WIDTH) {
+        return NULL;
+    }
+
+    oldval = (void *) oSymTable->psSlots[uIndex].pvValue;
+    free((char *) oSymTable->psSlots[uIndex].pcKey);
+
+    /* If the group already has an empty slot, no probe sequence
+    continues past it, so the slot can become empty again. Otherwise
+    it must stay deleted so later groups remain reachable. */
+    pucGroup = oSymTable->pucCtrl + uIndex / GROUP_WIDTH * GROUP_WIDTH;
+    if ((*pfMatch)(pucGroup, CTRL_EMPTY) != 0) {
+        oSymTable->pucCtrl[uIndex] = CTRL_EMPTY;
+        oSymTable->uGrowthLeft++;
+    }
+    else {
+        oSymTable->pucCtrl[uIndex] = CTRL_DELETED;
+    }
+
+    oSymTable->length--;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable, passing pvExtra
+as an extra argument. That is, for each element pcKey and its value
+pvValue of oSymTable, call (*pfApply) (pcKey, pvValue, pvExtra).  */
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char
+*pcKey, void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    size_t i;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    for (i = 0; i < oSymTable->uGroupCount * GROUP_WIDTH; i++)
+    {
+        if ((oSymTable->pucCtrl[i] & CTRL_EMPTY) == 0) {
+            (*pfApply) ((char *) oSymTable->psSlots[i].pcKey,
+                (void*) oSymTable->psSlots[i].pvValue, (void*) pvExtra);
+        }
+    }
+}
@@ -0,0 +1,821 @@
+/*--------------------------------------------------------------------*/
+/* symtabletree.c                                                     */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include "symtable.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The bindings are kept in a B+-tree ordered by strcmp. Every binding
+is in a leaf, and the leaves are linked in key order, so a walk over
+any range of keys reads whole leaves one after another. A node holds up
+to MAX_KEYS keys; the key array, with its spare entry for a node that
+is about to split, fills two cache lines. Every node but the root holds
+at least MIN_KEYS keys. */
+
+enum {MAX_KEYS = 15, MIN_KEYS = MAX_KEYS / 2};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTableNode is a leaf or an inner node of the tree. An inner node
+with uCount keys has uCount + 1 children, and key i is the smallest key
+under child i + 1. The keys of an inner node are the very strings that
+the leaves own, never copies. */
+
+struct SymTableNode
+{
+    /* The number of keys in the node. */
+    size_t uCount;
+
+    /* The keys, in increasing order. */
+    const char *apcKeys[MAX_KEYS + 1];
+
+    union
+    {
+        /* For a leaf, the value of each key. */
+        const void *apvValues[MAX_KEYS + 1];
+
+        /* For an inner node, the children. */
+        struct SymTableNode *apsChildren[MAX_KEYS + 2];
+    } u;
+
+    /* For a leaf, the address of the next leaf in key order, or NULL
+    for the last. For a spare node, the address of the next spare. */
+    struct SymTableNode *psNextLeaf;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* A SymTable is the root of a B+-tree. */
+
+struct SymTable
+{
+    /* The root node, a leaf if uHeight is 0. */
+    struct SymTableNode *psRoot;
+
+    /* The number of inner levels above the leaves. */
+    size_t uHeight;
+
+    /* number of bindings in symtable */
+    size_t length;
+
+    /* Nodes set aside so that a put never fails halfway through its
+    splits, linked through psNextLeaf, and the number of them. */
+    struct SymTableNode *psSpare;
+    size_t uSpareCount;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first key of psNode greater than pcKey. In
+an inner node, that is the index of the child whose keys pcKey lies
+among. */
+
+static size_t SymTable_upperBound(struct SymTableNode *psNode,
+    const char *pcKey)
+{
+    size_t uLow = 0;
+    size_t uHigh = psNode->uCount;
+    size_t uMiddle;
+
+    while (uLow < uHigh)
+    {
+        uMiddle = (uLow + uHigh) / 2;
+        if (strcmp(psNode->apcKeys[uMiddle], pcKey) <= 0) {
+            uLow = uMiddle + 1;
+        }
+        else {
+            uHigh = uMiddle;
+        }
+    }
+    return uLow;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the first key of psNode not less than pcKey. */
+
+static size_t SymTable_lowerBound(struct SymTableNode *psNode,
+    const char *pcKey)
+{
+    size_t uLow = 0;
+    size_t uHigh = psNode->uCount;
+    size_t uMiddle;
+
+    while (uLow < uHigh)
+    {
+        uMiddle = (uLow + uHigh) / 2;
+        if (strcmp(psNode->apcKeys[uMiddle], pcKey) < 0) {
+            uLow = uMiddle + 1;
+        }
+        else {
+            uHigh = uMiddle;
+        }
+    }
+    return uLow;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the leaf of oSymTable that a binding with key pcKey belongs
+in. */
+
+static struct SymTableNode *SymTable_findLeaf(SymTable_T oSymTable,
+    const char *pcKey)
+{
+    struct SymTableNode *psNode = oSymTable->psRoot;
+    size_t uLevel;
+
+    for (uLevel = oSymTable->uHeight; uLevel > 0; uLevel--)
+    {
+        psNode = psNode->u.apsChildren[SymTable_upperBound(psNode, pcKey)];
+    }
+    return psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the index of the binding with key pcKey in leaf psLeaf, or
+psLeaf->uCount if there is none. */
+
+static size_t SymTable_findInLeaf(struct SymTableNode *psLeaf,
+    const char *pcKey)
+{
+    size_t uIndex = SymTable_lowerBound(psLeaf, pcKey);
+
+    if (uIndex < psLeaf->uCount &&
+    strcmp(psLeaf->apcKeys[uIndex], pcKey) == 0) {
+        return uIndex;
+    }
+    return psLeaf->uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Make oSymTable hold at least uCount spare nodes. Return 1 (TRUE) on
+success, or 0 (FALSE) if insufficient memory is available. */
+
+static int SymTable_reserveNodes(SymTable_T oSymTable, size_t uCount)
+{
+    struct SymTableNode *psNode;
+
+    while (oSymTable->uSpareCount < uCount)
+    {
+        psNode = (struct SymTableNode *)malloc(sizeof(struct SymTableNode));
+        if (psNode == NULL) {
+            return 0;
+        }
+        psNode->psNextLeaf = oSymTable->psSpare;
+        oSymTable->psSpare = psNode;
+        oSymTable->uSpareCount++;
+    }
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return an empty node from the spares of oSymTable, which must have
+one. */
+
+static struct SymTableNode *SymTable_takeNode(SymTable_T oSymTable)
+{
+    struct SymTableNode *psNode = oSymTable->psSpare;
+
+    assert(psNode != NULL);
+
+    oSymTable->psSpare = psNode->psNextLeaf;
+    oSymTable->uSpareCount--;
+    psNode->uCount = 0;
+    psNode->psNextLeaf = NULL;
+    return psNode;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Give psNode, which is no longer in the tree, back to oSymTable. It
+is kept as a spare if the next put might need it, and freed
+otherwise. */
+
+static void SymTable_releaseNode(SymTable_T oSymTable,
+    struct SymTableNode *psNode)
+{
+    if (oSymTable->uSpareCount >= oSymTable->uHeight + 2) {
+        free(psNode);
+        return;
+    }
+    psNode->psNextLeaf = oSymTable->psSpare;
+    oSymTable->psSpare = psNode;
+    oSymTable->uSpareCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move the upper half of psNode, which has MAX_KEYS + 1 keys, into the
+empty node psRight, and return the key that separates the two. An inner
+node gives that key up to its parent; a leaf keeps it as the first key
+of psRight. */
+
+static const char *SymTable_split(struct SymTableNode *psNode,
+    size_t uLevel, struct SymTableNode *psRight)
+{
+    size_t uKeep = (MAX_KEYS + 1) / 2;
+    const char *pcSeparator;
+
+    if (uLevel == 0) {
+        psRight->uCount = MAX_KEYS + 1 - uKeep;
+        memcpy(psRight->apcKeys, &psNode->apcKeys[uKeep],
+            psRight->uCount * sizeof(const char *));
+        memcpy(psRight->u.apvValues, &psNode->u.apvValues[uKeep],
+            psRight->uCount * sizeof(const void *));
+        psNode->uCount = uKeep;
+        psRight->psNextLeaf = psNode->psNextLeaf;
+        psNode->psNextLeaf = psRight;
+        return psRight->apcKeys[0];
+    }
+
+    pcSeparator = psNode->apcKeys[uKeep];
+    psRight->uCount = MAX_KEYS - uKeep;
+    memcpy(psRight->apcKeys, &psNode->apcKeys[uKeep + 1],
+        psRight->uCount * sizeof(const char *));
+    memcpy(psRight->u.apsChildren, &psNode->u.apsChildren[uKeep + 1],
+        (psRight->uCount + 1) * sizeof(struct SymTableNode *));
+    psNode->uCount = uKeep;
+    return pcSeparator;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a binding of pcKey, which the subtree psNode at uLevel does not
+contain, to pvValue. If psNode overflows, split it, store the new right
+half in *ppsRight and the key separating the halves in *ppcSeparator,
+and return 1 (TRUE); otherwise return 0 (FALSE). */
+
+static int SymTable_insert(SymTable_T oSymTable,
+    struct SymTableNode *psNode, size_t uLevel, const char *pcKey,
+    const void *pvValue, struct SymTableNode **ppsRight,
+    const char **ppcSeparator)
+{
+    struct SymTableNode *psChildRight;
+    const char *pcChildSeparator;
+    size_t uIndex;
+
+    uIndex = SymTable_upperBound(psNode, pcKey);
+
+    if (uLevel == 0) {
+        memmove(&psNode->apcKeys[uIndex + 1], &psNode->apcKeys[uIndex],
+            (psNode->uCount - uIndex) * sizeof(const char *));
+        memmove(&psNode->u.apvValues[uIndex + 1],
+            &psNode->u.apvValues[uIndex],
+            (psNode->uCount - uIndex) * sizeof(const void *));
+        psNode->apcKeys[uIndex] = pcKey;
+        psNode->u.apvValues[uIndex] = pvValue;
+    }
+    else {
+        if (! SymTable_insert(oSymTable, psNode->u.apsChildren[uIndex],
+        uLevel - 1, pcKey, pvValue, &psChildRight, &pcChildSeparator)) {
+            return 0;
+        }
+        memmove(&psNode->apcKeys[uIndex + 1], &psNode->apcKeys[uIndex],
+            (psNode->uCount - uIndex) * sizeof(const char *));
+        memmove(&psNode->u.apsChildren[uIndex + 2],
+            &psNode->u.apsChildren[uIndex + 1],
+            (psNode->uCount - uIndex) * sizeof(struct SymTableNode *));
+        psNode->apcKeys[uIndex] = pcChildSeparator;
+        psNode->u.apsChildren[uIndex + 1] = psChildRight;
+    }
+    psNode->uCount++;
+
+    if (psNode->uCount <= MAX_KEYS) {
+        return 0;
+    }
+
+    *ppsRight = SymTable_takeNode(oSymTable);
+    *ppcSeparator = SymTable_split(psNode, uLevel, *ppsRight);
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move one key into child uIndex of the inner node psParent, a node at
+uLevel, from its left sibling. */
+
+static void SymTable_borrowLeft(struct SymTableNode *psParent,
+    size_t uIndex, size_t uLevel)
+{
+    struct SymTableNode *psChild = psParent->u.apsChildren[uIndex];
+    struct SymTableNode *psLeft = psParent->u.apsChildren[uIndex - 1];
+
+    memmove(&psChild->apcKeys[1], &psChild->apcKeys[0],
+        psChild->uCount * sizeof(const char *));
+
+    if (uLevel == 0) {
+        memmove(&psChild->u.apvValues[1], &psChild->u.apvValues[0],
+            psChild->uCount * sizeof(const void *));
+        psChild->apcKeys[0] = psLeft->apcKeys[psLeft->uCount - 1];
+        psChild->u.apvValues[0] = psLeft->u.apvValues[psLeft->uCount - 1];
+        psParent->apcKeys[uIndex - 1] = psChild->apcKeys[0];
+    }
+    else {
+        memmove(&psChild->u.apsChildren[1], &psChild->u.apsChildren[0],
+            (psChild->uCount + 1) * sizeof(struct SymTableNode *));
+        psChild->apcKeys[0] = psParent->apcKeys[uIndex - 1];
+        psChild->u.apsChildren[0] = psLeft->u.apsChildren[psLeft->uCount];
+        psParent->apcKeys[uIndex - 1] = psLeft->apcKeys[psLeft->uCount - 1];
+    }
+
+    psLeft->uCount--;
+    psChild->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Move one key into child uIndex of the inner node psParent, a node at
+uLevel, from its right sibling. */
+
+static void SymTable_borrowRight(struct SymTableNode *psParent,
+    size_t uIndex, size_t uLevel)
+{
+    struct SymTableNode *psChild = psParent->u.apsChildren[uIndex];
+    struct SymTableNode *psRight = psParent->u.apsChildren[uIndex + 1];
+
+    if (uLevel == 0) {
+        psChild->apcKeys[psChild->uCount] = psRight->apcKeys[0];
+        psChild->u.apvValues[psChild->uCount] = psRight->u.apvValues[0];
+        memmove(&psRight->u.apvValues[0], &psRight->u.apvValues[1],
+            (psRight->uCount - 1) * sizeof(const void *));
+        memmove(&psRight->apcKeys[0], &psRight->apcKeys[1],
+            (psRight->uCount - 1) * sizeof(const char *));
+        psParent->apcKeys[uIndex] = psRight->apcKeys[0];
+    }
+    else {
+        psChild->apcKeys[psChild->uCount] = psParent->apcKeys[uIndex];
+        psChild->u.apsChildren[psChild->uCount + 1] =
+            psRight->u.apsChildren[0];
+        psParent->apcKeys[uIndex] = psRight->apcKeys[0];
+        memmove(&psRight->apcKeys[0], &psRight->apcKeys[1],
+            (psRight->uCount - 1) * sizeof(const char *));
+        memmove(&psRight->u.apsChildren[0], &psRight->u.apsChildren[1],
+            psRight->uCount * sizeof(struct SymTableNode *));
+    }
+
+    psRight->uCount--;
+    psChild->uCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Merge child uIndex + 1 of the inner node psParent, a node at uLevel,
+into child uIndex, and give the emptied node back to oSymTable. */
+
+static void SymTable_mergeNodes(SymTable_T oSymTable,
+    struct SymTableNode *psParent, size_t uIndex, size_t uLevel)
+{
+    struct SymTableNode *psLeft = psParent->u.apsChildren[uIndex];
+    struct SymTableNode *psRight = psParent->u.apsChildren[uIndex + 1];
+
+    if (uLevel == 0) {
+        memcpy(&psLeft->apcKeys[psLeft->uCount], psRight->apcKeys,
+            psRight->uCount * sizeof(const char *));
+        memcpy(&psLeft->u.apvValues[psLeft->uCount], psRight->u.apvValues,
+            psRight->uCount * sizeof(const void *));
+        psLeft->uCount += psRight->uCount;
+        psLeft->psNextLeaf = psRight->psNextLeaf;
+    }
+    else {
+        psLeft->apcKeys[psLeft->uCount] = psParent->apcKeys[uIndex];
+        memcpy(&psLeft->apcKeys[psLeft->uCount + 1], psRight->apcKeys,
+            psRight->uCount * sizeof(const char *));
+        memcpy(&psLeft->u.apsChildren[psLeft->uCount + 1],
+            psRight->u.apsChildren,
+            (psRight->uCount + 1) * sizeof(struct SymTableNode *));
+        psLeft->uCount += psRight->uCount + 1;
+    }
+
+    memmove(&psParent->apcKeys[uIndex], &psParent->apcKeys[uIndex + 1],
+        (psParent->uCount - uIndex - 1) * sizeof(const char *));
+    memmove(&psParent->u.apsChildren[uIndex + 1],
+        &psParent->u.apsChildren[uIndex + 2],
+        (psParent->uCount - uIndex - 1) * sizeof(struct SymTableNode *));
+    psParent->uCount--;
+
+    SymTable_releaseNode(oSymTable, psRight);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Bring child uIndex of the inner node psParent, a node at uLevel that
+has fallen below MIN_KEYS keys, back up to MIN_KEYS, by borrowing from
+a sibling that can spare a key or else by merging with one. */
+
+static void SymTable_rebalance(SymTable_T oSymTable,
+    struct SymTableNode *psParent, size_t uIndex, size_t uLevel)
+{
+    if (uIndex > 0 &&
+    psParent->u.apsChildren[uIndex - 1]->uCount > MIN_KEYS) {
+        SymTable_borrowLeft(psParent, uIndex, uLevel);
+    }
+    else if (uIndex < psParent->uCount &&
+    psParent->u.apsChildren[uIndex + 1]->uCount > MIN_KEYS) {
+        SymTable_borrowRight(psParent, uIndex, uLevel);
+    }
+    else if (uIndex > 0) {
+        SymTable_mergeNodes(oSymTable, psParent, uIndex - 1, uLevel);
+    }
+    else {
+        SymTable_mergeNodes(oSymTable, psParent, uIndex, uLevel);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the binding of pcKey, which the subtree psNode at uLevel
+contains, and store its key and value in *ppcOldKey and *ppvOldValue.
+ppcMatch is the address of the inner key above psNode that is the
+same string as the binding's key, or NULL if there is none; since that
+string is about to be freed, it is replaced by the leaf's new first
+key. */
+
+static void SymTable_delete(SymTable_T oSymTable,
+    struct SymTableNode *psNode, size_t uLevel, const char *pcKey,
+    const char **ppcMatch, const char **ppcOldKey, void **ppvOldValue)
+{
+    struct SymTableNode *psChild;
+    size_t uIndex;
+
+    if (uLevel == 0) {
+        uIndex = SymTable_findInLeaf(psNode, pcKey);
+        assert(uIndex < psNode->uCount);
+
+        *ppcOldKey = psNode->apcKeys[uIndex];
+        *ppvOldValue = (void *) psNode->u.apvValues[uIndex];
+        memmove(&psNode->apcKeys[uIndex], &psNode->apcKeys[uIndex + 1],
+            (psNode->uCount - uIndex - 1) * sizeof(const char *));
+        memmove(&psNode->u.apvValues[uIndex],
+            &psNode->u.apvValues[uIndex + 1],
+            (psNode->uCount - uIndex - 1) * sizeof(const void *));
+        psNode->uCount--;
+
+        if (ppcMatch != NULL) {
+            assert(uIndex == 0 && psNode->uCount > 0);
+            *ppcMatch = psNode->apcKeys[0];
+        }
+        return;
+    }
+
+    uIndex = SymTable_upperBound(psNode, pcKey);
+    if (uIndex > 0 && strcmp(psNode->apcKeys[uIndex - 1], pcKey) == 0) {
+        ppcMatch = &psNode->apcKeys[uIndex - 1];
+    }
+
+    psChild = psNode->u.apsChildren[uIndex];
+    SymTable_delete(oSymTable, psChild, uLevel - 1, pcKey, ppcMatch,
+        ppcOldKey, ppvOldValue);
+
+    if (psChild->uCount < MIN_KEYS) {
+        SymTable_rebalance(oSymTable, psNode, uIndex, uLevel - 1);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free the subtree psNode at uLevel, including the keys of its
+leaves. */
+
+static void SymTable_freeNode(struct SymTableNode *psNode, size_t uLevel)
+{
+    size_t i;
+
+    if (uLevel == 0) {
+        for (i = 0; i < psNode->uCount; i++)
+        {
+            free((char *) psNode->apcKeys[i]);
+        }
+    }
+    else {
+        for (i = 0; i <= psNode->uCount; i++)
+        {
+            SymTable_freeNode(psNode->u.apsChildren[i], uLevel - 1);
+        }
+    }
+    free(psNode);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a new SymTable object with no bindings, or NULL if
+insufficient memory is available. */
+
+SymTable_T SymTable_new(void)
+{
+    SymTable_T oSymTable;
+
+    oSymTable = (SymTable_T)calloc(1, sizeof(struct SymTable));
+
+    if (oSymTable == NULL)
+    {
+        return NULL;
+    }
+
+    oSymTable->psRoot = (struct SymTableNode *)calloc(1,
+        sizeof(struct SymTableNode));
+
+    if (oSymTable->psRoot == NULL)
+    {
+        free(oSymTable);
+        return NULL;
+    }
+
+    return oSymTable;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Free all memory occupied by oSymTable */
+
+void SymTable_free(SymTable_T oSymTable)
+{
+    struct SymTableNode *psNextNode;
+
+    assert(oSymTable != NULL);
+
+    SymTable_freeNode(oSymTable->psRoot, oSymTable->uHeight);
+
+    while (oSymTable->psSpare != NULL)
+    {
+        psNextNode = oSymTable->psSpare->psNextLeaf;
+        free(oSymTable->psSpare);
+        oSymTable->psSpare = psNextNode;
+    }
+
+    free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of bindings in oSymTable */
+
+size_t SymTable_getLength(SymTable_T oSymTable)
+{
+    assert(oSymTable != NULL);
+
+    return oSymTable->length;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add a new binding to oSymTable consisting of key pcKey and value
+pvValue and return 1 (TRUE) if oSymTable does not already contain a
+binding with key pcKey. Otherwise, if either oSymTable contains such a
+binding or insufficient memory is available, leave oSymTable unchanged
+and return 0 (FALSE). */
+
+int SymTable_put(SymTable_T oSymTable, const char *pcKey, const void
+*pvValue)
+{
+    struct SymTableNode *psLeaf;
+    struct SymTableNode *psRight;
+    struct SymTableNode *psRoot;
+    const char *pcSeparator;
+    char *pcKeyCopy;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psLeaf = SymTable_findLeaf(oSymTable, pcKey);
+    if (SymTable_findInLeaf(psLeaf, pcKey) != psLeaf->uCount) {
+        return 0;
+    }
+
+    /* a node for every level that may split, and one for a new root */
+    if (! SymTable_reserveNodes(oSymTable, oSymTable->uHeight + 2)) {
+        return 0;
+    }
+
+    /* defensive copy */
+    pcKeyCopy = (char*)malloc(strlen(pcKey) + 1);
+
+    if (pcKeyCopy == NULL)
+    {
+        return 0;
+    }
+
+    strcpy(pcKeyCopy, pcKey);
+
+    if (SymTable_insert(oSymTable, oSymTable->psRoot, oSymTable->uHeight,
+    pcKeyCopy, pvValue, &psRight, &pcSeparator)) {
+        psRoot = SymTable_takeNode(oSymTable);
+        psRoot->uCount = 1;
+        psRoot->apcKeys[0] = pcSeparator;
+        psRoot->u.apsChildren[0] = oSymTable->psRoot;
+        psRoot->u.apsChildren[1] = psRight;
+        oSymTable->psRoot = psRoot;
+        oSymTable->uHeight++;
+    }
+
+    oSymTable->length++;
+    return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, replace the binding's
+value with pvValue and return the old value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_replace(SymTable_T oSymTable, const char *pcKey, const
+void *pvValue)
+{
+    struct SymTableNode *psLeaf;
+    size_t uIndex;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psLeaf = SymTable_findLeaf(oSymTable, pcKey);
+    uIndex = SymTable_findInLeaf(psLeaf, pcKey);
+
+    if (uIndex == psLeaf->uCount) {
+        return NULL;
+    }
+
+    oldval = (void *) psLeaf->u.apvValues[uIndex];
+    psLeaf->u.apvValues[uIndex] = pvValue;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return 1 (TRUE) if oSymTable contains a binding whose key is pcKey,
+or 0 (FALSE) if otherwise. */
+
+int SymTable_contains(SymTable_T oSymTable, const char *pcKey)
+{
+    struct SymTableNode *psLeaf;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psLeaf = SymTable_findLeaf(oSymTable, pcKey);
+    return SymTable_findInLeaf(psLeaf, pcKey) != psLeaf->uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the value of the binding within oSymTable whose key is pcKey,
+or NULL if no such binding exists. */
+
+void *SymTable_get(SymTable_T oSymTable, const char *pcKey)
+{
+    struct SymTableNode *psLeaf;
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    psLeaf = SymTable_findLeaf(oSymTable, pcKey);
+    uIndex = SymTable_findInLeaf(psLeaf, pcKey);
+
+    if (uIndex == psLeaf->uCount) {
+        return NULL;
+    }
+
+    return (void *) psLeaf->u.apvValues[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* If oSymTable contains a binding with key pcKey, remove that binding
+from oSymTable and return the binding's value. Otherwise leave oSymTable
+unchanged and return NULL. */
+
+void *SymTable_remove(SymTable_T oSymTable, const char *pcKey)
+{
+    struct SymTableNode *psOldRoot;
+    const char *pcOldKey;
+    void *oldval;
+
+    assert(oSymTable != NULL);
+    assert(pcKey != NULL);
+
+    if (! SymTable_contains(oSymTable, pcKey)) {
+        return NULL;
+    }
+
+    SymTable_delete(oSymTable, oSymTable->psRoot, oSymTable->uHeight,
+        pcKey, NULL, &pcOldKey, &oldval);
+    free((char *) pcOldKey);
+
+    /* an inner root left with one child gives way to that child */
+    if (oSymTable->uHeight > 0 && oSymTable->psRoot->uCount == 0) {
+        psOldRoot = oSymTable->psRoot;
+        oSymTable->psRoot = psOldRoot->u.apsChildren[0];
+        oSymTable->uHeight--;
+        SymTable_releaseNode(oSymTable, psOldRoot);
+    }
+
+    oSymTable->length--;
+    return oldval;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply to each element of oSymTable, passing pvExtra
+as an extra argument. That is, for each element pcKey and its value
+pvValue of oSymTable, call (*pfApply) (pcKey, pvValue, pvExtra). The
+elements are visited in increasing order of their keys. */
+
+void SymTable_map(SymTable_T oSymTable, void (*pfApply)(const char
+*pcKey, void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    SymTable_mapRange(oSymTable, NULL, NULL, pfApply, pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply, as SymTable_map does, to each element of
+oSymTable whose key is at least pcLow and less than pcHigh, in
+increasing order of their keys. A NULL pcLow or pcHigh leaves that end
+of the range open. The walk descends to the first such key once and
+then follows the leaves. */
+
+void SymTable_mapRange(SymTable_T oSymTable, const char *pcLow,
+    const char *pcHigh, void (*pfApply)(const char *pcKey,
+    void *pvValue, void *pvExtra), const void *pvExtra)
+{
+    struct SymTableNode *psLeaf;
+    size_t uIndex;
+    size_t uLevel;
+
+    assert(oSymTable != NULL);
+    assert(pfApply != NULL);
+
+    if (pcLow == NULL) {
+        psLeaf = oSymTable->psRoot;
+        for (uLevel = oSymTable->uHeight; uLevel > 0; uLevel--)
+        {
+            psLeaf = psLeaf->u.apsChildren[0];
+        }
+        uIndex = 0;
+    }
+    else {
+        psLeaf = SymTable_findLeaf(oSymTable, pcLow);
+        uIndex = SymTable_lowerBound(psLeaf, pcLow);
+    }
+
+    for (; psLeaf != NULL; psLeaf = psLeaf->psNextLeaf, uIndex = 0)
+    {
+        for (; uIndex < psLeaf->uCount; uIndex++)
+        {
+            if (pcHigh != NULL &&
+            strcmp(psLeaf->apcKeys[uIndex], pcHigh) >= 0) {
+                return;
+            }
+            (*pfApply) (psLeaf->apcKeys[uIndex],
+                (void *) psLeaf->u.apvValues[uIndex], (void *) pvExtra);
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Apply function *pfApply, as SymTable_map does, to each element of
+oSymTable whose key begins with pcPrefix, in increasing order of their
+keys. Those keys sort together, starting at pcPrefix itself. */
+
+void SymTable_mapPrefix(SymTable_T oSymTable, const char *pcPrefix,
+    void (*pfApply)(const char *pcKey, void *pvValue, void *pvExtra),
+    const void *pvExtra)
+{
+    struct SymTableNode *psLeaf;
+    size_t uPrefixLength;
+    size_t uIndex;
+
+    assert(oSymTable != NULL);
+    assert(pcPrefix != NULL);
+    assert(pfApply != NULL);
+
+    uPrefixLength = strlen(pcPrefix);
+    psLeaf = SymTable_findLeaf(oSymTable, pcPrefix);
+    uIndex = SymTable_lowerBound(psLeaf, pcPrefix);
+
+    for (; psLeaf != NULL; psLeaf = psLeaf->psNextLeaf, uIndex = 0)
+    {
+        for (; uIndex < psLeaf->uCount; uIndex++)
+        {
+            if (strncmp(psLeaf->apcKeys[uIndex], pcPrefix,
+            uPrefixLength) != 0) {
+                return;
+            }
+            (*pfApply) (psLeaf->apcKeys[uIndex],
+                (void *) psLeaf->u.apvValues[uIndex], (void *) pvExtra);
+        }
+    }
+}
@@ -3,6 +3,10 @@
 /* Author: Bob Dondero                                                */
 /*--------------------------------------------------------------------*/
 
+#if defined(SYMTABLE_CONCURRENT) || defined(SYMTABLE_EXTENSIONS)
+#define _XOPEN_SOURCE 700
+#endif
+
 #include "symtable.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,6 +18,21 @@
 #include <sys/resource.h>
 #endif
 
+#ifdef SYMTABLE_CONCURRENT
+#include <pthread.h>
+#endif
+
+#ifdef SYMTABLE_EXTENSIONS
+#include <fcntl.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+#include <malloc.h>
+#define TEST_HEAP_FOOTPRINT
+#endif
+#endif
+#endif
+
 /*--------------------------------------------------------------------*/
 
 #define ASSURE(i) assure(i, __LINE__)
@@ -696,6 +715,43 @@ static void testTableOfTables(void)
 
 /*--------------------------------------------------------------------*/
 
+#ifdef SYMTABLE_EXTENSIONS
+
+/* The last bucket of 509 that checkBucketOrder saw, and whether the
+   buckets of the keys it saw came in order. */
+
+struct BucketOrder
+{
+   size_t uLastBucket;
+   int iInOrder;
+};
+
+/* Check that the binding whose key is pcKey comes in a bucket no
+   lower than the last one that the BucketOrder at pvExtra saw, as it
+   does when SymTable_map walks the 509 buckets of the 65599 hash in
+   order. pvValue is unused. */
+
+static void checkBucketOrder(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   struct BucketOrder *psOrder = (struct BucketOrder*)pvExtra;
+   size_t uBucket;
+
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   uBucket = SymTable_hashKey(SYMTABLE_HASH_65599, pcKey,
+      strlen(pcKey)) % 509;
+   if (uBucket < psOrder->uLastBucket)
+      psOrder->iInOrder = 0;
+   psOrder->uLastBucket = uBucket;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
 /* Test the ability of a SymTable object to handle collisions.  This
    test assumes that a SymTable object is implemented as a hash table,
    that there are 509 buckets in the hash table, and that the
@@ -704,6 +760,16 @@ static void testTableOfTables(void)
 
 static void testCollisions(void)
 {
+#ifdef SYMTABLE_EXTENSIONS
+   enum {OTHER_KEY_COUNT = 200, MAX_KEY_LENGTH = 10};
+
+   static const char *const apcKeys[] = {
+      "250", "469", "947", "1303", "2016"
+   };
+   struct BucketOrder sOrder;
+   char acKey[MAX_KEY_LENGTH];
+   int i;
+#endif
    SymTable_T oSymTable;
    int iSuccessful;
    char acCenterField[] = "pitcher";
@@ -741,6 +807,26 @@ static void testCollisions(void)
    iSuccessful = SymTable_put(oSymTable, "2016", acRightField);
    ASSURE(iSuccessful);
 
+#ifdef SYMTABLE_EXTENSIONS
+   /* The table takes the hash codes modulo its 509 buckets, so the
+      five keys share one bucket, and SymTable_map, which walks the
+      buckets in order, reaches them among other keys in order of
+      their buckets. */
+   for (i = 0; i < (int)(sizeof(apcKeys) / sizeof(apcKeys[0])); i++)
+      ASSURE(SymTable_hashKey(SYMTABLE_HASH_65599, apcKeys[i],
+         strlen(apcKeys[i])) % 509 == 123);
+   for (i = 0; i < OTHER_KEY_COUNT; i++)
+   {
+      sprintf(acKey, "x%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, acCatcher);
+      ASSURE(iSuccessful);
+   }
+   sOrder.uLastBucket = 0;
+   sOrder.iInOrder = 1;
+   SymTable_map(oSymTable, checkBucketOrder, &sOrder);
+   ASSURE(sOrder.iInOrder);
+#endif
+
    pcValue = SymTable_get(oSymTable, "250");
    ASSURE(pcValue == acCenterField);
 
@@ -776,167 +862,2476 @@ static void testCollisions(void)
 
 /*--------------------------------------------------------------------*/
 
-/* Test the ability of a SymTable object to be large, that is, to
-   contain iBindingCount bindings. Write the time consumed to stdout. */
+#ifdef SYMTABLE_EXTENSIONS
 
-static void testLargeTable(int iBindingCount)
+/* Check that the binding whose key is pcKey uses the string interned
+   in pool pvExtra as its key. pvValue is unused. */
+
+static void checkPooledKey(const char *pcKey, void *pvValue,
+   void *pvExtra)
 {
-   enum {MAX_KEY_LENGTH = 10};
+   SymTablePool_T oPool = (SymTablePool_T)pvExtra;
+   const char *pcInterned;
 
-   SymTable_T oSymTable;
-   SymTable_T oSymTableSmall;
-   char acKey[MAX_KEY_LENGTH];
+   assert(pcKey != NULL);
+   assert(pvExtra != NULL);
+   (void)pvValue;
+
+   pcInterned = SymTablePool_intern(oPool, pcKey);
+   ASSURE(pcInterned == pcKey);
+   SymTablePool_release(oPool, pcInterned);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable objects that share their keys through a
+   SymTablePool. */
+
+static void testPool(void)
+{
+   SymTablePool_T oPool;
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   char acKey[] = "Jeter";
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   const char *pcJeter;
    char *pcValue;
-   int i;
-   int iSmall;
-   int iLarge;
    int iSuccessful;
-   clock_t iInitialClock;
-   clock_t iFinalClock;
-   size_t uLength = 0;
-   size_t uLength2;
 
    printf("------------------------------------------------------\n");
-   printf("Testing a potentially large SymTable object.\n");
-   printf("No output except CPU time consumed should appear here:\n");
+   printf("Testing SymTable objects that share a SymTablePool.\n");
+   printf("No output should appear here:\n");
    fflush(stdout);
 
-   /* Note the current time. */
-   iInitialClock = clock();
+   oPool = SymTablePool_new();
+   ASSURE(oPool != NULL);
+   oSymTable1 = SymTable_newWithPool(oPool);
+   ASSURE(oSymTable1 != NULL);
+   oSymTable2 = SymTable_newWithPool(oPool);
+   ASSURE(oSymTable2 != NULL);
 
-   /* Create oSymTableSmall, and put a couple of bindings into it. */
-   oSymTableSmall = SymTable_new();
-   ASSURE(oSymTableSmall != NULL);
-   iSuccessful = SymTable_put(oSymTableSmall, "xxx", "xxx");
+   iSuccessful = SymTable_put(oSymTable1, acKey, acShortstop);
    ASSURE(iSuccessful);
-   iSuccessful = SymTable_put(oSymTableSmall, "yyy", "yyy");
+   iSuccessful = SymTable_put(oSymTable2, acKey, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable1, "Mantle", acCenterField);
    ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable2, "Mantle", acCenterField);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable2, "Mantle", acShortstop);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTablePool_getLength(oPool) == 2);
+
+   /* The tables keep their keys in the pool, not in acKey. */
+   strcpy(acKey, "xxxxx");
+   pcValue = (char*)SymTable_get(oSymTable1, "Jeter");
+   ASSURE(pcValue == acShortstop);
+
+   pcJeter = SymTablePool_intern(oPool, "Jeter");
+   ASSURE(pcJeter != NULL);
+   ASSURE(SymTablePool_getLength(oPool) == 2);
+   pcValue = (char*)SymTable_get(oSymTable2, pcJeter);
+   ASSURE(pcValue == acShortstop);
+   SymTable_map(oSymTable1, checkPooledKey, oPool);
+   SymTable_map(oSymTable2, checkPooledKey, oPool);
+
+   /* A string stays in the pool while anything refers to it. */
+   pcValue = (char*)SymTable_remove(oSymTable1, pcJeter);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_remove(oSymTable2, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   ASSURE(SymTablePool_getLength(oPool) == 2);
+   ASSURE(strcmp(pcJeter, "Jeter") == 0);
+   SymTablePool_release(oPool, pcJeter);
+   ASSURE(SymTablePool_getLength(oPool) == 1);
+
+   SymTable_free(oSymTable1);
+   ASSURE(SymTablePool_getLength(oPool) == 1);
+   SymTable_free(oSymTable2);
+   ASSURE(SymTablePool_getLength(oPool) == 0);
+
+   /* Freeing the pool frees the strings that callers still hold. */
+   pcJeter = SymTablePool_intern(oPool, "Jeter");
+   ASSURE(pcJeter != NULL);
+   ASSURE(SymTablePool_getLength(oPool) == 1);
+   SymTablePool_free(oPool);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test a SymTable object that uses the word-at-a-time hash function,
+   and the hash codes that SymTable_hashKey returns. */
+
+static void testWordsHash(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object that uses the word hash.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* The 65599 hash is the one that testCollisions assumes. */
+   ASSURE(SymTable_hashKey(SYMTABLE_HASH_65599, "250", 3) % 509 == 123);
+   ASSURE(SymTable_hashKey(SYMTABLE_HASH_65599, "2016", 4) % 509 == 123);
+   ASSURE(SymTable_hashKey(SYMTABLE_HASH_WORDS, "Jeter", 5) ==
+      SymTable_hashKey(SYMTABLE_HASH_WORDS, "Jeter!", 5));
+   ASSURE(SymTable_hashKey(SYMTABLE_HASH_WORDS, "Jeter", 5) !=
+      SymTable_hashKey(SYMTABLE_HASH_WORDS, "Jeter", 4));
 
-   /* Create oSymTable, the primary SymTable object. */
    oSymTable = SymTable_new();
    ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_setHash(oSymTable, SYMTABLE_HASH_WORDS);
+   ASSURE(iSuccessful);
 
-   /* Put iBindingCount new bindings into oSymTable.  Each binding's
-      key and value contain the same characters. */
-   for (i = 0; i < iBindingCount; i++)
+   for (i = 0; i < BINDING_COUNT; i++)
    {
       sprintf(acKey, "%d", i);
-      pcValue = (char*)malloc(sizeof(char) * (strlen(acKey) + 1));
-      ASSURE(pcValue != NULL);
-      strcpy(pcValue, acKey);
-      iSuccessful = SymTable_put(oSymTable, acKey, pcValue);
+      iSuccessful = SymTable_put(oSymTable, acKey, acShortstop);
       ASSURE(iSuccessful);
-      uLength = SymTable_getLength(oSymTable);
-      ASSURE(uLength == (size_t)(i+1));
    }
+   iSuccessful = SymTable_put(oSymTable, "17", acShortstop);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT);
 
-   /* Get each binding's value, and make sure that it contains
-      the same characters as its key. */
-   iSmall = 0;
-   iLarge = iBindingCount - 1;
-   while (iSmall < iLarge)
-   {
-      /* Get the smallest of the remaining bindings. */
-      sprintf(acKey, "%d", iSmall);
-      pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      iSmall++;
-      /* Get the largest of the remaining bindings. */
-      sprintf(acKey, "%d", iLarge);
-      pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      iLarge--;
-   }
-   /* Get the middle binding -- if there is one. */
-   if (iSmall == iLarge)
+   /* The hash function cannot change once there are bindings. */
+   iSuccessful = SymTable_setHash(oSymTable, SYMTABLE_HASH_65599);
+   ASSURE(! iSuccessful);
+
+   for (i = 0; i < BINDING_COUNT; i++)
    {
-      sprintf(acKey, "%d", iSmall);
+      sprintf(acKey, "%d", i);
       pcValue = (char*)SymTable_get(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      ASSURE(pcValue == acShortstop);
+      if (i % 2 == 0)
+      {
+         pcValue = (char*)SymTable_remove(oSymTable, acKey);
+         ASSURE(pcValue == acShortstop);
+      }
    }
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT / 2);
+   ASSURE(! SymTable_contains(oSymTable, "0"));
+   ASSURE(SymTable_contains(oSymTable, "1"));
 
-   /* Remove each binding. Also free each binding's value. */
-   iSmall = 0;
-   iLarge = iBindingCount - 1;
-   while (iSmall < iLarge)
-   {
-      /* Remove the smallest of the remaining bindings. */
-      sprintf(acKey, "%d", iSmall);
-      pcValue = (char*)SymTable_remove(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      free(pcValue);
-      uLength--;
-      uLength2 = SymTable_getLength(oSymTable);
-      ASSURE(uLength2 == uLength);
-      iSmall++;
-      /* Remove the largest of the remaining bindings. */
-      sprintf(acKey, "%d", iLarge);
-      pcValue = (char*)SymTable_remove(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      free(pcValue);
-      uLength--;
-      uLength2 = SymTable_getLength(oSymTable);
-      ASSURE(uLength2 == uLength);
-      iLarge--;
-   }
-   /* Remove the middle binding -- if there is one. */
-   if (iSmall == iLarge)
-   {
-      sprintf(acKey, "%d", iSmall);
-      pcValue = (char*)SymTable_remove(oSymTable, acKey);
-      ASSURE(pcValue != NULL);
-      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
-      free(pcValue);
-      uLength--;
-      uLength2 = SymTable_getLength(oSymTable);
-      ASSURE(uLength2 == uLength);  
-   }
+   SymTable_free(oSymTable);
+}
 
-   /* Make sure oSymTableSmall hasn't been corrupted by expansion
-      of oSymTable. */
-   pcValue = (char*)SymTable_get(oSymTableSmall, "xxx");
-   ASSURE((pcValue != NULL) && (strcmp(pcValue, "xxx") == 0));
-   pcValue = (char*)SymTable_get(oSymTableSmall, "yyy");
-   ASSURE((pcValue != NULL) && (strcmp(pcValue, "yyy") == 0));
+/*--------------------------------------------------------------------*/
 
-   /* Free both SymTable objects. */
-   SymTable_free(oSymTable);
-   SymTable_free(oSymTableSmall);
+/* Test the SymTable_Key functions on keys that are slices of a larger
+   string, shared by tables with different hash functions and by a
+   table whose keys are pooled. */
 
-   /* Note the current time, and print the time consumed to stdout. */
-   iFinalClock = clock();
-   printf("CPU time (%d bindings):  %f seconds\n", iBindingCount,
-      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+static void testKeys(void)
+{
+   const char acLine[] = "Jeter Mantle Jet";
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   SymTable_T oSymTable3;
+   SymTablePool_T oPool;
+   SymTable_Key sJeter;
+   SymTable_Key sMantle;
+   SymTable_Key sJet;
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the SymTable_Key functions.\n");
+   printf("No output should appear here:\n");
    fflush(stdout);
+
+   sJeter = SymTable_makeKey(SYMTABLE_HASH_65599, acLine, 5);
+   sMantle = SymTable_makeKey(SYMTABLE_HASH_65599, acLine + 6, 6);
+   sJet = SymTable_makeKey(SYMTABLE_HASH_65599, acLine + 13, 3);
+   ASSURE(sJeter.uHash ==
+      SymTable_hashKey(SYMTABLE_HASH_65599, "Jeter", 5));
+
+   oPool = SymTablePool_new();
+   ASSURE(oPool != NULL);
+   oSymTable1 = SymTable_new();
+   ASSURE(oSymTable1 != NULL);
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_setHash(oSymTable2, SYMTABLE_HASH_WORDS);
+   ASSURE(iSuccessful);
+   oSymTable3 = SymTable_newWithPool(oPool);
+   ASSURE(oSymTable3 != NULL);
+
+   iSuccessful = SymTable_putK(oSymTable1, &sJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putK(oSymTable2, &sJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putK(oSymTable3, &sJeter, acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putK(oSymTable1, &sMantle, acCenterField);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_putK(oSymTable1, &sJeter, acCenterField);
+   ASSURE(! iSuccessful);
+
+   /* A slice matches the '\0'-terminated key with the same
+      characters, and not a key that it is a prefix of. */
+   pcValue = (char*)SymTable_get(oSymTable1, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTable2, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_get(oSymTable3, "Jeter");
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_getK(oSymTable1, &sMantle);
+   ASSURE(pcValue == acCenterField);
+   ASSURE(SymTable_contains(oSymTable1, "Mantle"));
+   ASSURE(! SymTable_contains(oSymTable1, "Mantle Jet"));
+   ASSURE(! SymTable_containsK(oSymTable1, &sJet));
+   ASSURE(! SymTable_containsK(oSymTable3, &sJet));
+   ASSURE(SymTable_containsK(oSymTable2, &sJeter));
+   ASSURE(SymTablePool_getLength(oPool) == 1);
+
+   iSuccessful = SymTable_put(oSymTable1, "Jet", acCenterField);
+   ASSURE(iSuccessful);
+   pcValue = (char*)SymTable_getK(oSymTable1, &sJet);
+   ASSURE(pcValue == acCenterField);
+
+   pcValue = (char*)SymTable_removeK(oSymTable1, &sJeter);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_removeK(oSymTable1, &sJeter);
+   ASSURE(pcValue == NULL);
+   pcValue = (char*)SymTable_removeK(oSymTable2, &sJeter);
+   ASSURE(pcValue == acShortstop);
+   pcValue = (char*)SymTable_removeK(oSymTable3, &sJeter);
+   ASSURE(pcValue == acShortstop);
+   ASSURE(SymTable_getLength(oSymTable1) == 2);
+   ASSURE(SymTable_getLength(oSymTable2) == 0);
+   ASSURE(SymTablePool_getLength(oPool) == 0);
+
+   SymTable_free(oSymTable1);
+   SymTable_free(oSymTable2);
+   SymTable_free(oSymTable3);
+   SymTablePool_free(oPool);
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Test the SymTable ADT.  Write the output of the tests to stdout.
-   As always, argc is the command-line argument count, argv contains
-   the command-line arguments, and argv[0] is the name of the
-   executable binary file. argv[1] is the number of bindings to put
-   into a potentially large SymTable object.  Exit with EXIT_FAILURE
-   if argv[1] is missing or not numeric.  Otherwise return 0. */
+/* Test SymTable_upsert and SymTable_getOrInsert by counting words,
+   and check that the value addresses they return survive expansion. */
 
-int main(int argc, char *argv[])
+static void testUpsert(void)
 {
-   int iBindingCount;
+   enum {WORD_COUNT = 8, BINDING_COUNT = 3000, MAX_KEY_LENGTH = 10};
 
-   if (argc != 2)
-   {
-      fprintf(stderr, "Usage: %s bindingcount\n", argv[0]);
-      exit(EXIT_FAILURE);
-   }
+   const char *apcWords[WORD_COUNT] = {"Ruth", "Gehrig", "Ruth",
+      "Mantle", "Ruth", "Gehrig", "Jeter", "Ruth"};
+   int aiCounts[WORD_COUNT];
+   int iCountCount = 0;
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   void **ppvRuth;
+   void **ppvValue;
+   int iInserted;
+   int i;
 
-   if (sscanf(argv[1], "%d", &iBindingCount) != 1)
-   {
-      fprintf(stderr, "bindingcount must be numeric\n");
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_upsert and SymTable_getOrInsert.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < WORD_COUNT; i++)
+   {
+      ppvValue = SymTable_upsert(oSymTable, apcWords[i], &iInserted);
+      ASSURE(ppvValue != NULL);
+      if (iInserted)
+      {
+         ASSURE(*ppvValue == NULL);
+         aiCounts[iCountCount] = 0;
+         *ppvValue = &aiCounts[iCountCount++];
+      }
+      (*(int*)*ppvValue)++;
+   }
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+   ASSURE(iCountCount == 4);
+   ASSURE(*(int*)SymTable_get(oSymTable, "Ruth") == 4);
+   ASSURE(*(int*)SymTable_get(oSymTable, "Gehrig") == 2);
+   ASSURE(*(int*)SymTable_get(oSymTable, "Jeter") == 1);
+
+   ppvValue = SymTable_getOrInsert(oSymTable, "Ruth", acShortstop);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == &aiCounts[0]);
+   ppvRuth = ppvValue;
+
+   ppvValue = SymTable_getOrInsert(oSymTable, "Maris", acCenterField);
+   ASSURE(ppvValue != NULL);
+   ASSURE(*ppvValue == acCenterField);
+   *ppvValue = acShortstop;
+   ASSURE(SymTable_get(oSymTable, "Maris") == acShortstop);
+   ASSURE(SymTable_getLength(oSymTable) == 5);
+
+   /* Expansion relinks the bindings without moving them. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ppvValue = SymTable_getOrInsert(oSymTable, acKey, acShortstop);
+      ASSURE(ppvValue != NULL);
+   }
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT + 5);
+   ppvValue = SymTable_upsert(oSymTable, "Ruth", &iInserted);
+   ASSURE(! iInserted);
+   ASSURE(ppvValue == ppvRuth);
+   *ppvRuth = acCenterField;
+   ASSURE(SymTable_get(oSymTable, "Ruth") == acCenterField);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_getBatch and SymTable_containsBatch, with keys that
+   share buckets and with lookups made while the table expands. */
+
+static void testBatch(void)
+{
+   enum {BINDING_COUNT = 2000, LOOKUP_COUNT = 2 * BINDING_COUNT + 3,
+      MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char (*pacKeys)[MAX_KEY_LENGTH];
+   const char **ppcLookups;
+   void **ppvValues;
+   int *piFound;
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   size_t uFoundCount;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_getBatch and SymTable_containsBatch.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   pacKeys = malloc(sizeof(*pacKeys) * BINDING_COUNT * 2);
+   ppcLookups = malloc(sizeof(*ppcLookups) * LOOKUP_COUNT);
+   ppvValues = malloc(sizeof(*ppvValues) * LOOKUP_COUNT);
+   piFound = malloc(sizeof(*piFound) * LOOKUP_COUNT);
+   ASSURE(pacKeys != NULL && ppcLookups != NULL && ppvValues != NULL &&
+      piFound != NULL);
+   if (pacKeys == NULL || ppcLookups == NULL || ppvValues == NULL ||
+      piFound == NULL)
+      return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   uFoundCount = SymTable_getBatch(oSymTable, ppcLookups, 0, ppvValues);
+   ASSURE(uFoundCount == 0);
+
+   /* Bind the even numbers; "250" and "2016" share a bucket. */
+   for (i = 0; i < 2 * BINDING_COUNT; i++)
+   {
+      sprintf(pacKeys[i], "%d", i);
+      ppcLookups[i] = pacKeys[i];
+      if (i % 2 == 0)
+      {
+         iSuccessful = SymTable_put(oSymTable, pacKeys[i], pacKeys[i]);
+         ASSURE(iSuccessful);
+      }
+   }
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+   ppcLookups[2 * BINDING_COUNT] = "Jeter";
+   ppcLookups[2 * BINDING_COUNT + 1] = "Mantle";
+   ppcLookups[2 * BINDING_COUNT + 2] = "Jeter";
+
+   uFoundCount = SymTable_getBatch(oSymTable, ppcLookups, LOOKUP_COUNT,
+      ppvValues);
+   ASSURE(uFoundCount == BINDING_COUNT + 2);
+   for (i = 0; i < 2 * BINDING_COUNT; i++)
+      ASSURE(ppvValues[i] == (i % 2 == 0 ? pacKeys[i] : NULL));
+   ASSURE(ppvValues[2 * BINDING_COUNT] == acShortstop);
+   ASSURE(ppvValues[2 * BINDING_COUNT + 1] == NULL);
+   ASSURE(ppvValues[2 * BINDING_COUNT + 2] == acShortstop);
+
+   iSuccessful = SymTable_put(oSymTable, "Mantle", acCenterField);
+   ASSURE(iSuccessful);
+   uFoundCount = SymTable_containsBatch(oSymTable, ppcLookups,
+      LOOKUP_COUNT, piFound);
+   ASSURE(uFoundCount == BINDING_COUNT + 3);
+   for (i = 0; i < 2 * BINDING_COUNT; i++)
+      ASSURE(piFound[i] == (i % 2 == 0));
+   ASSURE(piFound[2 * BINDING_COUNT + 1]);
+
+   SymTable_free(oSymTable);
+   free(piFound);
+   free(ppvValues);
+   free(ppcLookups);
+   free(pacKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_putBatch, with duplicates within the batch and of
+   bindings already in the table, with a long key, and with a batch
+   that arrives while the table is expanding. */
+
+static void testPutBatch(void)
+{
+   enum {BINDING_COUNT = 3000, MAX_KEY_LENGTH = 10, LONG_KEY_LENGTH = 300};
+
+   SymTable_T oSymTable;
+   char (*pacKeys)[MAX_KEY_LENGTH];
+   const char **ppcKeys;
+   const void **ppvValues;
+   int *piInserted;
+   char acLongKey[LONG_KEY_LENGTH + 1];
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_putBatch.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   pacKeys = malloc(sizeof(*pacKeys) * BINDING_COUNT);
+   ppcKeys = malloc(sizeof(*ppcKeys) * (BINDING_COUNT + 3));
+   ppvValues = malloc(sizeof(*ppvValues) * (BINDING_COUNT + 3));
+   piInserted = malloc(sizeof(*piInserted) * (BINDING_COUNT + 3));
+   ASSURE(pacKeys != NULL && ppcKeys != NULL && ppvValues != NULL &&
+      piInserted != NULL);
+   if (pacKeys == NULL || ppcKeys == NULL || ppvValues == NULL ||
+      piInserted == NULL)
+      return;
+
+   memset(acLongKey, 'x', LONG_KEY_LENGTH);
+   acLongKey[LONG_KEY_LENGTH] = '\0';
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iSuccessful = SymTable_putBatch(oSymTable, ppcKeys, ppvValues, 0,
+      piInserted);
+   ASSURE(iSuccessful);
+
+   /* Put enough single bindings to start an expansion. */
+   for (i = 0; i < 600; i++)
+   {
+      sprintf(pacKeys[i], "%d", i);
+      iSuccessful = SymTable_put(oSymTable, pacKeys[i], acCenterField);
+      ASSURE(iSuccessful);
+   }
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(pacKeys[i], "%d", i);
+      ppcKeys[i] = pacKeys[i];
+      ppvValues[i] = pacKeys[i];
+   }
+   ppcKeys[BINDING_COUNT] = "1234";
+   ppvValues[BINDING_COUNT] = acShortstop;
+   ppcKeys[BINDING_COUNT + 1] = acLongKey;
+   ppvValues[BINDING_COUNT + 1] = acShortstop;
+   ppcKeys[BINDING_COUNT + 2] = acLongKey;
+   ppvValues[BINDING_COUNT + 2] = acCenterField;
+
+   iSuccessful = SymTable_putBatch(oSymTable, ppcKeys, ppvValues,
+      BINDING_COUNT + 3, piInserted);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT + 1);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      ASSURE(piInserted[i] == (i >= 600));
+      pcValue = (char*)SymTable_get(oSymTable, pacKeys[i]);
+      ASSURE(pcValue == (i < 600 ? acCenterField : pacKeys[i]));
+   }
+   ASSURE(! piInserted[BINDING_COUNT]);
+   ASSURE(piInserted[BINDING_COUNT + 1]);
+   ASSURE(! piInserted[BINDING_COUNT + 2]);
+   pcValue = (char*)SymTable_get(oSymTable, acLongKey);
+   ASSURE(pcValue == acShortstop);
+
+   /* Bindings from a batch are removed and reused like any other. */
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      pcValue = (char*)SymTable_remove(oSymTable, pacKeys[i]);
+      ASSURE(pcValue != NULL);
+   }
+   pcValue = (char*)SymTable_remove(oSymTable, acLongKey);
+   ASSURE(pcValue == acShortstop);
+   iSuccessful = SymTable_put(oSymTable, "Jeter", acShortstop);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT / 2 + 1);
+   iSuccessful = SymTable_putBatch(oSymTable, ppcKeys, ppvValues, 4,
+      NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable, "2") == pacKeys[2]);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT / 2 + 3);
+
+   SymTable_free(oSymTable);
+   free(piInserted);
+   free(ppvValues);
+   free(ppcKeys);
+   free(pacKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_newWithCapacity and SymTable_reserve on tables that
+   start smaller and larger than SymTable_new makes them. */
+
+static void testCapacity(void)
+{
+   enum {BINDING_COUNT = 3000, MAX_KEY_LENGTH = 10,
+      TINY_BINDING_COUNT = 4, TINY_TABLE_BYTES = 16384};
+
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   char acKey[MAX_KEY_LENGTH];
+   char acShortstop[] = "Shortstop";
+   char *pcValue;
+   int i;
+   int iSuccessful;
+#ifdef TEST_HEAP_FOOTPRINT
+   size_t uHeapBytes;
+#endif
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_newWithCapacity and SymTable_reserve.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+#ifdef TEST_HEAP_FOOTPRINT
+   /* A table created for a few bindings stays far smaller than a
+      full slab once it holds them. */
+   uHeapBytes = mallinfo2().uordblks;
+   oSymTable1 = SymTable_newWithCapacity(TINY_BINDING_COUNT);
+   ASSURE(oSymTable1 != NULL);
+   for (i = 0; i < TINY_BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable1, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   ASSURE(mallinfo2().uordblks - uHeapBytes < TINY_TABLE_BYTES);
+   SymTable_free(oSymTable1);
+#endif
+
+   /* A table with room for nothing still grows as needed. */
+   oSymTable1 = SymTable_newWithCapacity(0);
+   ASSURE(oSymTable1 != NULL);
+   oSymTable2 = SymTable_newWithCapacity(BINDING_COUNT);
+   ASSURE(oSymTable2 != NULL);
+   iSuccessful = SymTable_setHash(oSymTable2, SYMTABLE_HASH_WORDS);
+   ASSURE(iSuccessful);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable1, acKey, acShortstop);
+      ASSURE(iSuccessful);
+      iSuccessful = SymTable_put(oSymTable2, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable1, acKey);
+      ASSURE(pcValue == acShortstop);
+      pcValue = (char*)SymTable_get(oSymTable2, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+
+   /* Reserving finishes any expansion and keeps every binding. */
+   iSuccessful = SymTable_reserve(oSymTable1, 10);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_reserve(oSymTable1, 4 * BINDING_COUNT);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_reserve(oSymTable2, 4 * BINDING_COUNT);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable1) == BINDING_COUNT);
+   for (i = 0; i < 2 * BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable1, acKey);
+      ASSURE(pcValue == (i < BINDING_COUNT ? acShortstop : NULL));
+      pcValue = (char*)SymTable_get(oSymTable2, acKey);
+      ASSURE(pcValue == (i < BINDING_COUNT ? acShortstop : NULL));
+   }
+
+   SymTable_free(oSymTable1);
+   SymTable_free(oSymTable2);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count the call in the int at pvExtra, and return pvSourceValue,
+   ignoring pcKey and pvDestValue. */
+
+static void *takeSourceValue(const char *pcKey, void *pvDestValue,
+   void *pvSourceValue, void *pvExtra)
+{
+   (void)pcKey;
+   (void)pvDestValue;
+   (*(int*)pvExtra)++;
+   return pvSourceValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_merge and the SymTableShards functions. */
+
+static void testMerge(void)
+{
+   enum {BINDING_COUNT = 3000, SHARD_COUNT = 4, MAX_KEY_LENGTH = 10,
+      LONG_KEY_LENGTH = 300};
+
+   SymTable_T oSymTable1;
+   SymTable_T oSymTable2;
+   SymTable_T oSymTable3;
+   SymTableShards_T oShards;
+   SymTableIter_T oIter;
+   char acKey[MAX_KEY_LENGTH];
+   char acLongKey[LONG_KEY_LENGTH + 1];
+   char acShortstop[] = "Shortstop";
+   char acCenterField[] = "Center Field";
+   char *pcValue;
+   size_t uShard;
+   int iCombineCount = 0;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_merge and SymTableShards.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   memset(acLongKey, 'x', LONG_KEY_LENGTH);
+   acLongKey[LONG_KEY_LENGTH] = '\0';
+
+   /* Merging overlapping tables keeps one binding per key. */
+   oSymTable1 = SymTable_new();
+   ASSURE(oSymTable1 != NULL);
+   oSymTable2 = SymTable_new();
+   ASSURE(oSymTable2 != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      if (i < 2 * BINDING_COUNT / 3)
+      {
+         iSuccessful = SymTable_put(oSymTable1, acKey, acShortstop);
+         ASSURE(iSuccessful);
+      }
+      if (i >= BINDING_COUNT / 3)
+      {
+         iSuccessful = SymTable_put(oSymTable2, acKey, acCenterField);
+         ASSURE(iSuccessful);
+      }
+   }
+   iSuccessful = SymTable_put(oSymTable2, acLongKey, acCenterField);
+   ASSURE(iSuccessful);
+
+   iSuccessful = SymTable_merge(oSymTable1, oSymTable2, takeSourceValue,
+      &iCombineCount);
+   ASSURE(iSuccessful);
+   ASSURE(iCombineCount == 2 * BINDING_COUNT / 3 - BINDING_COUNT / 3);
+   ASSURE(SymTable_getLength(oSymTable1) == BINDING_COUNT + 1);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable1, acKey);
+      ASSURE(pcValue ==
+         (i < BINDING_COUNT / 3 ? acShortstop : acCenterField));
+   }
+   pcValue = (char*)SymTable_get(oSymTable1, acLongKey);
+   ASSURE(pcValue == acCenterField);
+
+   /* The moved nodes can be removed and reused. */
+   pcValue = (char*)SymTable_remove(oSymTable1, acLongKey);
+   ASSURE(pcValue == acCenterField);
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_remove(oSymTable1, acKey);
+      ASSURE(pcValue != NULL);
+      iSuccessful = SymTable_put(oSymTable1, acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+
+   /* Tables with different hash functions do not merge. */
+   oSymTable3 = SymTable_new();
+   ASSURE(oSymTable3 != NULL);
+   iSuccessful = SymTable_setHash(oSymTable3, SYMTABLE_HASH_WORDS);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable3, "0", acCenterField);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_merge(oSymTable1, oSymTable3, NULL, NULL);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable3) == 1);
+   SymTable_free(oSymTable3);
+
+   /* A table with a live iterator is not merged away until the
+      iterator is freed. */
+   oSymTable3 = SymTable_new();
+   ASSURE(oSymTable3 != NULL);
+   iSuccessful = SymTable_put(oSymTable3, "x", acCenterField);
+   ASSURE(iSuccessful);
+   oIter = SymTable_iterBegin(oSymTable3);
+   ASSURE(oIter != NULL);
+   iSuccessful = SymTable_merge(oSymTable1, oSymTable3, NULL, NULL);
+   ASSURE(! iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable3) == 1);
+   ASSURE(SymTable_iterNext(oIter));
+   SymTable_iterFree(oIter);
+   iSuccessful = SymTable_merge(oSymTable1, oSymTable3, NULL, NULL);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_get(oSymTable1, "x") == acCenterField);
+   SymTable_free(oSymTable1);
+
+   /* Shards each get their own keys and merge into one table. */
+   oShards = SymTableShards_new(SHARD_COUNT, BINDING_COUNT);
+   ASSURE(oShards != NULL);
+   if (oShards == NULL)
+      return;
+   ASSURE(SymTableShards_getCount(oShards) == SHARD_COUNT);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      uShard = SymTableShards_route(oShards, acKey);
+      ASSURE(uShard < SHARD_COUNT);
+      iSuccessful = SymTable_put(SymTableShards_shard(oShards, uShard),
+         acKey, acShortstop);
+      ASSURE(iSuccessful);
+   }
+   uShard = SymTableShards_route(oShards, acLongKey);
+   iSuccessful = SymTable_put(SymTableShards_shard(oShards, uShard),
+      acLongKey, acCenterField);
+   ASSURE(iSuccessful);
+   for (uShard = 0; uShard < SHARD_COUNT; uShard++)
+      ASSURE(SymTable_getLength(SymTableShards_shard(oShards, uShard)) <
+         BINDING_COUNT);
+
+   oSymTable1 = SymTableShards_merge(oShards);
+   ASSURE(oSymTable1 != NULL);
+   if (oSymTable1 == NULL)
+      return;
+   ASSURE(SymTable_getLength(oSymTable1) == BINDING_COUNT + 1);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable1, acKey);
+      ASSURE(pcValue == acShortstop);
+   }
+   pcValue = (char*)SymTable_get(oSymTable1, acLongKey);
+   ASSURE(pcValue == acCenterField);
+   SymTable_free(oSymTable1);
+
+   /* A shard with another hash function leaves the shards unmerged. */
+   oShards = SymTableShards_new(2, 2);
+   ASSURE(oShards != NULL);
+   if (oShards == NULL)
+      return;
+   iSuccessful = SymTable_put(SymTableShards_shard(oShards, 0), "0",
+      acShortstop);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_setHash(SymTableShards_shard(oShards, 1),
+      SYMTABLE_HASH_65599);
+   ASSURE(iSuccessful);
+   oSymTable1 = SymTableShards_merge(oShards);
+   ASSURE(oSymTable1 == NULL);
+   ASSURE(SymTable_getLength(SymTableShards_shard(oShards, 0)) == 1);
+   pcValue = (char*)SymTable_get(SymTableShards_shard(oShards, 0), "0");
+   ASSURE(pcValue == acShortstop);
+   SymTableShards_free(oShards);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Count a visit of the binding with key pcKey in the int at pvValue,
+   and add the length of pcKey to the size_t at pvExtra. */
+
+static void countVisit(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   (*(int*)pvValue)++;
+   *(size_t*)pvExtra += strlen(pcKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_mapParallel. */
+
+static void testMapParallel(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_THREAD_COUNT = 8, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   int aiVisits[BINDING_COUNT];
+   size_t auKeyBytes[MAX_THREAD_COUNT];
+   void *apvExtras[MAX_THREAD_COUNT];
+   size_t uExpectedKeyBytes = 0;
+   size_t uKeyBytes;
+   size_t uThreadCount;
+   size_t u;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_mapParallel.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (u = 0; u < MAX_THREAD_COUNT; u++)
+      apvExtras[u] = &auKeyBytes[u];
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* An empty table gives the function nothing to do. */
+   auKeyBytes[0] = 0;
+   SymTable_mapParallel(oSymTable, countVisit, apvExtras, 4);
+   ASSURE(auKeyBytes[0] == 0);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      uExpectedKeyBytes += strlen(acKey);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Each binding is visited exactly once, whatever the number of
+      threads, and each thread accumulates into its own extra. */
+   for (uThreadCount = 1; uThreadCount <= MAX_THREAD_COUNT;
+      uThreadCount++)
+   {
+      for (i = 0; i < BINDING_COUNT; i++)
+         aiVisits[i] = 0;
+      for (u = 0; u < MAX_THREAD_COUNT; u++)
+         auKeyBytes[u] = 0;
+
+      SymTable_mapParallel(oSymTable, countVisit, apvExtras,
+         uThreadCount);
+
+      for (i = 0; i < BINDING_COUNT; i++)
+         ASSURE(aiVisits[i] == 1);
+      uKeyBytes = 0;
+      for (u = 0; u < MAX_THREAD_COUNT; u++)
+      {
+         ASSURE(u < uThreadCount || auKeyBytes[u] == 0);
+         uKeyBytes += auKeyBytes[u];
+      }
+      ASSURE(uKeyBytes == uExpectedKeyBytes);
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Walk a table that uses eHash while puts between the steps expand
+   it several times over, and SymTable_reserve rehashes it once, and
+   check that the walk neither hides nor repeats the bindings that
+   were there all along. Two walks interleave, one a step behind the
+   other, and the second also removes some of the bindings it has
+   not reached yet. */
+
+static void testIterGrowth(enum SymTableHash eHash)
+{
+   enum {BINDING_COUNT = 2000, EXTRA_COUNT = 30000, MAX_KEY_LENGTH = 16,
+      RESERVE_AT = 10000, REMOVE_EVERY = 7};
+
+   SymTable_T oSymTable;
+   SymTableIter_T oIter1;
+   SymTableIter_T oIter2;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiVisits[BINDING_COUNT];
+   static int aiExtraVisits[EXTRA_COUNT];
+   static int aiVisits2[BINDING_COUNT];
+   int *piVisits;
+   int i;
+   int iExtra = 0;
+   int iMore1;
+   int iMore2 = 1;
+   int iSuccessful;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_setHash(oSymTable, eHash);
+   ASSURE(iSuccessful);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+      aiVisits[i] = 0;
+      aiVisits2[i] = 0;
+   }
+   for (i = 0; i < EXTRA_COUNT; i++)
+      aiExtraVisits[i] = 0;
+
+   oIter1 = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter1 != NULL);
+   oIter2 = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter2 != NULL);
+   while ((iMore1 = SymTable_iterNext(oIter1)) != 0 || iMore2)
+   {
+      if (iMore1)
+      {
+         piVisits = (int*)SymTable_iterValue(oIter1);
+         (*piVisits)++;
+      }
+
+      /* Each step of the walk makes room for many puts, all of them
+         done by halfway, since the walk need not visit them. */
+      for (i = 0; i < 2 * EXTRA_COUNT / BINDING_COUNT &&
+         iExtra < EXTRA_COUNT; i++, iExtra++)
+      {
+         sprintf(acKey, "y%d", iExtra);
+         iSuccessful = SymTable_put(oSymTable, acKey,
+            &aiExtraVisits[iExtra]);
+         ASSURE(iSuccessful);
+         if (iExtra == RESERVE_AT)
+         {
+            iSuccessful = SymTable_reserve(oSymTable, 2 * EXTRA_COUNT);
+            ASSURE(iSuccessful);
+         }
+      }
+
+      if (iMore2 && (iMore2 = SymTable_iterNext(oIter2)) != 0)
+      {
+         piVisits = (int*)SymTable_iterValue(oIter2);
+         if (piVisits >= aiVisits && piVisits < aiVisits + BINDING_COUNT)
+         {
+            aiVisits2[piVisits - aiVisits]++;
+            i = (int)(piVisits - aiVisits) + 1;
+            if (i < BINDING_COUNT && i % REMOVE_EVERY == 0)
+            {
+               sprintf(acKey, "%d", i);
+               (void)SymTable_remove(oSymTable, acKey);
+            }
+         }
+      }
+   }
+   SymTable_iterFree(oIter1);
+   SymTable_iterFree(oIter2);
+   ASSURE(iExtra == EXTRA_COUNT);
+
+   /* The first walk saw every original binding once. The second saw
+      each once too, except those it removed before reaching them. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(aiVisits[i] == 1 ||
+         (aiVisits[i] == 0 && i % REMOVE_EVERY == 0 &&
+         ! SymTable_contains(oSymTable, acKey)));
+      ASSURE(aiVisits2[i] == 1 ||
+         (aiVisits2[i] == 0 && ! SymTable_contains(oSymTable, acKey)));
+   }
+   for (i = 0; i < EXTRA_COUNT; i++)
+   {
+      ASSURE(aiExtraVisits[i] <= 1);
+      sprintf(acKey, "y%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &aiExtraVisits[i]);
+   }
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_iterBegin, SymTable_iterNext, SymTable_iterKey,
+   SymTable_iterValue, and SymTable_iterFree. */
+
+static void testIter(void)
+{
+   enum {BINDING_COUNT = 2000, MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTableIter_T oIter1;
+   SymTableIter_T oIter2;
+   char acKey[MAX_KEY_LENGTH];
+   static int aiVisits[BINDING_COUNT];
+   int *piVisits;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_iterBegin and friends.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* An empty table has nothing to visit. */
+   oIter1 = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter1 != NULL);
+   ASSURE(SymTable_iterKey(oIter1) == NULL);
+   ASSURE(! SymTable_iterNext(oIter1));
+   ASSURE(SymTable_iterKey(oIter1) == NULL);
+   ASSURE(SymTable_iterValue(oIter1) == NULL);
+   SymTable_iterFree(oIter1);
+
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* A full walk visits each binding once, with its own value. */
+   oIter1 = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter1 != NULL);
+   while (SymTable_iterNext(oIter1))
+   {
+      piVisits = (int*)SymTable_iterValue(oIter1);
+      ASSURE(piVisits == &aiVisits[atoi(SymTable_iterKey(oIter1))]);
+      (*piVisits)++;
+   }
+   ASSURE(! SymTable_iterNext(oIter1));
+   SymTable_iterFree(oIter1);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      ASSURE(aiVisits[i] == 1);
+      aiVisits[i] = 0;
+   }
+
+   /* A walk may stop early. */
+   oIter1 = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter1 != NULL);
+   ASSURE(SymTable_iterNext(oIter1));
+   ASSURE(SymTable_iterKey(oIter1) != NULL);
+   SymTable_iterFree(oIter1);
+
+   /* A walk carries on across expansions and rehashes. */
+   testIterGrowth(SYMTABLE_HASH_65599);
+   testIterGrowth(SYMTABLE_HASH_WORDS);
+
+   /* A walk may remove the binding it is at, and another iterator
+      steps over the bindings removed under it. */
+   oIter2 = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter2 != NULL);
+   ASSURE(SymTable_iterNext(oIter2));
+   oIter1 = SymTable_iterBegin(oSymTable);
+   ASSURE(oIter1 != NULL);
+   while (SymTable_iterNext(oIter1))
+   {
+      strcpy(acKey, SymTable_iterKey(oIter1));
+      piVisits = (int*)SymTable_iterValue(oIter1);
+      ASSURE(SymTable_remove(oSymTable, acKey) == piVisits);
+      ASSURE(SymTable_iterKey(oIter1) == NULL);
+      ASSURE(SymTable_iterValue(oIter1) == NULL);
+   }
+   SymTable_iterFree(oIter1);
+   ASSURE(SymTable_getLength(oSymTable) == 0);
+   ASSURE(SymTable_iterKey(oIter2) == NULL);
+   ASSURE(! SymTable_iterNext(oIter2));
+   SymTable_iterFree(oIter2);
+
+   SymTable_free(oSymTable);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Store the int at pvValue in the uBufferSize bytes at pvBuffer if it
+   fits, and return its size, or 0 for a NULL value. */
+
+static size_t serializeInt(const void *pvValue, void *pvBuffer,
+   size_t uBufferSize)
+{
+   if (pvValue == NULL)
+      return 0;
+   if (uBufferSize >= sizeof(int))
+      memcpy(pvBuffer, pvValue, sizeof(int));
+   return sizeof(int);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Add the int at pvValue to the sum at pvExtra, unless pcKey is the
+   empty key, whose value was saved as no bytes at all. */
+
+static void sumInts(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   assert(pcKey != NULL);
+   if (*pcKey != '\0')
+      *(long*)pvExtra += *(int*)pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Save oSymTable to a new temporary file, store the file's name in
+   pcPath, and return the table that SymTable_openMapped makes of the
+   file. */
+
+static SymTable_T saveAndMap(SymTable_T oSymTable, char *pcPath)
+{
+   int iFd;
+   int iSuccessful;
+
+   strcpy(pcPath, "/tmp/testsymtableXXXXXX");
+   iFd = mkstemp(pcPath);
+   ASSURE(iFd >= 0);
+   iSuccessful = SymTable_save(oSymTable, iFd, serializeInt);
+   ASSURE(iSuccessful);
+   close(iFd);
+   return SymTable_openMapped(pcPath);
+}
+
+/*--------------------------------------------------------------------*/
+
+static void testSnapshot(void)
+{
+   enum {BINDING_COUNT = 3000, MAX_KEY_LENGTH = 10, LONG_KEY_LENGTH = 300,
+      PATH_SIZE = 32};
+
+   SymTable_T oSymTable;
+   SymTable_T oMapped;
+   SymTable_T oRemapped;
+   static int aiValues[BINDING_COUNT];
+   char acKey[MAX_KEY_LENGTH];
+   char acLongKey[LONG_KEY_LENGTH + 1];
+   char acPath[PATH_SIZE];
+   char acRemappedPath[PATH_SIZE];
+   const char *apcKeys[3];
+   void *apvValues[3];
+   int *piValue;
+   long lSum;
+   int i;
+   int iSuccessful;
+   int iFd;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_save and SymTable_openMapped.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      aiValues[i] = i * 7;
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+   }
+   memset(acLongKey, 'x', LONG_KEY_LENGTH);
+   acLongKey[LONG_KEY_LENGTH] = '\0';
+   iSuccessful = SymTable_put(oSymTable, acLongKey, &aiValues[1]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "", NULL);
+   ASSURE(iSuccessful);
+
+   /* The mapped table has every binding, with its value's bytes. */
+   oMapped = saveAndMap(oSymTable, acPath);
+   ASSURE(oMapped != NULL);
+   SymTable_free(oSymTable);
+   ASSURE(SymTable_getLength(oMapped) == BINDING_COUNT + 2);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      piValue = (int*)SymTable_get(oMapped, acKey);
+      ASSURE(piValue != NULL && *piValue == i * 7);
+      ASSURE(SymTable_contains(oMapped, acKey));
+   }
+   piValue = (int*)SymTable_get(oMapped, acLongKey);
+   ASSURE(piValue != NULL && *piValue == 7);
+   ASSURE(SymTable_contains(oMapped, ""));
+   ASSURE(! SymTable_contains(oMapped, "Jeter"));
+   ASSURE(SymTable_get(oMapped, "-1") == NULL);
+
+   apcKeys[0] = "12";
+   apcKeys[1] = "Jeter";
+   apcKeys[2] = "";
+   ASSURE(SymTable_getBatch(oMapped, apcKeys, 3, apvValues) == 2);
+   ASSURE(*(int*)apvValues[0] == 84);
+   ASSURE(apvValues[1] == NULL);
+
+   lSum = 0;
+   SymTable_map(oMapped, sumInts, &lSum);
+   ASSURE(lSum == 7L * BINDING_COUNT * (BINDING_COUNT - 1) / 2 + 7);
+
+   /* The mapped table is read-only. */
+   ASSURE(! SymTable_put(oMapped, "Jeter", &aiValues[0]));
+   ASSURE(! SymTable_contains(oMapped, "Jeter"));
+   ASSURE(SymTable_remove(oMapped, "12") == NULL);
+   ASSURE(SymTable_replace(oMapped, "12", &aiValues[0]) == NULL);
+   ASSURE(*(int*)SymTable_get(oMapped, "12") == 84);
+   ASSURE(SymTable_iterBegin(oMapped) == NULL);
+   ASSURE(SymTable_getLength(oMapped) == BINDING_COUNT + 2);
+
+   /* A mapped table can itself be saved. */
+   oRemapped = saveAndMap(oMapped, acRemappedPath);
+   ASSURE(oRemapped != NULL);
+   ASSURE(SymTable_getLength(oRemapped) == BINDING_COUNT + 2);
+   ASSURE(*(int*)SymTable_get(oRemapped, "2999") == 2999 * 7);
+   SymTable_free(oRemapped);
+   SymTable_free(oMapped);
+   remove(acRemappedPath);
+
+   /* An empty table makes an empty snapshot. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   oMapped = saveAndMap(oSymTable, acRemappedPath);
+   ASSURE(oMapped != NULL);
+   ASSURE(SymTable_getLength(oMapped) == 0);
+   ASSURE(! SymTable_contains(oMapped, ""));
+   SymTable_free(oMapped);
+   SymTable_free(oSymTable);
+   remove(acRemappedPath);
+
+   /* A file that is not a whole snapshot is refused. */
+   iFd = open(acPath, O_WRONLY);
+   ASSURE(iFd >= 0);
+   iSuccessful = ftruncate(iFd, 64) == 0;
+   ASSURE(iSuccessful);
+   close(iFd);
+   ASSURE(SymTable_openMapped(acPath) == NULL);
+   remove(acPath);
+   ASSURE(SymTable_openMapped(acPath) == NULL);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The values that parseIndex hands out, and the number of its calls. */
+
+enum {PARSED_COUNT = 100000};
+static int aiParsed[PARSED_COUNT];
+static int iParseCount;
+
+/*--------------------------------------------------------------------*/
+
+/* Return the address of the element of aiParsed whose index is the
+   number in the uLength bytes at pcValue, or NULL if there are none. */
+
+static void *parseIndex(const char *pcValue, size_t uLength)
+{
+   ASSURE(pcValue[uLength] == '\0');
+   iParseCount++;
+   if (uLength == 0)
+      return NULL;
+   return &aiParsed[atoi(pcValue)];
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return a file descriptor, positioned at the start, of a new
+   temporary file that holds the uSize bytes at pcBytes. The file goes
+   away once the descriptor is closed. */
+
+static int tempFileOf(const char *pcBytes, size_t uSize)
+{
+   char acPath[] = "/tmp/testsymtableXXXXXX";
+   int iFd;
+   int iSuccessful;
+
+   iFd = mkstemp(acPath);
+   ASSURE(iFd >= 0);
+   remove(acPath);
+   iSuccessful = write(iFd, pcBytes, uSize) == (ssize_t)uSize;
+   ASSURE(iSuccessful);
+   iSuccessful = lseek(iFd, 0, SEEK_SET) == 0;
+   ASSURE(iSuccessful);
+   return iFd;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Append to the bytes at pcBytes + *puSize a SYMTABLE_FORMAT_BINARY
+   record of key pcKey, uKeyLength bytes long, and value pcValue, and
+   add its size to *puSize. */
+
+static void appendRecord(char *pcBytes, size_t *puSize, const char *pcKey,
+   size_t uKeyLength, const char *pcValue)
+{
+   unsigned int uKeyLength32 = (unsigned int)uKeyLength;
+   unsigned int uValueLength32 = (unsigned int)strlen(pcValue);
+
+   memcpy(pcBytes + *puSize, &uKeyLength32, 4);
+   memcpy(pcBytes + *puSize + 4, &uValueLength32, 4);
+   memcpy(pcBytes + *puSize + 8, pcKey, uKeyLength);
+   memcpy(pcBytes + *puSize + 8 + uKeyLength, pcValue, uValueLength32);
+   *puSize += 8 + uKeyLength + uValueLength32;
+}
+
+/*--------------------------------------------------------------------*/
+
+static void testLoadStream(void)
+{
+   enum {LINE_COUNT = PARSED_COUNT, MAX_LINE_LENGTH = 16,
+      LONG_KEY_LENGTH = 3 * 1024 * 1024 / 2};
+
+   const char acSmall[] = "1\t1\n2\t2\n\n1\t9\nlonely\n3\t3";
+
+   SymTable_T oSymTable;
+   char *pcBytes;
+   char *pcLongKey;
+   size_t uSize;
+   int i;
+   int iFd;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_loadStream.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   /* Duplicates keep the first value without parsing the others, a
+      line without a tab has an empty value, empty lines are skipped,
+      and the last line needs no '\n'. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iFd = tempFileOf(acSmall, sizeof(acSmall) - 1);
+   iParseCount = 0;
+   iSuccessful = SymTable_loadStream(oSymTable, iFd, SYMTABLE_FORMAT_TSV,
+      parseIndex);
+   ASSURE(iSuccessful);
+   close(iFd);
+   ASSURE(iParseCount == 4);
+   ASSURE(SymTable_getLength(oSymTable) == 4);
+   ASSURE(SymTable_get(oSymTable, "1") == &aiParsed[1]);
+   ASSURE(SymTable_get(oSymTable, "2") == &aiParsed[2]);
+   ASSURE(SymTable_get(oSymTable, "3") == &aiParsed[3]);
+   ASSURE(SymTable_contains(oSymTable, "lonely"));
+   ASSURE(SymTable_get(oSymTable, "lonely") == NULL);
+   SymTable_free(oSymTable);
+
+   /* Records cross the block boundaries, and a record larger than a
+      block makes the buffer grow. */
+   pcBytes = (char*)malloc((size_t)LINE_COUNT * MAX_LINE_LENGTH +
+      LONG_KEY_LENGTH + MAX_LINE_LENGTH);
+   pcLongKey = (char*)malloc(LONG_KEY_LENGTH + 1);
+   ASSURE(pcBytes != NULL && pcLongKey != NULL);
+   if (pcBytes == NULL || pcLongKey == NULL)
+      exit(EXIT_FAILURE);
+   memset(pcLongKey, 'x', LONG_KEY_LENGTH);
+   pcLongKey[LONG_KEY_LENGTH] = '\0';
+   uSize = 0;
+   for (i = 0; i < LINE_COUNT; i++)
+   {
+      uSize += (size_t)sprintf(pcBytes + uSize, "k%d\t%d\n", i, i);
+      if (i == LINE_COUNT / 2)
+      {
+         memcpy(pcBytes + uSize, pcLongKey, LONG_KEY_LENGTH);
+         uSize += LONG_KEY_LENGTH;
+         uSize += (size_t)sprintf(pcBytes + uSize, "\t7\n");
+      }
+   }
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iFd = tempFileOf(pcBytes, uSize);
+   iSuccessful = SymTable_loadStream(oSymTable, iFd, SYMTABLE_FORMAT_TSV,
+      parseIndex);
+   ASSURE(iSuccessful);
+   close(iFd);
+   ASSURE(SymTable_getLength(oSymTable) == LINE_COUNT + 1);
+   ASSURE(SymTable_get(oSymTable, pcLongKey) == &aiParsed[7]);
+   for (i = 0; i < LINE_COUNT; i++)
+   {
+      sprintf(pcBytes, "k%d", i);
+      ASSURE(SymTable_get(oSymTable, pcBytes) == &aiParsed[i]);
+   }
+   SymTable_free(oSymTable);
+
+   /* Binary records load the same way; one that the input cuts short
+      is an error, but the records before it stay. */
+   uSize = 0;
+   appendRecord(pcBytes, &uSize, "Ruth", 4, "3");
+   appendRecord(pcBytes, &uSize, "", 0, "4");
+   appendRecord(pcBytes, &uSize, pcLongKey, LONG_KEY_LENGTH, "");
+   appendRecord(pcBytes, &uSize, "Gehrig", 6, "5");
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   iFd = tempFileOf(pcBytes, uSize - 1);
+   iSuccessful = SymTable_loadStream(oSymTable, iFd,
+      SYMTABLE_FORMAT_BINARY, parseIndex);
+   ASSURE(! iSuccessful);
+   close(iFd);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   ASSURE(SymTable_get(oSymTable, "Ruth") == &aiParsed[3]);
+   ASSURE(SymTable_get(oSymTable, "") == &aiParsed[4]);
+   ASSURE(SymTable_contains(oSymTable, pcLongKey));
+   ASSURE(! SymTable_contains(oSymTable, "Gehrig"));
+
+   /* A key that holds a '\0' is an error too. */
+   uSize = 0;
+   appendRecord(pcBytes, &uSize, "Geh\0rig", 7, "5");
+   iFd = tempFileOf(pcBytes, uSize);
+   iSuccessful = SymTable_loadStream(oSymTable, iFd,
+      SYMTABLE_FORMAT_BINARY, NULL);
+   ASSURE(! iSuccessful);
+   close(iFd);
+   ASSURE(SymTable_getLength(oSymTable) == 3);
+   SymTable_free(oSymTable);
+
+   free(pcLongKey);
+   free(pcBytes);
+}
+
+/*--------------------------------------------------------------------*/
+
+static void testFreeze(void)
+{
+   enum {BINDING_COUNT = 20000, MAX_KEY_LENGTH = 10,
+      LONG_KEY_LENGTH = 300, PATH_SIZE = 32};
+
+   SymTable_T oSymTable;
+   SymTable_T oMapped;
+   SymTablePool_T oPool;
+   SymTable_Key sKey;
+   static int aiVisits[BINDING_COUNT + 2];
+   char acKey[MAX_KEY_LENGTH];
+   char acLongKey[LONG_KEY_LENGTH + 1];
+   char acPath[PATH_SIZE];
+   const char *apcKeys[3];
+   void *apvValues[3];
+   size_t uKeyBytes;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_freeze.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+      ASSURE(iSuccessful);
+   }
+   memset(acLongKey, 'x', LONG_KEY_LENGTH);
+   acLongKey[LONG_KEY_LENGTH] = '\0';
+   iSuccessful = SymTable_put(oSymTable, acLongKey,
+      &aiVisits[BINDING_COUNT]);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "", &aiVisits[BINDING_COUNT + 1]);
+   ASSURE(iSuccessful);
+
+   /* The frozen table finds every binding, and nothing else. */
+   iSuccessful = SymTable_freeze(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT + 2);
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "%d", i);
+      ASSURE(SymTable_get(oSymTable, acKey) == &aiVisits[i]);
+      sprintf(acKey, "%d", i + BINDING_COUNT);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   ASSURE(SymTable_get(oSymTable, acLongKey) == &aiVisits[BINDING_COUNT]);
+   ASSURE(SymTable_get(oSymTable, "") == &aiVisits[BINDING_COUNT + 1]);
+   ASSURE(! SymTable_contains(oSymTable, "12345x"));
+
+   sKey = SymTable_makeKey(SYMTABLE_HASH_WORDS, "12345x", 5);
+   ASSURE(SymTable_getK(oSymTable, &sKey) == &aiVisits[12345]);
+   sKey = SymTable_makeKey(SYMTABLE_HASH_65599, "12345", 4);
+   ASSURE(SymTable_containsK(oSymTable, &sKey));
+
+   apcKeys[0] = "12";
+   apcKeys[1] = "Jeter";
+   apcKeys[2] = "";
+   ASSURE(SymTable_getBatch(oSymTable, apcKeys, 3, apvValues) == 2);
+   ASSURE(apvValues[0] == &aiVisits[12]);
+   ASSURE(apvValues[1] == NULL);
+   ASSURE(apvValues[2] == &aiVisits[BINDING_COUNT + 1]);
+
+   uKeyBytes = 0;
+   SymTable_map(oSymTable, countVisit, &uKeyBytes);
+   for (i = 0; i < BINDING_COUNT + 2; i++)
+      ASSURE(aiVisits[i] == 1);
+
+   /* The frozen table is read-only. */
+   ASSURE(! SymTable_put(oSymTable, "Jeter", &aiVisits[0]));
+   ASSURE(SymTable_remove(oSymTable, "12") == NULL);
+   ASSURE(SymTable_replace(oSymTable, "12", &aiVisits[0]) == NULL);
+   ASSURE(SymTable_get(oSymTable, "12") == &aiVisits[12]);
+   ASSURE(SymTable_iterBegin(oSymTable) == NULL);
+   ASSURE(! SymTable_freeze(oSymTable));
+   ASSURE(SymTable_getLength(oSymTable) == BINDING_COUNT + 2);
+
+   /* A frozen table can be saved. */
+   strcpy(acPath, "/tmp/testsymtableXXXXXX");
+   oMapped = saveAndMap(oSymTable, acPath);
+   ASSURE(oMapped != NULL);
+   ASSURE(SymTable_getLength(oMapped) == BINDING_COUNT + 2);
+   ASSURE(! SymTable_freeze(oMapped));
+   SymTable_free(oMapped);
+   remove(acPath);
+   SymTable_free(oSymTable);
+
+   /* An empty table freezes too, and a frozen table owns its keys. */
+   oPool = SymTablePool_new();
+   ASSURE(oPool != NULL);
+   oSymTable = SymTable_newWithPool(oPool);
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_freeze(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(! SymTable_contains(oSymTable, ""));
+   SymTable_free(oSymTable);
+
+   oSymTable = SymTable_newWithPool(oPool);
+   ASSURE(oSymTable != NULL);
+   iSuccessful = SymTable_put(oSymTable, "Ruth", acLongKey);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_freeze(oSymTable);
+   ASSURE(iSuccessful);
+   ASSURE(SymTablePool_getLength(oPool) == 0);
+   ASSURE(SymTable_get(oSymTable, "Ruth") == acLongKey);
+   SymTable_free(oSymTable);
+   SymTablePool_free(oPool);
+}
+
+#endif
+
+#ifdef SYMTABLE_ORDERED
+
+/*--------------------------------------------------------------------*/
+
+/* The keys that an ordered walk has visited so far, and how many. */
+
+struct OrderedWalk
+{
+   char acLastKey[16];
+   int iCount;
+   int iInOrder;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Count the key pcKey in the OrderedWalk at pvExtra, noting whether it
+   came after the key before it. */
+
+static void checkOrder(const char *pcKey, void *pvValue, void *pvExtra)
+{
+   struct OrderedWalk *psWalk = (struct OrderedWalk*)pvExtra;
+
+   (void)pvValue;
+   if (psWalk->iCount > 0 && strcmp(psWalk->acLastKey, pcKey) >= 0)
+      psWalk->iInOrder = 0;
+   strcpy(psWalk->acLastKey, pcKey);
+   psWalk->iCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Call checkOrder on the bindings of oSymTable with keys that begin
+   with pcPrefix or, if pcPrefix is NULL, that lie from pcLow up to
+   pcHigh. Return the number visited, or -1 if they came out of
+   order. */
+
+static int countOrdered(SymTable_T oSymTable, const char *pcLow,
+   const char *pcHigh, const char *pcPrefix)
+{
+   struct OrderedWalk sWalk;
+
+   sWalk.iCount = 0;
+   sWalk.iInOrder = 1;
+   if (pcPrefix != NULL)
+      SymTable_mapPrefix(oSymTable, pcPrefix, checkOrder, &sWalk);
+   else
+      SymTable_mapRange(oSymTable, pcLow, pcHigh, checkOrder, &sWalk);
+   return sWalk.iInOrder ? sWalk.iCount : -1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test SymTable_mapRange, SymTable_mapPrefix, and the order in which
+   SymTable_map visits the bindings. */
+
+static void testOrdered(void)
+{
+   enum {BINDING_COUNT = 5000, MAX_KEY_LENGTH = 16};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   struct OrderedWalk sWalk;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing SymTable_mapRange and SymTable_mapPrefix.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   ASSURE(countOrdered(oSymTable, NULL, NULL, NULL) == 0);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "") == 0);
+
+   /* Put the keys "k0000" to "k4999" out of order. */
+   for (i = 0; i < BINDING_COUNT; i++)
+   {
+      sprintf(acKey, "k%04d", (i * 7919) % BINDING_COUNT);
+      iSuccessful = SymTable_put(oSymTable, acKey, NULL);
+      ASSURE(iSuccessful);
+   }
+   iSuccessful = SymTable_put(oSymTable, "a", NULL);
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTable, "z", NULL);
+   ASSURE(iSuccessful);
+
+   sWalk.iCount = 0;
+   sWalk.iInOrder = 1;
+   SymTable_map(oSymTable, checkOrder, &sWalk);
+   ASSURE(sWalk.iInOrder);
+   ASSURE(sWalk.iCount == BINDING_COUNT + 2);
+
+   ASSURE(countOrdered(oSymTable, NULL, NULL, NULL) == BINDING_COUNT + 2);
+   ASSURE(countOrdered(oSymTable, "k", "l", NULL) == BINDING_COUNT);
+   ASSURE(countOrdered(oSymTable, "k1000", "k2000", NULL) == 1000);
+   ASSURE(countOrdered(oSymTable, "k10005", "k1001", NULL) == 0);
+   ASSURE(countOrdered(oSymTable, NULL, "k0000", NULL) == 1);
+   ASSURE(countOrdered(oSymTable, "k4999", NULL, NULL) == 2);
+   ASSURE(countOrdered(oSymTable, "k2", "k2", NULL) == 0);
+
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "") == BINDING_COUNT + 2);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "k") == BINDING_COUNT);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "k12") == 100);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "k123") == 10);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "k1234") == 1);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "k12345") == 0);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "j") == 0);
+
+   /* Removing every other key keeps the rest in order and in
+      range. */
+   for (i = 0; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "k%04d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey));
+      (void)SymTable_remove(oSymTable, acKey);
+      ASSURE(! SymTable_contains(oSymTable, acKey));
+   }
+   ASSURE(countOrdered(oSymTable, NULL, NULL, NULL) ==
+      BINDING_COUNT / 2 + 2);
+   ASSURE(countOrdered(oSymTable, "k1000", "k2000", NULL) == 500);
+   ASSURE(countOrdered(oSymTable, NULL, NULL, "k12") == 50);
+   for (i = 1; i < BINDING_COUNT; i += 2)
+   {
+      sprintf(acKey, "k%04d", i);
+      ASSURE(SymTable_contains(oSymTable, acKey));
+   }
+
+   SymTable_free(oSymTable);
+}
+
+#endif
+
+#ifdef SYMTABLE_INSERTION_ORDERED
+
+/*--------------------------------------------------------------------*/
+
+/* The keys "k<n>" that a walk of SymTable_map should visit, in order,
+   with the values at piValues[n], and how far the walk has got. */
+
+struct InsertionWalk
+{
+   const int *piKeys;
+   int iKeyCount;
+   const int *piValues;
+   int iCount;
+   int iInOrder;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Check that the binding of pcKey to pvValue is the next one that the
+   InsertionWalk at pvExtra expects. */
+
+static void checkInsertionOrder(const char *pcKey, void *pvValue,
+   void *pvExtra)
+{
+   enum {MAX_KEY_LENGTH = 16};
+
+   struct InsertionWalk *psWalk = (struct InsertionWalk*)pvExtra;
+   char acKey[MAX_KEY_LENGTH];
+   int iKey;
+
+   if (psWalk->iCount >= psWalk->iKeyCount)
+      psWalk->iInOrder = 0;
+   else
+   {
+      iKey = psWalk->piKeys[psWalk->iCount];
+      sprintf(acKey, "k%d", iKey);
+      if (strcmp(pcKey, acKey) != 0 || pvValue != &psWalk->piValues[iKey])
+         psWalk->iInOrder = 0;
+   }
+   psWalk->iCount++;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test that SymTable_map visits the bindings in the order in which
+   they were put, while puts, removes and puts of removed keys again
+   fill the entry array and make the table compact it. */
+
+static void testInsertionOrder(void)
+{
+   enum {KEY_COUNT = 100, ROUND_COUNT = 200, MAX_KEY_LENGTH = 16};
+
+   static int aiValues[KEY_COUNT];
+   int aiKeys[KEY_COUNT];
+   SymTable_T oSymTable;
+   struct InsertionWalk sWalk;
+   char acKey[MAX_KEY_LENGTH];
+   int iKeyCount = 0;
+   int iKept;
+   int iRound;
+   int i;
+   int iSuccessful;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the insertion order of SymTable_map.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+   if (oSymTable == NULL)
+      return;
+
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "k%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+      aiKeys[iKeyCount++] = i;
+   }
+
+   /* Remove three keys in four, then put a third of them back, after
+      the keys that stayed. */
+   iKept = 0;
+   for (i = 0; i < KEY_COUNT; i++)
+   {
+      sprintf(acKey, "k%d", i);
+      if (i % 4 == 0)
+         aiKeys[iKept++] = i;
+      else
+         ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+   }
+   iKeyCount = iKept;
+   for (i = 1; i < KEY_COUNT; i += 4)
+   {
+      sprintf(acKey, "k%d", i);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+      aiKeys[iKeyCount++] = i;
+   }
+
+   /* Move the oldest binding to the end, by removing it and putting
+      it again, until the removed entries have filled the array and
+      been compacted away more than once. */
+   for (iRound = 0; iRound < ROUND_COUNT; iRound++)
+   {
+      i = aiKeys[0];
+      sprintf(acKey, "k%d", i);
+      ASSURE(SymTable_remove(oSymTable, acKey) == &aiValues[i]);
+      iSuccessful = SymTable_put(oSymTable, acKey, &aiValues[i]);
+      ASSURE(iSuccessful);
+      memmove(aiKeys, aiKeys + 1, (size_t)(iKeyCount - 1) *
+         sizeof(aiKeys[0]));
+      aiKeys[iKeyCount - 1] = i;
+   }
+
+   ASSURE(SymTable_getLength(oSymTable) == (size_t)iKeyCount);
+   sWalk.piKeys = aiKeys;
+   sWalk.iKeyCount = iKeyCount;
+   sWalk.piValues = aiValues;
+   sWalk.iCount = 0;
+   sWalk.iInOrder = 1;
+   SymTable_map(oSymTable, checkInsertionOrder, &sWalk);
+   ASSURE(sWalk.iInOrder);
+   ASSURE(sWalk.iCount == iKeyCount);
+
+   SymTable_free(oSymTable);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Test the ability of a SymTable object to be large, that is, to
+   contain iBindingCount bindings. Write the time consumed to stdout. */
+
+static void testLargeTable(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 10};
+
+   SymTable_T oSymTable;
+   SymTable_T oSymTableSmall;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValue;
+   int i;
+   int iSmall;
+   int iLarge;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iFinalClock;
+   size_t uLength = 0;
+   size_t uLength2;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a potentially large SymTable object.\n");
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   /* Note the current time. */
+   iInitialClock = clock();
+
+   /* Create oSymTableSmall, and put a couple of bindings into it. */
+   oSymTableSmall = SymTable_new();
+   ASSURE(oSymTableSmall != NULL);
+   iSuccessful = SymTable_put(oSymTableSmall, "xxx", "xxx");
+   ASSURE(iSuccessful);
+   iSuccessful = SymTable_put(oSymTableSmall, "yyy", "yyy");
+   ASSURE(iSuccessful);
+
+   /* Create oSymTable, the primary SymTable object. */
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   /* Put iBindingCount new bindings into oSymTable.  Each binding's
+      key and value contain the same characters. */
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)malloc(sizeof(char) * (strlen(acKey) + 1));
+      ASSURE(pcValue != NULL);
+      strcpy(pcValue, acKey);
+      iSuccessful = SymTable_put(oSymTable, acKey, pcValue);
+      ASSURE(iSuccessful);
+      uLength = SymTable_getLength(oSymTable);
+      ASSURE(uLength == (size_t)(i+1));
+   }
+
+   /* Get each binding's value, and make sure that it contains
+      the same characters as its key. */
+   iSmall = 0;
+   iLarge = iBindingCount - 1;
+   while (iSmall < iLarge)
+   {
+      /* Get the smallest of the remaining bindings. */
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      iSmall++;
+      /* Get the largest of the remaining bindings. */
+      sprintf(acKey, "%d", iLarge);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      iLarge--;
+   }
+   /* Get the middle binding -- if there is one. */
+   if (iSmall == iLarge)
+   {
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+   }
+
+   /* Remove each binding. Also free each binding's value. */
+   iSmall = 0;
+   iLarge = iBindingCount - 1;
+   while (iSmall < iLarge)
+   {
+      /* Remove the smallest of the remaining bindings. */
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      free(pcValue);
+      uLength--;
+      uLength2 = SymTable_getLength(oSymTable);
+      ASSURE(uLength2 == uLength);
+      iSmall++;
+      /* Remove the largest of the remaining bindings. */
+      sprintf(acKey, "%d", iLarge);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      free(pcValue);
+      uLength--;
+      uLength2 = SymTable_getLength(oSymTable);
+      ASSURE(uLength2 == uLength);
+      iLarge--;
+   }
+   /* Remove the middle binding -- if there is one. */
+   if (iSmall == iLarge)
+   {
+      sprintf(acKey, "%d", iSmall);
+      pcValue = (char*)SymTable_remove(oSymTable, acKey);
+      ASSURE(pcValue != NULL);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+      free(pcValue);
+      uLength--;
+      uLength2 = SymTable_getLength(oSymTable);
+      ASSURE(uLength2 == uLength);  
+   }
+
+   /* Make sure oSymTableSmall hasn't been corrupted by expansion
+      of oSymTable. */
+   pcValue = (char*)SymTable_get(oSymTableSmall, "xxx");
+   ASSURE((pcValue != NULL) && (strcmp(pcValue, "xxx") == 0));
+   pcValue = (char*)SymTable_get(oSymTableSmall, "yyy");
+   ASSURE((pcValue != NULL) && (strcmp(pcValue, "yyy") == 0));
+
+   /* Free both SymTable objects. */
+   SymTable_free(oSymTable);
+   SymTable_free(oSymTableSmall);
+
+   /* Note the current time, and print the time consumed to stdout. */
+   iFinalClock = clock();
+   printf("CPU time (%d bindings):  %f seconds\n", iBindingCount,
+      ((double)(iFinalClock - iInitialClock)) / CLOCKS_PER_SEC);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Put iBindingCount bindings into a SymTable object, get each of them,
+   and then free the object while it still contains all of them.  Write
+   the time consumed by each of the three phases to stdout. */
+
+static void testLargeTablePhases(int iBindingCount)
+{
+   /* Room for any int and its '\0'. */
+   enum {MAX_KEY_LENGTH = 12};
+
+   SymTable_T oSymTable;
+   char acKey[MAX_KEY_LENGTH];
+   char *pcValues;
+   char *pcValue;
+   int i;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iInsertClock;
+   clock_t iLookupClock;
+   clock_t iFinalClock;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing the phases of a potentially large SymTable object.\n");
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   /* Allocate all the values at once, so that freeing them does not
+      count as part of the teardown. */
+   pcValues = (char*)malloc((size_t)iBindingCount * MAX_KEY_LENGTH + 1);
+   ASSURE(pcValues != NULL);
+   if (pcValues == NULL)
+      return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   iInitialClock = clock();
+   for (i = 0; i < iBindingCount; i++)
+   {
+      pcValue = pcValues + (size_t)i * MAX_KEY_LENGTH;
+      sprintf(pcValue, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, pcValue, pcValue);
+      ASSURE(iSuccessful);
+   }
+   iInsertClock = clock();
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      sprintf(acKey, "%d", i);
+      pcValue = (char*)SymTable_get(oSymTable, acKey);
+      ASSURE((pcValue != NULL) && (strcmp(pcValue, acKey) == 0));
+   }
+   iLookupClock = clock();
+
+   SymTable_free(oSymTable);
+   iFinalClock = clock();
+
+   free(pcValues);
+
+   printf("CPU time (%d bindings):  %f seconds to put\n", iBindingCount,
+      ((double)(iInsertClock - iInitialClock)) / CLOCKS_PER_SEC);
+   printf("CPU time (%d bindings):  %f seconds to get\n", iBindingCount,
+      ((double)(iLookupClock - iInsertClock)) / CLOCKS_PER_SEC);
+   printf("CPU time (%d bindings):  %f seconds to free\n", iBindingCount,
+      ((double)(iFinalClock - iLookupClock)) / CLOCKS_PER_SEC);
+   fflush(stdout);
+}
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_EXTENSIONS
+
+/* Look up each of the iBindingCount keys of a SymTable object once, in
+   random order, first with SymTable_get and then with
+   SymTable_getBatch. Write the CPU time of each to stdout. For the
+   comparison to mean anything, iBindingCount must make the table much
+   larger than the last-level cache, say 4000000. */
+
+static void benchBatch(int iBindingCount)
+{
+   enum {MAX_KEY_LENGTH = 10, BATCH_SIZE = 256};
+
+   SymTable_T oSymTable;
+   char *pcKeys;
+   const char **ppcLookups;
+   const char *pcSwap;
+   void *apvValues[BATCH_SIZE];
+   size_t uFoundCount = 0;
+   size_t uBatchFoundCount = 0;
+   size_t uCount;
+   int i;
+   int j;
+   int iSuccessful;
+   clock_t iInitialClock;
+   clock_t iLoopClock;
+   clock_t iFinalClock;
+
+   printf("------------------------------------------------------\n");
+   printf("Comparing SymTable_get with SymTable_getBatch.\n");
+   printf("No output except CPU time consumed should appear here:\n");
+   fflush(stdout);
+
+   pcKeys = (char*)malloc((size_t)iBindingCount * MAX_KEY_LENGTH + 1);
+   ppcLookups = (const char**)malloc(
+      (size_t)iBindingCount * sizeof(*ppcLookups) + 1);
+   ASSURE(pcKeys != NULL && ppcLookups != NULL);
+   if (pcKeys == NULL || ppcLookups == NULL)
+      return;
+
+   oSymTable = SymTable_new();
+   ASSURE(oSymTable != NULL);
+
+   for (i = 0; i < iBindingCount; i++)
+   {
+      ppcLookups[i] = pcKeys + (size_t)i * MAX_KEY_LENGTH;
+      sprintf(pcKeys + (size_t)i * MAX_KEY_LENGTH, "%d", i);
+      iSuccessful = SymTable_put(oSymTable, ppcLookups[i], ppcLookups[i]);
+      ASSURE(iSuccessful);
+   }
+
+   /* Shuffle the keys, so that consecutive lookups do not touch nodes
+      that were allocated together. */
+   srand(217);
+   for (i = iBindingCount - 1; i > 0; i--)
+   {
+      j = (int)(((double)rand() / ((double)RAND_MAX + 1.0)) * (i + 1));
+      pcSwap = ppcLookups[i];
+      ppcLookups[i] = ppcLookups[j];
+      ppcLookups[j] = pcSwap;
+   }
+
+   iInitialClock = clock();
+   for (i = 0; i < iBindingCount; i++)
+   {
+      if (SymTable_get(oSymTable, ppcLookups[i]) == ppcLookups[i])
+         uFoundCount++;
+   }
+   iLoopClock = clock();
+
+   for (i = 0; i < iBindingCount; i += BATCH_SIZE)
+   {
+      uCount = (size_t)(iBindingCount - i);
+      if (uCount > BATCH_SIZE)
+         uCount = BATCH_SIZE;
+      uBatchFoundCount += SymTable_getBatch(oSymTable, ppcLookups + i,
+         uCount, apvValues);
+      ASSURE(apvValues[0] == ppcLookups[i]);
+   }
+   iFinalClock = clock();
+
+   ASSURE(uFoundCount == (size_t)iBindingCount);
+   ASSURE(uBatchFoundCount == (size_t)iBindingCount);
+
+   SymTable_free(oSymTable);
+   free(ppcLookups);
+   free(pcKeys);
+
+   printf("CPU time (%d bindings):  %f seconds to get one at a time\n",
+      iBindingCount,
+      ((double)(iLoopClock - iInitialClock)) / CLOCKS_PER_SEC);
+   printf("CPU time (%d bindings):  %f seconds to get in batches of %d\n",
+      iBindingCount,
+      ((double)(iFinalClock - iLoopClock)) / CLOCKS_PER_SEC,
+      (int)BATCH_SIZE);
+   fflush(stdout);
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+#ifdef SYMTABLE_CONCURRENT
+
+/* The work of one thread of testConcurrent: the shared table, the
+   iBindingCount keys at pcKeys, CONCURRENT_KEY_LENGTH bytes apart,
+   the barrier that separates the phases, which of the iThreadCount
+   threads this is, and, for thread 0, where to note the times at
+   which the read-mostly phase starts and ends. */
+
+struct ConcurrentWork
+{
+   SymTable_T oSymTable;
+   const char *pcKeys;
+   int iBindingCount;
+   pthread_barrier_t *psBarrier;
+   int iThread;
+   int iThreadCount;
+   struct timespec *psReadTimes;
+};
+
+/* The spacing of the keys of testConcurrent, the size of the extra
+   keys that thread 0 puts: an 'x', any int and a '\0', and the number
+   of keys that each SymTable_getBatch call looks up. */
+
+enum {CONCURRENT_KEY_LENGTH = 10, CONCURRENT_EXTRA_KEY_SIZE = 13,
+   CONCURRENT_BATCH_SIZE = 64};
+
+/*--------------------------------------------------------------------*/
+
+/* Run one thread of testConcurrent on the ConcurrentWork at pvWork:
+   put every iThreadCount-th key, starting with key iThread, get every
+   key, get every key again, one at a time and then in batches, while
+   thread 0 puts and removes as many other keys, and then remove the
+   keys that were put.  Return NULL. */
+
+static void *runConcurrent(void *pvWork)
+{
+   struct ConcurrentWork *psWork = (struct ConcurrentWork*)pvWork;
+   char acKey[CONCURRENT_EXTRA_KEY_SIZE];
+   const char *apcBatch[CONCURRENT_BATCH_SIZE];
+   void *apvBatch[CONCURRENT_BATCH_SIZE];
+   const char *pcKey;
+   void *pvValue;
+   int iBatchCount;
+   int iSuccessful;
+   int i;
+   int j;
+
+   for (i = psWork->iThread; i < psWork->iBindingCount;
+      i += psWork->iThreadCount)
+   {
+      pcKey = psWork->pcKeys + (size_t)i * CONCURRENT_KEY_LENGTH;
+      iSuccessful = SymTable_put(psWork->oSymTable, pcKey, pcKey);
+      ASSURE(iSuccessful);
+   }
+
+   pthread_barrier_wait(psWork->psBarrier);
+   if (psWork->iThread == 0)
+      ASSURE(SymTable_getLength(psWork->oSymTable) ==
+         (size_t)psWork->iBindingCount);
+
+   /* Each thread starts at a different key, so that the threads do
+      not all read the same stripe at once. */
+   for (i = 0; i < psWork->iBindingCount; i++)
+   {
+      pcKey = psWork->pcKeys + (size_t)((i + psWork->iThread *
+         (psWork->iBindingCount / psWork->iThreadCount)) %
+         psWork->iBindingCount) * CONCURRENT_KEY_LENGTH;
+      pvValue = SymTable_get(psWork->oSymTable, pcKey);
+      ASSURE(pvValue == pcKey);
+   }
+
+   /* Read while thread 0 makes the table grow past twice its size and
+      shrink back, so that the gets overlap rehashes and removes. */
+   pthread_barrier_wait(psWork->psBarrier);
+   if (psWork->iThread == 0)
+   {
+      clock_gettime(CLOCK_MONOTONIC, &psWork->psReadTimes[0]);
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "x%d", i);
+         iSuccessful = SymTable_put(psWork->oSymTable, acKey, psWork);
+         ASSURE(iSuccessful);
+      }
+      for (i = 0; i < psWork->iBindingCount; i++)
+      {
+         sprintf(acKey, "x%d", i);
+         pvValue = SymTable_remove(psWork->oSymTable, acKey);
+         ASSURE(pvValue == psWork);
+      }
+   }
+   for (i = 0; i < psWork->iBindingCount && psWork->iThread != 0; i++)
+   {
+      pcKey = psWork->pcKeys + (size_t)i * CONCURRENT_KEY_LENGTH;
+      ASSURE(SymTable_contains(psWork->oSymTable, pcKey));
+      pvValue = SymTable_get(psWork->oSymTable, pcKey);
+      ASSURE(pvValue == pcKey);
+   }
+   for (i = 0; i < psWork->iBindingCount && psWork->iThread != 0;
+      i += iBatchCount)
+   {
+      iBatchCount = psWork->iBindingCount - i;
+      if (iBatchCount > CONCURRENT_BATCH_SIZE)
+         iBatchCount = CONCURRENT_BATCH_SIZE;
+      for (j = 0; j < iBatchCount; j++)
+         apcBatch[j] = psWork->pcKeys + (size_t)(i + j) *
+            CONCURRENT_KEY_LENGTH;
+      ASSURE(SymTable_getBatch(psWork->oSymTable, apcBatch,
+         (size_t)iBatchCount, apvBatch) == (size_t)iBatchCount);
+      for (j = 0; j < iBatchCount; j++)
+         ASSURE(apvBatch[j] == apcBatch[j]);
+   }
+
+   pthread_barrier_wait(psWork->psBarrier);
+   if (psWork->iThread == 0)
+      clock_gettime(CLOCK_MONOTONIC, &psWork->psReadTimes[1]);
+
+   for (i = psWork->iThread; i < psWork->iBindingCount;
+      i += psWork->iThreadCount)
+   {
+      pcKey = psWork->pcKeys + (size_t)i * CONCURRENT_KEY_LENGTH;
+      pvValue = SymTable_remove(psWork->oSymTable, pcKey);
+      ASSURE(pvValue == pcKey);
+   }
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Test the concurrent build of a SymTable object by putting,
+   getting, and removing iBindingCount bindings from 1, 2, 4, and 8
+   threads sharing one table.  Each thread puts and removes its share
+   of the keys and gets all of them, and all threads but one look all
+   of them up again while that one grows and shrinks the table.  Write
+   the operations per second of each thread count, and the lookups per
+   second beside the writer, to stdout. */
+
+static void testConcurrent(int iBindingCount)
+{
+   enum {MAX_THREAD_COUNT = 8};
+
+   pthread_t aiThreads[MAX_THREAD_COUNT];
+   struct ConcurrentWork asWork[MAX_THREAD_COUNT];
+   pthread_barrier_t sBarrier;
+   SymTable_T oSymTable;
+   char *pcKeys;
+   struct timespec sInitialTime;
+   struct timespec sFinalTime;
+   struct timespec asReadTimes[2];
+   double dSeconds;
+   double dReadSeconds;
+   double dOps;
+   int iThreadCount;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing a SymTable object shared by several threads.\n");
+   printf("No output except operations per second should appear here:\n");
+   fflush(stdout);
+
+   if (iBindingCount == 0)
+      return;
+
+   pcKeys = (char*)malloc((size_t)iBindingCount * CONCURRENT_KEY_LENGTH);
+   ASSURE(pcKeys != NULL);
+   if (pcKeys == NULL)
+      return;
+   for (i = 0; i < iBindingCount; i++)
+      sprintf(pcKeys + (size_t)i * CONCURRENT_KEY_LENGTH, "%d", i);
+
+   for (iThreadCount = 1; iThreadCount <= MAX_THREAD_COUNT;
+      iThreadCount *= 2)
+   {
+      oSymTable = SymTable_new();
+      ASSURE(oSymTable != NULL);
+      iSuccessful = pthread_barrier_init(&sBarrier, NULL,
+         (unsigned)iThreadCount) == 0;
+      ASSURE(iSuccessful);
+      if (oSymTable == NULL || ! iSuccessful)
+         break;
+
+      clock_gettime(CLOCK_MONOTONIC, &sInitialTime);
+      for (i = 0; i < iThreadCount; i++)
+      {
+         asWork[i].oSymTable = oSymTable;
+         asWork[i].pcKeys = pcKeys;
+         asWork[i].iBindingCount = iBindingCount;
+         asWork[i].psBarrier = &sBarrier;
+         asWork[i].iThread = i;
+         asWork[i].iThreadCount = iThreadCount;
+         asWork[i].psReadTimes = asReadTimes;
+         iSuccessful = pthread_create(&aiThreads[i], NULL, runConcurrent,
+            &asWork[i]) == 0;
+         ASSURE(iSuccessful);
+      }
+      for (i = 0; i < iThreadCount; i++)
+         pthread_join(aiThreads[i], NULL);
+      clock_gettime(CLOCK_MONOTONIC, &sFinalTime);
+
+      ASSURE(SymTable_getLength(oSymTable) == 0);
+      pthread_barrier_destroy(&sBarrier);
+      SymTable_free(oSymTable);
+
+      /* Every key is put and removed once and got by every thread,
+         and then checked, got, and got in a batch by every thread but
+         thread 0, which puts and removes as many other keys
+         meanwhile. */
+      dOps = (double)iBindingCount * (2.0 + (double)iThreadCount);
+      dSeconds = (double)(sFinalTime.tv_sec - sInitialTime.tv_sec) +
+         (double)(sFinalTime.tv_nsec - sInitialTime.tv_nsec) / 1e9;
+      dReadSeconds = (double)(asReadTimes[1].tv_sec -
+         asReadTimes[0].tv_sec) + (double)(asReadTimes[1].tv_nsec -
+         asReadTimes[0].tv_nsec) / 1e9;
+      dSeconds -= dReadSeconds;
+      printf("%d thread(s) (%d bindings):  %.0f operations per second\n",
+         iThreadCount, iBindingCount, dOps / dSeconds);
+      if (iThreadCount > 1)
+         printf("%d thread(s) (%d bindings):  %.0f lookups per second "
+            "beside a writer\n", iThreadCount, iBindingCount,
+            3.0 * (double)iBindingCount * (double)(iThreadCount - 1) /
+            dReadSeconds);
+      fflush(stdout);
+   }
+
+   free(pcKeys);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* The number of keys that putConcurrentExtras puts. */
+
+enum {CONCURRENT_EXTRA_COUNT = 20000};
+
+/* Put CONCURRENT_EXTRA_COUNT keys into the table at pvSymTable, with
+   the table as their value, and return NULL. */
+
+static void *putConcurrentExtras(void *pvSymTable)
+{
+   char acKey[CONCURRENT_EXTRA_KEY_SIZE];
+   int iSuccessful;
+   int i;
+
+   for (i = 0; i < CONCURRENT_EXTRA_COUNT; i++)
+   {
+      sprintf(acKey, "x%d", i);
+      iSuccessful = SymTable_put((SymTable_T)pvSymTable, acKey,
+         pvSymTable);
+      ASSURE(iSuccessful);
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Walk a table of the concurrent build with each hash function while
+   another thread puts enough keys to rehash it several times, and
+   check that the walk visits each binding that was there all along
+   exactly once. */
+
+static void testConcurrentIter(void)
+{
+   enum {BINDING_COUNT = 2000};
+
+   static const enum SymTableHash aeHashes[] = {
+      SYMTABLE_HASH_65599, SYMTABLE_HASH_WORDS
+   };
+   static int aiVisits[BINDING_COUNT];
+   pthread_t iThread;
+   SymTable_T oSymTable;
+   SymTableIter_T oIter;
+   char acKey[CONCURRENT_KEY_LENGTH];
+   int *piVisits;
+   size_t u;
+   int iStep;
+   int iTarget;
+   int iSuccessful;
+   int i;
+
+   printf("------------------------------------------------------\n");
+   printf("Testing an iterator beside a thread that puts.\n");
+   printf("No output should appear here:\n");
+   fflush(stdout);
+
+   for (u = 0; u < sizeof(aeHashes) / sizeof(aeHashes[0]); u++)
+   {
+      oSymTable = SymTable_new();
+      ASSURE(oSymTable != NULL);
+      iSuccessful = SymTable_setHash(oSymTable, aeHashes[u]);
+      ASSURE(iSuccessful);
+      for (i = 0; i < BINDING_COUNT; i++)
+      {
+         sprintf(acKey, "%d", i);
+         iSuccessful = SymTable_put(oSymTable, acKey, &aiVisits[i]);
+         ASSURE(iSuccessful);
+         aiVisits[i] = 0;
+      }
+
+      oIter = SymTable_iterBegin(oSymTable);
+      ASSURE(oIter != NULL);
+      iSuccessful = pthread_create(&iThread, NULL, putConcurrentExtras,
+         oSymTable) == 0;
+      ASSURE(iSuccessful);
+      for (iStep = 1; SymTable_iterNext(oIter); iStep++)
+      {
+         piVisits = (int*)SymTable_iterValue(oIter);
+         if (piVisits != (int*)(void*)oSymTable)
+            (*piVisits)++;
+
+         /* Keep pace with the puts, so that their rehashes come all
+            through the walk. */
+         iTarget = iStep * (CONCURRENT_EXTRA_COUNT / BINDING_COUNT);
+         if (iTarget > CONCURRENT_EXTRA_COUNT)
+            iTarget = CONCURRENT_EXTRA_COUNT;
+         while (SymTable_getLength(oSymTable) <
+            (size_t)(BINDING_COUNT + iTarget))
+            ;
+      }
+      pthread_join(iThread, NULL);
+      SymTable_iterFree(oIter);
+
+      for (i = 0; i < BINDING_COUNT; i++)
+         ASSURE(aiVisits[i] == 1);
+      ASSURE(SymTable_getLength(oSymTable) ==
+         BINDING_COUNT + CONCURRENT_EXTRA_COUNT);
+      SymTable_free(oSymTable);
+   }
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+
+/* Test the SymTable ADT.  Write the output of the tests to stdout.
+   As always, argc is the command-line argument count, argv contains
+   the command-line arguments, and argv[0] is the name of the
+   executable binary file. argv[1] is the number of bindings to put
+   into a potentially large SymTable object.  If argv[2] is "batch",
+   only compare SymTable_get with SymTable_getBatch on a table of that
+   many bindings.  Exit with EXIT_FAILURE if argv[1] is missing or not
+   numeric.  Otherwise return 0. */
+
+int main(int argc, char *argv[])
+{
+   int iBindingCount;
+
+   if (argc != 2 && argc != 3)
+   {
+      fprintf(stderr, "Usage: %s bindingcount [batch]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
+   if (sscanf(argv[1], "%d", &iBindingCount) != 1)
+   {
+      fprintf(stderr, "bindingcount must be numeric\n");
       exit(EXIT_FAILURE);
    }
    if (iBindingCount < 0)
@@ -949,6 +3344,19 @@ int main(int argc, char *argv[])
    setCpuTimeLimit();
 #endif
 
+   if (argc == 3)
+   {
+#ifdef SYMTABLE_EXTENSIONS
+      if (strcmp(argv[2], "batch") == 0)
+      {
+         benchBatch(iBindingCount);
+         return 0;
+      }
+#endif
+      fprintf(stderr, "Usage: %s bindingcount [batch]\n", argv[0]);
+      exit(EXIT_FAILURE);
+   }
+
    testBasics();
    testKeyComparison();
    testKeyOwnership();
@@ -960,7 +3368,33 @@ int main(int argc, char *argv[])
    testLongKey();
    testTableOfTables();
    testCollisions();
+#ifdef SYMTABLE_EXTENSIONS
+   testPool();
+   testWordsHash();
+   testKeys();
+   testUpsert();
+   testBatch();
+   testPutBatch();
+   testCapacity();
+   testMerge();
+   testMapParallel();
+   testIter();
+   testSnapshot();
+   testLoadStream();
+   testFreeze();
+#endif
+#ifdef SYMTABLE_ORDERED
+   testOrdered();
+#endif
+#ifdef SYMTABLE_INSERTION_ORDERED
+   testInsertionOrder();
+#endif
    testLargeTable(iBindingCount);
+   testLargeTablePhases(iBindingCount);
+#ifdef SYMTABLE_CONCURRENT
+   testConcurrent(iBindingCount);
+   testConcurrentIter();
+#endif
 
    printf("------------------------------------------------------\n");
    printf("End of %s.\n", argv[0]);
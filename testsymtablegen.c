@@ -0,0 +1,87 @@
+/*--------------------------------------------------------------------*/
+/* testsymtablegen.c                                                  */
+/* Author: Wangari Ashley Karani                                      */
+/*--------------------------------------------------------------------*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*--------------------------------------------------------------------*/
+
+/* The functions that symtablegen generated from testsymtablegen.txt. */
+
+void *TestTable_get(const char *pcKey);
+int TestTable_contains(const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+#define ASSURE(i) assure(i, __LINE__)
+
+/* The number of tests that failed. */
+
+static int iFailureCount = 0;
+
+/*--------------------------------------------------------------------*/
+
+/* If !iSuccessful, print a message to stdout indicating that the
+   test at line iLineNum failed, and count the failure. */
+
+static void assure(int iSuccessful, int iLineNum)
+{
+   if (! iSuccessful)
+   {
+      printf("Test at line %d failed.\n", iLineNum);
+      fflush(stdout);
+      iFailureCount++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Look up every key of testsymtablegen.txt, and keys close to them
+   that it does not hold, in the table that symtablegen generated from
+   it. Return 0 if every lookup gives the expected answer, or
+   EXIT_FAILURE otherwise. */
+
+int main(void)
+{
+   /* The keys of testsymtablegen.txt and their values: the 1-based
+      line number, unless the line gives a value. The list holds the
+      empty key, a key whose line ended in "\r\n", and keys that the
+      generated file must escape. */
+   static const struct
+   {
+      const char *pcKey;
+      uintptr_t uValue;
+   } asKeys[] = {
+      {"if", 1}, {"else", 2}, {"while", 3}, {"return", 4},
+      {"it's", 5}, {"back\\slash", 6}, {"", 100}, {"caf\303\251", 8},
+      {"goto", 200}, {"new", 10}, {"line 11", 11}
+   };
+
+   /* Keys that testsymtablegen.txt does not hold. */
+   static const char *const apcMisses[] = {
+      "i", "iff", "If", "els", "whil", "new\r", "goto\t", "caf",
+      "back\\\\slash", "it", "line", " ", "returnx"
+   };
+
+   size_t u;
+
+   printf("Testing the table that symtablegen generated.\n");
+
+   for (u = 0; u < sizeof(asKeys) / sizeof(asKeys[0]); u++)
+   {
+      ASSURE(TestTable_contains(asKeys[u].pcKey));
+      ASSURE((uintptr_t)TestTable_get(asKeys[u].pcKey) ==
+         asKeys[u].uValue);
+   }
+
+   for (u = 0; u < sizeof(apcMisses) / sizeof(apcMisses[0]); u++)
+   {
+      ASSURE(! TestTable_contains(apcMisses[u]));
+      ASSURE(TestTable_get(apcMisses[u]) == NULL);
+   }
+
+   return iFailureCount == 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,123 @@
+/*--------------------------------------------------------------------*/
+/* Generated by symtablegen from testsymtablegen.txt. Do not edit. */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+void *TestTable_get(const char *pcKey);
+int TestTable_contains(const char *pcKey);
+
+/*--------------------------------------------------------------------*/
+
+/* The 11 keys, each followed by a '\0'. */
+
+static const char acKeys[] = {
+    '\0',
+    'i', 't', '\'', 's', '\0',
+    'n', 'e', 'w', '\0',
+    'g', 'o', 't', 'o', '\0',
+    'w', 'h', 'i', 'l', 'e', '\0',
+    'i', 'f', '\0',
+    'c', 'a', 'f', '\303', '\251', '\0',
+    'b', 'a', 'c', 'k', '\\', 's', 'l', 'a', 's', 'h', '\0',
+    'r', 'e', 't', 'u', 'r', 'n', '\0',
+    'l', 'i', 'n', 'e', ' ', '1', '1', '\0',
+    'e', 'l', 's', 'e', '\0',
+};
+
+/* The bindings, each at the position that the perfect hash gives its
+   key: the offset of the key in acKeys, its length and its value. */
+
+static const struct TestTableBinding
+{
+    uint32_t uOffset;
+    uint32_t uLength;
+    const void *pvValue;
+} asBindings[11] = {
+    {0, 0, (const void*)100},
+    {1, 4, (const void*)5},
+    {6, 3, (const void*)10},
+    {10, 4, (const void*)200},
+    {15, 5, (const void*)3},
+    {21, 2, (const void*)1},
+    {24, 5, (const void*)8},
+    {30, 10, (const void*)6},
+    {41, 6, (const void*)4},
+    {48, 7, (const void*)11},
+    {56, 4, (const void*)2},
+};
+
+/* The pilot of each bucket. */
+
+static const uint8_t auPilots[3] = {
+    2, 26, 0,
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return uValue with its bits mixed so that every input bit affects
+   every output bit. */
+
+static uint64_t TestTable_mix(uint64_t uValue)
+{
+    uValue ^= uValue >> 33;
+    uValue *= 0xff51afd7ed558ccdULL;
+    uValue ^= uValue >> 33;
+    uValue *= 0xc4ceb9fe1a85ec53ULL;
+    uValue ^= uValue >> 33;
+    return uValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the position in asBindings at which pcKey would be bound. */
+
+static size_t TestTable_find(const char *pcKey)
+{
+    const unsigned char *pucKey = (const unsigned char*)pcKey;
+    uint64_t uHash = 0xcbf29ce484222325ULL;
+    size_t uLength;
+    size_t uPosition;
+
+    for (uLength = 0; pucKey[uLength] != '\0'; uLength++)
+    {
+        uHash = (uHash ^ pucKey[uLength]) * 0x100000001b3ULL;
+    }
+    uHash = TestTable_mix(uHash ^ (uint64_t)uLength);
+
+    uPosition = (size_t)(TestTable_mix(uHash ^ ((uint64_t)
+        auPilots[(uHash >> 32) % 3U] * 0x9e3779b97f4a7c15ULL)) % 11U);
+    if (asBindings[uPosition].uLength != uLength ||
+    memcmp(acKeys + asBindings[uPosition].uOffset, pcKey,
+        uLength) != 0) {
+        return 11U;
+    }
+    return uPosition;
+}
+
+/*--------------------------------------------------------------------*/
+
+void *TestTable_get(const char *pcKey)
+{
+    size_t uPosition;
+
+    assert(pcKey != NULL);
+
+    uPosition = TestTable_find(pcKey);
+    if (uPosition == 11U) {
+        return NULL;
+    }
+    return (void*)asBindings[uPosition].pvValue;
+}
+
+/*--------------------------------------------------------------------*/
+
+int TestTable_contains(const char *pcKey)
+{
+    assert(pcKey != NULL);
+
+    return TestTable_find(pcKey) != 11U;
+}